@@ -0,0 +1,959 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Barrier.h>
+#include <penguin/Benchmark.h>
+#include <penguin/Epoch_Domain.h>
+#include <penguin/Hazard_Pointer.h>
+#include <penguin/Monitor.h>
+#include <penguin/Object_Pool.h>
+#include <penguin/Semaphore.h>
+#include <penguin/Seqlock.h>
+#include <penguin/Shared_Monitor.h>
+#include <penguin/Unbounded_Queue.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+
+namespace
+{
+    // Threads are paired up, each pair bounces one token back and forth through two semaphores
+    class Ping_Pong_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        void set_up(std::size_t threads) override
+        {
+            this->semaphores_.clear();
+            for (std::size_t i = 0; i < threads; ++i)
+            {
+                this->semaphores_.push_back(std::make_unique<Penguin::Semaphore>(0));
+            }
+        }
+
+        void run(std::size_t thread_index, std::size_t iterations) override
+        {
+            std::size_t pair = thread_index & ~std::size_t(1);
+            Penguin::Semaphore& ping = *this->semaphores_[pair];
+            Penguin::Semaphore& pong = *this->semaphores_[pair + 1];
+            bool serves = (thread_index % 2 == 0);
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                if (serves)
+                {
+                    ping.release();
+                    pong.acquire();
+                }
+                else
+                {
+                    ping.acquire();
+                    pong.release();
+                }
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->semaphores_.clear();
+        }
+
+    private:
+        std::vector<std::unique_ptr<Penguin::Semaphore>> semaphores_;
+    };
+
+
+    // The first producers threads push, the rest pop everything that was pushed between them
+    class Producer_Consumer_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        explicit Producer_Consumer_Fixture(std::size_t producers)
+            : producers_(producers)
+        {
+        }
+
+        void set_up(std::size_t threads) override
+        {
+            this->queue_ = std::make_unique<Penguin::Unbounded_Queue<std::size_t>>();
+            this->consumers_ = threads - this->producers_;
+        }
+
+        void run(std::size_t thread_index, std::size_t iterations) override
+        {
+            if (thread_index < this->producers_)
+            {
+                for (std::size_t i = 0; i < iterations; ++i)
+                {
+                    this->queue_->push(i);
+                }
+            }
+            else
+            {
+                // Spread the producers' items over the consumers, the first ones take the remainder
+                std::size_t consumer_index = thread_index - this->producers_;
+                std::size_t total = this->producers_ * iterations;
+                std::size_t share = total / this->consumers_ + (consumer_index < total % this->consumers_ ? 1 : 0);
+                for (std::size_t i = 0; i < share; ++i)
+                {
+                    Penguin::do_not_optimize(this->queue_->pop());
+                }
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->queue_.reset();
+        }
+
+    private:
+        std::size_t                                                 producers_;
+        std::size_t                                                 consumers_ = 1;
+        std::unique_ptr<Penguin::Unbounded_Queue<std::size_t>>      queue_;
+    };
+
+
+    // The baseline for the lock-free queue, a deque behind a mutex with the same non-blocking interface
+    class Mutex_Queue
+    {
+    public:
+        struct Handle
+        {
+            explicit Handle(Mutex_Queue&)
+            {
+            }
+        };
+
+        void push(Handle&, std::size_t value)
+        {
+            std::lock_guard<std::mutex> guard(this->mutex_);
+            this->items_.push_back(value);
+        }
+
+        bool try_pop(Handle&, std::size_t& value)
+        {
+            std::lock_guard<std::mutex> guard(this->mutex_);
+            if (this->items_.empty())
+            {
+                return false;
+            }
+            value = this->items_.front();
+            this->items_.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex              mutex_;
+        std::deque<std::size_t> items_;
+    };
+
+
+    // A Michael-Scott queue whose dequeued nodes are reclaimed through hazard pointers: slot 0 holds
+    // the head or tail being worked on and slot 1 the head's successor
+    template <Penguin::Hazard_Pointer_Domain::Fence Fence>
+    class Hazard_Queue
+    {
+    private:
+        struct Node
+        {
+            std::atomic<Node*>  next{nullptr};
+            std::size_t         value = 0;
+        };
+
+    public:
+        class Handle
+        {
+        public:
+            explicit Handle(Hazard_Queue& queue)
+                : participant_(queue.domain_)
+            {
+            }
+
+        private:
+            friend class Hazard_Queue;
+            Penguin::Hazard_Pointer_Domain::Participant participant_;
+        };
+
+        Hazard_Queue(void)
+            : domain_(Fence)
+        {
+            Node* dummy = new Node();
+            this->head_.store(dummy);
+            this->tail_.store(dummy);
+        }
+
+        ~Hazard_Queue(void)
+        {
+            Node* node = this->head_.load();
+            while (node != nullptr)
+            {
+                Node* next = node->next.load();
+                delete node;
+                node = next;
+            }
+        }
+
+        void push(Handle& handle, std::size_t value)
+        {
+            Penguin::Hazard_Pointer_Domain::Participant& participant = handle.participant_;
+            Node* node = new Node();
+            node->value = value;
+            for (;;)
+            {
+                Node* tail = participant.protect(0, this->tail_);
+                Node* next = tail->next.load(std::memory_order_acquire);
+                if (next != nullptr)
+                {
+                    // Help a push that linked its node but has not swung the tail yet
+                    this->tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                    continue;
+                }
+                if (tail->next.compare_exchange_weak(next, node, std::memory_order_release, std::memory_order_relaxed))
+                {
+                    this->tail_.compare_exchange_strong(tail, node, std::memory_order_release, std::memory_order_relaxed);
+                    break;
+                }
+            }
+            participant.clear(0);
+        }
+
+        bool try_pop(Handle& handle, std::size_t& value)
+        {
+            Penguin::Hazard_Pointer_Domain::Participant& participant = handle.participant_;
+            for (;;)
+            {
+                Node* head = participant.protect(0, this->head_);
+                Node* next = participant.protect(1, head->next);
+                if (head != this->head_.load(std::memory_order_acquire))
+                {
+                    continue;
+                }
+                if (next == nullptr)
+                {
+                    participant.clear();
+                    return false;
+                }
+                Node* tail = this->tail_.load(std::memory_order_acquire);
+                if (head == tail)
+                {
+                    this->tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                    continue;
+                }
+                // The successor becomes the new dummy, its value is read while it is still protected
+                value = next->value;
+                if (this->head_.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+                {
+                    participant.clear();
+                    participant.retire(head);
+                    return true;
+                }
+            }
+        }
+
+    private:
+        Penguin::Hazard_Pointer_Domain  domain_;
+        alignas(64) std::atomic<Node*>  head_;
+        alignas(64) std::atomic<Node*>  tail_;
+    };
+
+
+    // Like Producer_Consumer_Fixture, with consumers polling a non-blocking queue
+    template <class Queue>
+    class Polling_Queue_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        explicit Polling_Queue_Fixture(std::size_t producers)
+            : producers_(producers)
+        {
+        }
+
+        void set_up(std::size_t threads) override
+        {
+            this->queue_ = std::make_unique<Queue>();
+            this->consumers_ = threads - this->producers_;
+        }
+
+        void run(std::size_t thread_index, std::size_t iterations) override
+        {
+            typename Queue::Handle handle(*this->queue_);
+            if (thread_index < this->producers_)
+            {
+                for (std::size_t i = 0; i < iterations; ++i)
+                {
+                    this->queue_->push(handle, i);
+                }
+            }
+            else
+            {
+                std::size_t consumer_index = thread_index - this->producers_;
+                std::size_t total = this->producers_ * iterations;
+                std::size_t share = total / this->consumers_ + (consumer_index < total % this->consumers_ ? 1 : 0);
+                std::size_t value = 0;
+                for (std::size_t i = 0; i < share; ++i)
+                {
+                    while (!this->queue_->try_pop(handle, value))
+                    {
+                        std::this_thread::yield();
+                    }
+                    Penguin::do_not_optimize(value);
+                }
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->queue_.reset();
+        }
+
+    private:
+        std::size_t             producers_;
+        std::size_t             consumers_ = 1;
+        std::unique_ptr<Queue>  queue_;
+    };
+
+
+    // A large buffer, past the size malloc serves from its own free lists
+    struct Pooled_Buffer
+    {
+        char bytes[256 * 1024];
+    };
+
+
+    // The baselines for Object_Pool: no pool at all, and one vector behind a Monitor
+    class New_Delete_Pool
+    {
+    public:
+        Pooled_Buffer* acquire(void)
+        {
+            return new Pooled_Buffer;
+        }
+
+        void release(Pooled_Buffer* buffer)
+        {
+            delete buffer;
+        }
+    };
+
+
+    class Monitor_Pool
+    {
+    public:
+        ~Monitor_Pool(void)
+        {
+            for (Pooled_Buffer* buffer : this->buffers_)
+            {
+                delete buffer;
+            }
+        }
+
+        Pooled_Buffer* acquire(void)
+        {
+            {
+                Penguin::Monitor::_guard_type guard(this->monitor_);
+                if (!this->buffers_.empty())
+                {
+                    Pooled_Buffer* buffer = this->buffers_.back();
+                    this->buffers_.pop_back();
+                    return buffer;
+                }
+            }
+            return new Pooled_Buffer;
+        }
+
+        void release(Pooled_Buffer* buffer)
+        {
+            Penguin::Monitor::_guard_type guard(this->monitor_);
+            this->buffers_.push_back(buffer);
+        }
+
+    private:
+        Penguin::Monitor                monitor_;
+        std::vector<Pooled_Buffer*>     buffers_;
+    };
+
+
+    // Every thread takes a handful of buffers, writes to each and gives them all back
+    template <class Pool>
+    class Pool_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        static constexpr std::size_t BUFFERS_HELD = 8;
+
+        void set_up(std::size_t) override
+        {
+            this->pool_ = std::make_unique<Pool>();
+        }
+
+        void run(std::size_t, std::size_t iterations) override
+        {
+            Pooled_Buffer* held[BUFFERS_HELD];
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                for (Pooled_Buffer*& buffer : held)
+                {
+                    buffer = this->pool_->acquire();
+                    buffer->bytes[0] = static_cast<char>(i);
+                    Penguin::clobber_memory();
+                }
+                for (Pooled_Buffer* buffer : held)
+                {
+                    this->pool_->release(buffer);
+                }
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->pool_.reset();
+        }
+
+    private:
+        std::unique_ptr<Pool> pool_;
+    };
+
+
+    // Thread 0 broadcasts a new generation, every other thread wakes, sees it and acknowledges. Besides
+    // the time per round it tracks how long each waiter took to get going and how many context
+    // switches every broadcast cost.
+    template <class Policy>
+    class Thundering_Herd_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        void set_up(std::size_t threads) override
+        {
+            this->waiters_ = threads - 1;
+            this->generation_ = 0;
+            this->acknowledgements_.store(0);
+            this->context_switches_at_set_up_ = get_context_switches();
+        }
+
+        void run(std::size_t thread_index, std::size_t iterations) override
+        {
+            if (thread_index == 0)
+            {
+                for (std::size_t round = 1; round <= iterations; ++round)
+                {
+                    {
+                        typename Penguin::Basic_Monitor<Policy>::_guard_type guard(this->monitor_);
+                        this->generation_ = round;
+                        this->broadcast_time_ = std::chrono::steady_clock::now();
+                        this->monitor_.notify_all();
+                    }
+                    while (this->acknowledgements_.load(std::memory_order_acquire) < round * this->waiters_)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                this->rounds_ += iterations;
+            }
+            else
+            {
+                for (std::size_t round = 1; round <= iterations; ++round)
+                {
+                    std::chrono::steady_clock::duration latency;
+                    {
+                        typename Penguin::Basic_Monitor<Policy>::_guard_type guard(this->monitor_);
+                        this->monitor_.wait(guard, [this, round] {return this->generation_ >= round; });
+                        latency = std::chrono::steady_clock::now() - this->broadcast_time_;
+                    }
+                    this->wake_latency_ns_.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()), std::memory_order_relaxed);
+                    this->wakes_.fetch_add(1, std::memory_order_relaxed);
+                    this->acknowledgements_.fetch_add(1, std::memory_order_release);
+                }
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->context_switches_ += get_context_switches() - this->context_switches_at_set_up_;
+        }
+
+        // Over every sample run so far, empty if filtered out
+        std::string summary(void) const
+        {
+            if (this->rounds_ == 0)
+            {
+                return std::string();
+            }
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(2)
+                << (this->wakes_.load() ? this->wake_latency_ns_.load() / 1000.0 / this->wakes_.load() : 0.0) << "us mean wake latency, "
+                << static_cast<double>(this->context_switches_) / this->rounds_ << " context switches per broadcast";
+            return stream.str();
+        }
+
+    private:
+        static long get_context_switches(void)
+        {
+#if defined(__linux__)
+            // Summed over every thread in the process
+            rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            return usage.ru_nvcsw + usage.ru_nivcsw;
+#else
+            return 0;
+#endif
+        }
+
+    private:
+        Penguin::Basic_Monitor<Policy>          monitor_;
+        std::size_t                             waiters_ = 0;
+        std::size_t                             generation_ = 0;
+        std::chrono::steady_clock::time_point   broadcast_time_;
+        std::atomic<std::size_t>                acknowledgements_{0};
+        std::atomic<std::uint64_t>              wake_latency_ns_{0};
+        std::atomic<std::uint64_t>              wakes_{0};
+        std::size_t                             rounds_ = 0;
+        long                                    context_switches_ = 0;
+        long                                    context_switches_at_set_up_ = 0;
+    };
+
+
+    // The home-made barrier Penguin::Barrier replaces, a Monitor, a counter and notify_all
+    class Monitor_Barrier
+    {
+    public:
+        explicit Monitor_Barrier(std::size_t participants)
+            : participants_(participants)
+        {
+        }
+
+        void arrive_and_wait(void)
+        {
+            Penguin::Monitor::_guard_type guard(this->monitor_);
+            std::size_t phase = this->phase_;
+            if (++this->arrived_ == this->participants_)
+            {
+                this->arrived_ = 0;
+                ++this->phase_;
+                this->monitor_.notify_all();
+            }
+            else
+            {
+                this->monitor_.wait(guard, [this, phase] {return this->phase_ != phase; });
+            }
+        }
+
+    private:
+        Penguin::Monitor    monitor_;
+        std::size_t         participants_;
+        std::size_t         arrived_ = 0;
+        std::size_t         phase_ = 0;
+    };
+
+
+    // Every thread passes the barrier once per iteration, the time per iteration is one phase
+    template <class Barrier_Type>
+    class Barrier_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        void set_up(std::size_t threads) override
+        {
+            this->barrier_ = std::make_unique<Barrier_Type>(static_cast<std::uint32_t>(threads));
+        }
+
+        void run(std::size_t, std::size_t iterations) override
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                this->barrier_->arrive_and_wait();
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->barrier_.reset();
+        }
+
+    private:
+        std::unique_ptr<Barrier_Type> barrier_;
+    };
+
+
+    // Every thread times out on an empty semaphore, the time per iteration is the real wait
+    class Timed_Wait_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        explicit Timed_Wait_Fixture(std::chrono::microseconds timeout)
+            : timeout_(timeout)
+        {
+        }
+
+        void run(std::size_t, std::size_t iterations) override
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(this->semaphore_.try_acquire_for(this->timeout_));
+            }
+        }
+
+    private:
+        std::chrono::microseconds   timeout_;
+        Penguin::Semaphore          semaphore_;
+    };
+
+
+    // Every thread takes the same lock for a critical section of a few dozen nanoseconds
+    template <class Policy>
+    class Critical_Section_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        void run(std::size_t thread_index, std::size_t iterations) override
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                typename Penguin::Basic_Monitor<Policy>::_guard_type guard(this->monitor_);
+                this->counters_[i % this->counters_.size()] += thread_index;
+                Penguin::clobber_memory();
+            }
+        }
+
+    private:
+        Penguin::Basic_Monitor<Policy>  monitor_;
+        std::vector<std::size_t>        counters_ = std::vector<std::size_t>(8);
+    };
+
+
+    template <class Policy>
+    void benchmark_critical_section(Penguin::Benchmark& benchmark, const std::string& policy_name)
+    {
+        Critical_Section_Fixture<Policy> fixture;
+        for (std::size_t threads : benchmark.get_thread_counts())
+        {
+            benchmark.run_threaded("Monitor<" + policy_name + "> short critical section", threads, fixture);
+        }
+    }
+
+
+    // Every thread takes a shared lock to read a small table, nobody writes
+    template <class Shared_Mutex>
+    class Shared_Read_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        void run(std::size_t thread_index, std::size_t iterations) override
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                std::shared_lock<Shared_Mutex> guard(this->mutex_);
+                Penguin::do_not_optimize(this->table_[(thread_index + i) % this->table_.size()]);
+            }
+        }
+
+    private:
+        Shared_Mutex                mutex_;
+        std::vector<std::size_t>    table_ = std::vector<std::size_t>(8);
+    };
+
+
+    template <class Shared_Mutex>
+    void benchmark_shared_read(Penguin::Benchmark& benchmark, const std::string& mutex_name)
+    {
+        // Read scaling is the point, so go past the processor count regardless of --threads
+        Shared_Read_Fixture<Shared_Mutex> fixture;
+        for (std::size_t threads = 1; threads <= 64; threads *= 2)
+        {
+            benchmark.run_threaded(mutex_name + " shared read", threads, fixture);
+        }
+    }
+
+
+    // Every thread snapshots a small routing entry, optionally while one more thread rewrites it
+    class Seqlock_Read_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        struct Route
+        {
+            std::uint64_t destination;
+            std::uint64_t next_hop;
+            std::uint64_t metric;
+            std::uint64_t flags;
+        };
+
+        explicit Seqlock_Read_Fixture(bool with_writer)
+            : with_writer_(with_writer)
+        {
+        }
+
+        void set_up(std::size_t) override
+        {
+            this->stop_.store(false);
+            if (this->with_writer_)
+            {
+                this->writer_ = std::thread([this] {
+                    while (!this->stop_.load(std::memory_order_relaxed))
+                    {
+                        this->route_.update([](Route& route) { ++route.metric; });
+                        std::this_thread::yield();
+                    }
+                });
+            }
+        }
+
+        void run(std::size_t, std::size_t iterations) override
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(this->route_.load());
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->stop_.store(true);
+            if (this->writer_.joinable())
+            {
+                this->writer_.join();
+            }
+        }
+
+    private:
+        bool                        with_writer_;
+        Penguin::Seqlock<Route>     route_;
+        std::atomic<bool>           stop_{false};
+        std::thread                 writer_;
+    };
+
+
+    void benchmark_seqlock_read(Penguin::Benchmark& benchmark)
+    {
+        for (bool with_writer : {false, true})
+        {
+            Seqlock_Read_Fixture fixture(with_writer);
+            for (std::size_t threads = 1; threads <= 64; threads *= 2)
+            {
+                benchmark.run_threaded(with_writer ? "Seqlock read beside a writer" : "Seqlock read", threads, fixture);
+            }
+        }
+    }
+
+
+    // Every thread reads a small table inside an epoch critical section, optionally while one more
+    // thread keeps replacing the table and retiring the old one
+    class Epoch_Read_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        struct Table
+        {
+            std::size_t values[8] = {};
+        };
+
+        explicit Epoch_Read_Fixture(bool with_writer)
+            : with_writer_(with_writer)
+        {
+        }
+
+        void set_up(std::size_t) override
+        {
+            this->domain_ = std::make_unique<Penguin::Epoch_Domain>();
+            this->table_.store(new Table());
+            this->stop_.store(false);
+            if (this->with_writer_)
+            {
+                this->writer_ = std::thread([this] {
+                    Penguin::Epoch_Domain::Participant participant(*this->domain_);
+                    while (!this->stop_.load(std::memory_order_relaxed))
+                    {
+                        participant.retire(this->table_.exchange(new Table(), std::memory_order_acq_rel));
+                        std::this_thread::yield();
+                    }
+                });
+            }
+        }
+
+        void run(std::size_t thread_index, std::size_t iterations) override
+        {
+            Penguin::Epoch_Domain::Participant participant(*this->domain_);
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::Epoch_Domain::Guard guard(participant);
+                Penguin::do_not_optimize(this->table_.load(std::memory_order_acquire)->values[(thread_index + i) % 8]);
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->stop_.store(true);
+            if (this->writer_.joinable())
+            {
+                this->writer_.join();
+            }
+            delete this->table_.load();
+            this->domain_.reset();
+        }
+
+    private:
+        bool                                    with_writer_;
+        std::unique_ptr<Penguin::Epoch_Domain>  domain_;
+        std::atomic<Table*>                     table_{nullptr};
+        std::atomic<bool>                       stop_{false};
+        std::thread                             writer_;
+    };
+
+
+    void benchmark_epoch_read(Penguin::Benchmark& benchmark)
+    {
+        for (bool with_writer : {false, true})
+        {
+            Epoch_Read_Fixture fixture(with_writer);
+            for (std::size_t threads = 1; threads <= 64; threads *= 2)
+            {
+                benchmark.run_threaded(with_writer ? "Epoch_Domain read beside a writer" : "Epoch_Domain read", threads, fixture);
+            }
+        }
+    }
+
+
+    void benchmark_ping_pong(Penguin::Benchmark& benchmark)
+    {
+        Ping_Pong_Fixture fixture;
+        for (std::size_t threads : benchmark.get_thread_counts(2))
+        {
+            threads &= ~std::size_t(1);
+            benchmark.run_threaded("Semaphore ping-pong round trip", threads, fixture, threads / 2);
+        }
+    }
+
+
+    void benchmark_producer_consumer(Penguin::Benchmark& benchmark)
+    {
+        for (std::size_t threads : benchmark.get_thread_counts(2))
+        {
+            std::vector<std::size_t> producer_counts = {1, threads / 2, threads - 1};
+            std::sort(producer_counts.begin(), producer_counts.end());
+            producer_counts.erase(std::unique(producer_counts.begin(), producer_counts.end()), producer_counts.end());
+            for (std::size_t producers : producer_counts)
+            {
+                std::ostringstream name;
+                name << "Unbounded_Queue " << producers << " producers:" << threads - producers << " consumers";
+                Producer_Consumer_Fixture fixture(producers);
+                benchmark.run_threaded(name.str(), threads, fixture, producers);
+            }
+        }
+    }
+
+
+    template <class Queue>
+    void benchmark_polling_queue(Penguin::Benchmark& benchmark, const std::string& queue_name)
+    {
+        for (std::size_t threads : benchmark.get_thread_counts(2))
+        {
+            std::ostringstream name;
+            name << queue_name << " " << threads / 2 << " producers:" << threads - threads / 2 << " consumers";
+            Polling_Queue_Fixture<Queue> fixture(threads / 2);
+            benchmark.run_threaded(name.str(), threads, fixture, threads / 2);
+        }
+    }
+
+
+    template <class Pool>
+    void benchmark_pool(Penguin::Benchmark& benchmark, const std::string& pool_name)
+    {
+        Pool_Fixture<Pool> fixture;
+        for (std::size_t threads : benchmark.get_thread_counts())
+        {
+            benchmark.run_threaded(pool_name + " acquire+release", threads, fixture, threads * Pool_Fixture<Pool>::BUFFERS_HELD);
+        }
+    }
+
+
+    template <class Policy>
+    void benchmark_thundering_herd(Penguin::Benchmark& benchmark, const std::string& policy_name, std::vector<std::string>& summaries)
+    {
+        Thundering_Herd_Fixture<Policy> fixture;
+        for (std::size_t threads : benchmark.get_thread_counts(2))
+        {
+            benchmark.run_threaded("Monitor<" + policy_name + "> notify_all wake of every waiter", threads, fixture);
+        }
+
+        // The broadcast that motivated requeueing, regardless of the processor count
+        Thundering_Herd_Fixture<Policy> herd_fixture;
+        std::string name = "Monitor<" + policy_name + "> notify_all to 64 waiters";
+        benchmark.run_threaded(name, 65, herd_fixture);
+        std::string summary = herd_fixture.summary();
+        if (!summary.empty())
+        {
+            summaries.push_back(name + ": " + summary);
+        }
+    }
+
+
+    template <class Barrier_Type>
+    void benchmark_barrier(Penguin::Benchmark& benchmark, const std::string& barrier_name)
+    {
+        Barrier_Fixture<Barrier_Type> fixture;
+        std::vector<std::size_t> thread_counts = benchmark.get_thread_counts(2);
+        if (thread_counts.back() < 64)
+        {
+            thread_counts.push_back(64);
+        }
+        for (std::size_t threads : thread_counts)
+        {
+            benchmark.run_threaded(barrier_name + " phase", threads, fixture);
+        }
+    }
+
+
+    void benchmark_timed_wait(Penguin::Benchmark& benchmark)
+    {
+        for (std::chrono::microseconds timeout : {std::chrono::microseconds(50), std::chrono::microseconds(500), std::chrono::microseconds(5000)})
+        {
+            std::ostringstream name;
+            name << "Semaphore try_acquire_for(" << timeout.count() << "us) actual wait";
+            Timed_Wait_Fixture fixture(timeout);
+            for (std::size_t threads : benchmark.get_thread_counts())
+            {
+                benchmark.run_threaded(name.str(), threads, fixture);
+            }
+        }
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    Penguin::Benchmark benchmark("Benchmark_Contention");
+    if (!benchmark.parse_arguments(argc, argv))
+    {
+        return 2;
+    }
+
+    benchmark_critical_section<Penguin::Std_Mutex_Policy>(benchmark, "Std_Mutex_Policy");
+    benchmark_critical_section<Penguin::Adaptive_Mutex_Policy>(benchmark, "Adaptive_Mutex_Policy");
+    benchmark_critical_section<Penguin::Ticket_Lock_Policy>(benchmark, "Ticket_Lock_Policy");
+    benchmark_critical_section<Penguin::Profiled_Policy<Penguin::Std_Mutex_Policy>>(benchmark, "Profiled_Policy<Std_Mutex_Policy>");
+    benchmark_shared_read<std::shared_mutex>(benchmark, "std::shared_mutex");
+    benchmark_shared_read<Penguin::Shared_Monitor::_mutex_type>(benchmark, "Shared_Monitor");
+    benchmark_seqlock_read(benchmark);
+    benchmark_epoch_read(benchmark);
+    benchmark_ping_pong(benchmark);
+    benchmark_producer_consumer(benchmark);
+    benchmark_polling_queue<Mutex_Queue>(benchmark, "Mutex queue");
+    benchmark_polling_queue<Hazard_Queue<Penguin::Hazard_Pointer_Domain::Fence::SYMMETRIC>>(benchmark, "Hazard_Pointer queue");
+    benchmark_polling_queue<Hazard_Queue<Penguin::Hazard_Pointer_Domain::Fence::ASYMMETRIC>>(benchmark, "Hazard_Pointer queue (membarrier)");
+    benchmark_pool<New_Delete_Pool>(benchmark, "new/delete");
+    benchmark_pool<Monitor_Pool>(benchmark, "Monitor pool");
+    benchmark_pool<Penguin::Object_Pool<Pooled_Buffer>>(benchmark, "Object_Pool");
+    std::vector<std::string> herd_summaries;
+    benchmark_thundering_herd<Penguin::Std_Mutex_Policy>(benchmark, "Std_Mutex_Policy", herd_summaries);
+    benchmark_thundering_herd<Penguin::Futex_Policy>(benchmark, "Futex_Policy", herd_summaries);
+    benchmark_barrier<Monitor_Barrier>(benchmark, "Monitor barrier");
+    benchmark_barrier<Penguin::Barrier>(benchmark, "Barrier");
+    benchmark_timed_wait(benchmark);
+
+    int result = benchmark.report();
+    for (const std::string& summary : herd_summaries)
+    {
+        std::cout << summary << '\n';
+    }
+    return result;
+}
@@ -0,0 +1,51 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Benchmark_Plugin_Table.h"
+#include <cmath>
+#include <cstdlib>
+
+
+// Calls many distinct imports, each of which lazy binding resolves on its first call after loading
+extern "C" PENGUIN_PLUGIN_EXPORT double benchmark_plugin_function(double value)
+{
+    double result = std::sin(value) + std::cos(value) + std::tan(value);
+    result += std::exp(value) + std::log(value + 2.0) + std::log10(value + 2.0);
+    result += std::pow(value, 1.5) + std::atan2(value, 2.0) + std::cbrt(value);
+    result += std::hypot(value, 3.0) + std::erf(value) + std::lgamma(value + 1.0);
+    result += std::tgamma(value + 1.0) + std::sinh(value) + std::cosh(value);
+    result += std::asinh(value) + std::expm1(value) + std::log1p(value);
+    result += std::strtod("1.5", nullptr) + static_cast<double>(std::strtol("7", nullptr, 10));
+    return result;
+}
+
+
+extern "C" PENGUIN_PLUGIN_EXPORT double benchmark_plugin_square(double value)
+{
+    return value * value;
+}
+
+
+extern "C" PENGUIN_PLUGIN_EXPORT double benchmark_plugin_cube(double value)
+{
+    return value * value * value;
+}
+
+
+extern "C" PENGUIN_PLUGIN_EXPORT double benchmark_plugin_negate(double value)
+{
+    return -value;
+}
+
+
+extern "C" PENGUIN_PLUGIN_EXPORT const Penguin::Plugin_Header* penguin_plugin_entry_point(void)
+{
+    static const Benchmark_Plugin_Table table = {
+        Penguin::make_plugin_header<Benchmark_Plugin_Table>(benchmark_plugin_table_name, benchmark_plugin_table_version),
+        &benchmark_plugin_function,
+        &benchmark_plugin_square,
+        &benchmark_plugin_cube,
+        &benchmark_plugin_negate
+    };
+    return &table.header;
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_BENCHMARK_PLUGIN_TABLE_H
+#define PENGUIN_BENCHMARK_PLUGIN_TABLE_H
+
+
+#include <penguin/Plugin.h>
+
+
+// What the benchmark plugin exports through its entry point, also exported one by one for comparison
+struct Benchmark_Plugin_Table
+{
+    Penguin::Plugin_Header  header;
+    double                  (*function)(double value);
+    double                  (*square)(double value);
+    double                  (*cube)(double value);
+    double                  (*negate)(double value);
+};
+
+
+constexpr char          benchmark_plugin_table_name[] = "benchmark";
+constexpr std::uint32_t benchmark_plugin_table_version = 1;
+
+
+#endif // PENGUIN_BENCHMARK_PLUGIN_TABLE_H
@@ -0,0 +1,420 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Benchmark_Plugin_Table.h"
+#include <penguin/Arena.h>
+#include <penguin/Benchmark.h>
+#include <penguin/Dynamic_Library.h>
+#include <penguin/Epoch_Domain.h>
+#include <penguin/Event_Count.h>
+#include <penguin/Hot_Library.h>
+#include <penguin/Monitor.h>
+#include <penguin/Rate_Limiter.h>
+#include <penguin/Scoped_Timer.h>
+#include <penguin/Semaphore.h>
+#include <penguin/Timer.h>
+#include <penguin/Unbounded_Queue.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    // Every thread releases and then acquires a permit of the same semaphore
+    class Shared_Semaphore_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        void set_up(std::size_t) override
+        {
+            this->semaphore_ = std::make_unique<Penguin::Semaphore>(0);
+        }
+
+        void run(std::size_t, std::size_t iterations) override
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                this->semaphore_->release();
+                this->semaphore_->acquire();
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->semaphore_.reset();
+        }
+
+    private:
+        std::unique_ptr<Penguin::Semaphore> semaphore_;
+    };
+
+
+    // Loads the benchmark plugin afresh every iteration and times only the first call into it, the
+    // latency a request sees when it is the first through a newly deployed plugin
+    class First_Call_Probe
+    {
+    public:
+        explicit First_Call_Probe(Penguin::Load_Options options)
+            : options_(std::move(options))
+        {
+        }
+
+        void run(std::size_t iterations)
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::Library library(PENGUIN_BENCHMARK_PLUGIN_PATH, this->options_);
+                double (*function)(double) = library.get<double(double)>("benchmark_plugin_function");
+                std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+                Penguin::do_not_optimize(function(0.5));
+                this->first_calls_.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count());
+            }
+        }
+
+        std::string summary(void)
+        {
+            if (this->first_calls_.empty())
+            {
+                return std::string();
+            }
+            std::nth_element(this->first_calls_.begin(), this->first_calls_.begin() + this->first_calls_.size() / 2, this->first_calls_.end());
+            std::ostringstream summary;
+            summary << "median first call " << this->first_calls_[this->first_calls_.size() / 2] << "ns over " << this->first_calls_.size() << " loads";
+            return summary.str();
+        }
+
+    private:
+        Penguin::Load_Options   options_;
+        std::vector<double>     first_calls_;
+    };
+
+
+    void benchmark_plugin_calls(Penguin::Benchmark& benchmark, std::vector<std::string>& summaries)
+    {
+        Penguin::Load_Options lazy;
+        Penguin::Load_Options now;
+        now.binding = Penguin::Load_Options::Binding::NOW;
+        Penguin::Load_Options prewarmed(now);
+        prewarmed.prewarm_symbols = { "benchmark_plugin_function" };
+        prewarmed.prefetch_pages = true;
+
+        const std::pair<std::string, Penguin::Load_Options> modes[] = {
+            { "lazy binding", lazy },
+            { "binding now", now },
+            { "binding now, prewarmed", prewarmed }
+        };
+        for (const std::pair<std::string, Penguin::Load_Options>& mode : modes)
+        {
+            First_Call_Probe probe(mode.second);
+            std::string name = "Plugin load+first call (" + mode.first + ")";
+            benchmark.run(name, [&probe](std::size_t iterations) { probe.run(iterations); });
+            std::string summary = probe.summary();
+            if (!summary.empty())
+            {
+                summaries.push_back(name + ": " + summary);
+            }
+        }
+
+        Penguin::Library library(PENGUIN_BENCHMARK_PLUGIN_PATH);
+        double (*function)(double) = library.get<double(double)>("benchmark_plugin_function");
+        benchmark.run("Plugin call (steady state)", [function](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(function(0.5));
+            }
+        });
+
+        // Four functions resolved one at a time, against one entry point returning all four
+        benchmark.run("Resolve 4 functions with get_library_function", [&library](std::size_t iterations) {
+            const char* function_names[] = { "benchmark_plugin_function", "benchmark_plugin_square", "benchmark_plugin_cube", "benchmark_plugin_negate" };
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                for (const char* function_name : function_names)
+                {
+                    Penguin::do_not_optimize(Penguin::get_library_function(library.get_handle(), function_name));
+                }
+            }
+        });
+
+        benchmark.run("Resolve 4 functions through the plugin entry point", [&library](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::Plugin_Entry_Point entry_point = reinterpret_cast<Penguin::Plugin_Entry_Point>(Penguin::get_library_function(library.get_handle(), Penguin::plugin_entry_point_name));
+                const Penguin::Plugin_Header* header = entry_point();
+                Penguin::do_not_optimize(Penguin::check_plugin_header(header, benchmark_plugin_table_name, benchmark_plugin_table_version, sizeof(Benchmark_Plugin_Table)));
+            }
+        });
+
+        // The same call, pinning the current version of a reloadable copy around each one
+        Penguin::Hot_Library hot_library(PENGUIN_BENCHMARK_PLUGIN_PATH, { "benchmark_plugin_function" });
+        benchmark.run("Plugin call through Hot_Library::Reader", [&hot_library](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::Hot_Library::Reader reader(hot_library);
+                Penguin::do_not_optimize(reader->get<double(double)>(0)(0.5));
+            }
+        });
+    }
+
+
+    void benchmark_semaphore(Penguin::Benchmark& benchmark)
+    {
+        Penguin::Semaphore semaphore(0);
+        benchmark.run("Semaphore release+acquire", [&semaphore](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                semaphore.release();
+                semaphore.acquire();
+            }
+        });
+
+        Shared_Semaphore_Fixture fixture;
+        for (std::size_t threads : benchmark.get_thread_counts())
+        {
+            benchmark.run_threaded("Semaphore release+acquire (shared)", threads, fixture);
+        }
+    }
+
+
+    void benchmark_monitor(Penguin::Benchmark& benchmark)
+    {
+        Penguin::Monitor monitor;
+        benchmark.run("Monitor lock+unlock", [&monitor](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::Monitor::_guard_type guard(monitor);
+                Penguin::clobber_memory();
+            }
+        });
+
+        benchmark.run("Monitor notify_one without waiters", [&monitor](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                monitor.notify_one();
+            }
+        });
+    }
+
+
+    void benchmark_library(Penguin::Benchmark& benchmark)
+    {
+        Penguin::Library library("Penguin");
+        benchmark.run("Library get (cached)", [&library](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(library.get<int(void)>("test_library_function"));
+            }
+        });
+
+        benchmark.run("get_library_function (dlsym)", [&library](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(Penguin::get_library_function(library.get_handle(), "test_library_function"));
+            }
+        });
+
+        // Repeat loads of a library something already holds, as components starting up do
+        Penguin::Library_Registry::Reference held = Penguin::Library_Registry::get().load("Penguin");
+        benchmark.run("Library_Registry load (already open)", [](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::Library_Registry::Reference library = Penguin::Library_Registry::get().load("Penguin");
+                Penguin::do_not_optimize(library.get());
+            }
+        });
+
+        // Never closed, as load_library() callers do; the loader only counts another reference
+        benchmark.run("load_library (dlopen)", [](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(Penguin::load_library("Penguin"));
+            }
+        });
+    }
+
+
+    // What one request might allocate: work items queued and drained into a list of results, each
+    // too long for the small string buffer
+    void serve_request(std::pmr::memory_resource* resource)
+    {
+        Penguin::Unbounded_Queue<std::pmr::string> work(resource);
+        for (int i = 0; i < 32; ++i)
+        {
+            work.push(std::pmr::string("a work item long enough to need the heap", resource));
+        }
+        std::pmr::vector<std::pmr::string> results(resource);
+        for (int i = 0; i < 32; ++i)
+        {
+            results.push_back(work.pop());
+        }
+        Penguin::do_not_optimize(results.back().size());
+    }
+
+
+    void benchmark_arena(Penguin::Benchmark& benchmark)
+    {
+        benchmark.run("Request on the default heap", [](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                serve_request(std::pmr::get_default_resource());
+            }
+        });
+
+        Penguin::Arena arena;
+        benchmark.run("Request in an Arena, reset after", [&arena](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                serve_request(&arena);
+                arena.reset();
+            }
+        });
+    }
+
+
+    void benchmark_epoch_domain(Penguin::Benchmark& benchmark)
+    {
+        Penguin::Epoch_Domain domain;
+        Penguin::Epoch_Domain::Participant participant(domain);
+        benchmark.run("Epoch_Domain enter+leave", [&participant](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::Epoch_Domain::Guard guard(participant);
+                Penguin::clobber_memory();
+            }
+        });
+
+        // Includes the batched reclaim, and the delete once the node is safe
+        benchmark.run("Epoch_Domain retire", [&participant](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                participant.retire(new std::uint64_t(i));
+            }
+        });
+    }
+
+
+    void benchmark_event_count(Penguin::Benchmark& benchmark)
+    {
+        Penguin::Event_Count event_count;
+        benchmark.run("Event_Count notify without waiters", [&event_count](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                event_count.notify();
+            }
+        });
+    }
+
+
+    void benchmark_rate_limiter(Penguin::Benchmark& benchmark)
+    {
+        // Fast enough never to run dry, so only the lock-free bookkeeping is measured
+        Penguin::Rate_Limiter limiter(1e15, 1000000);
+        benchmark.run("Rate_Limiter try_acquire", [&limiter](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(limiter.try_acquire());
+            }
+        });
+    }
+
+
+    void benchmark_unbounded_queue(Penguin::Benchmark& benchmark)
+    {
+        Penguin::Unbounded_Queue<int> queue;
+        benchmark.run("Unbounded_Queue push+pop", [&queue](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                queue.push(static_cast<int>(i));
+                Penguin::do_not_optimize(queue.pop());
+            }
+        });
+    }
+
+
+    void benchmark_timers(Penguin::Benchmark& benchmark)
+    {
+        benchmark.run("Timer start+stop", [](std::size_t iterations) {
+            Penguin::Timer<double, std::nano> timer;
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                timer.start();
+                timer.stop();
+            }
+            Penguin::do_not_optimize(timer.get_finish_duration());
+        });
+
+        benchmark.run("Timer start+stop (plain flag)", [](std::size_t iterations) {
+            Penguin::Timer<double, std::nano, Penguin::Plain_Finish_Flag> timer;
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                timer.start();
+                timer.stop();
+            }
+            Penguin::do_not_optimize(timer.get_finish_duration());
+        });
+
+        benchmark.run("Timer lap", [](std::size_t iterations) {
+            Penguin::Timer<double, std::nano, Penguin::Plain_Finish_Flag> timer;
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(timer.lap());
+            }
+        });
+
+        benchmark.run("Scoped_Timer with callback", [](std::size_t iterations) {
+            double total = 0.0;
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::Scoped_Timer<double, std::nano> timer([&total](const Penguin::Scoped_Timer<double, std::nano>& finished) {
+                    total += finished.get_finish_duration().value().count();
+                });
+            }
+            Penguin::do_not_optimize(total);
+        });
+
+        benchmark.run("Scoped_Timer with callback sampled 1 in 100", [](std::size_t iterations) {
+            double total = 0.0;
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::Scoped_Timer<double, std::nano> timer([&total](const Penguin::Scoped_Timer<double, std::nano>& finished) {
+                    total += finished.get_finish_duration().value().count();
+                }, Penguin::Report_Filter::sampled(100));
+            }
+            Penguin::do_not_optimize(total);
+        });
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    Penguin::Benchmark benchmark("Benchmark_Primitives");
+    if (!benchmark.parse_arguments(argc, argv))
+    {
+        return 2;
+    }
+
+    benchmark_semaphore(benchmark);
+    benchmark_monitor(benchmark);
+    benchmark_arena(benchmark);
+    benchmark_epoch_domain(benchmark);
+    benchmark_event_count(benchmark);
+    benchmark_library(benchmark);
+    benchmark_rate_limiter(benchmark);
+    benchmark_unbounded_queue(benchmark);
+    benchmark_timers(benchmark);
+    std::vector<std::string> plugin_summaries;
+    benchmark_plugin_calls(benchmark, plugin_summaries);
+
+    int result = benchmark.report();
+    for (const std::string& summary : plugin_summaries)
+    {
+        std::cout << summary << '\n';
+    }
+    return result;
+}
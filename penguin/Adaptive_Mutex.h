@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_ADAPTIVE_MUTEX_H
+#define PENGUIN_ADAPTIVE_MUTEX_H
+
+
+#include "Futex.h"
+#include "Spin_Wait.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+
+namespace Penguin
+{
+    class Futex_Condition_Variable;
+
+
+    // A mutex that spins briefly before parking on a futex. Uncontended lock and unlock are one atomic
+    // each, and unlock only enters the kernel when somebody is parked. The spin budget follows the
+    // spins that recent acquisitions actually needed, so locks held longer than a spin is worth stop
+    // spinning. Meets the Lockable requirements, pair it with std::condition_variable_any.
+    class Adaptive_Mutex
+    {
+    public:
+        Adaptive_Mutex(void);
+
+        void lock(void);
+        bool try_lock(void);
+        void unlock(void);
+
+    private:
+        Adaptive_Mutex(const Adaptive_Mutex&) = delete;
+        Adaptive_Mutex(Adaptive_Mutex&&) = delete;
+
+    private:
+        Adaptive_Mutex& operator = (const Adaptive_Mutex&) = delete;
+        Adaptive_Mutex& operator = (Adaptive_Mutex&&) = delete;
+
+    private:
+        void lock_contended(void);
+        void lock_parked(void);
+
+    private:
+        // Requeues its waiters straight onto state_
+        friend class Futex_Condition_Variable;
+
+    private:
+        static constexpr std::uint32_t UNLOCKED = 0;
+        static constexpr std::uint32_t LOCKED = 1;
+        static constexpr std::uint32_t CONTENDED = 2;
+        static constexpr std::int32_t MAX_SPINS = 100;
+
+    private:
+        Futex::_word_type           state_;
+        std::atomic<std::int32_t>   spins_;
+    };
+
+
+    inline
+    Adaptive_Mutex::Adaptive_Mutex(void)
+        : state_(UNLOCKED)
+        , spins_(0)
+    {
+    }
+
+
+    inline void
+    Adaptive_Mutex::lock(void)
+    {
+        std::uint32_t expected = UNLOCKED;
+        if (!this->state_.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            this->lock_contended();
+        }
+    }
+
+
+    inline bool
+    Adaptive_Mutex::try_lock(void)
+    {
+        std::uint32_t expected = UNLOCKED;
+        return this->state_.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+
+    inline void
+    Adaptive_Mutex::unlock(void)
+    {
+        if (this->state_.exchange(UNLOCKED, std::memory_order_release) == CONTENDED)
+        {
+            Futex::wake_one(this->state_);
+        }
+    }
+
+
+    inline void
+    Adaptive_Mutex::lock_contended(void)
+    {
+        // Spinning on a single processor only delays the holder
+        static const bool multiprocessor = std::thread::hardware_concurrency() > 1;
+        if (multiprocessor)
+        {
+            // Waiters update the average without coordinating, an approximate budget is good enough
+            std::int32_t spins = this->spins_.load(std::memory_order_relaxed);
+            std::int32_t limit = std::min(MAX_SPINS, spins * 2 + 10);
+            for (std::int32_t count = 0; count < limit; ++count)
+            {
+                cpu_relax();
+                std::uint32_t expected = UNLOCKED;
+                if (this->state_.load(std::memory_order_relaxed) == UNLOCKED
+                    && this->state_.compare_exchange_weak(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    this->spins_.store(spins + (count - spins) / 8, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            this->spins_.store(spins + (limit - spins) / 8, std::memory_order_relaxed);
+        }
+
+        this->lock_parked();
+    }
+
+
+    inline void
+    Adaptive_Mutex::lock_parked(void)
+    {
+        // Mark the lock contended so the holder wakes us, then park until we take it ourselves. Once
+        // marked it stays contended until the last parked waiter has gone, costing at most one extra wake.
+        while (this->state_.exchange(CONTENDED, std::memory_order_acquire) != UNLOCKED)
+        {
+            Futex::wait(this->state_, CONTENDED);
+        }
+    }
+}
+
+
+#endif // PENGUIN_ADAPTIVE_MUTEX_H
@@ -0,0 +1,163 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Arena.h"
+#include <algorithm>
+#include <limits>
+#include <new>
+
+
+namespace Penguin
+{
+    Arena::Arena(std::size_t block_size, std::pmr::memory_resource* upstream)
+        : upstream_(upstream)
+        , next_block_size_(std::max(block_size, 2 * sizeof(Block)))
+        , blocks_(nullptr)
+        , current_(nullptr)
+        , end_(nullptr)
+        , allocated_(0)
+        , capacity_(0)
+        , block_count_(0)
+    {
+    }
+
+
+    Arena::~Arena(void)
+    {
+        this->release();
+    }
+
+
+    std::size_t
+    Arena::get_allocated_bytes(void) const
+    {
+        return this->allocated_;
+    }
+
+
+    std::size_t
+    Arena::get_block_count(void) const
+    {
+        return this->block_count_;
+    }
+
+
+    std::size_t
+    Arena::get_capacity(void) const
+    {
+        return this->capacity_;
+    }
+
+
+    std::pmr::memory_resource*
+    Arena::get_upstream(void) const
+    {
+        return this->upstream_;
+    }
+
+
+    void
+    Arena::reset(void)
+    {
+        Block* largest = this->blocks_;
+        for (Block* block = this->blocks_; block != nullptr; block = block->next)
+        {
+            if (block->size > largest->size)
+            {
+                largest = block;
+            }
+        }
+
+        Block* block = this->blocks_;
+        while (block != nullptr)
+        {
+            Block* next = block->next;
+            if (block != largest)
+            {
+                this->upstream_->deallocate(block, block->size, alignof(Block));
+            }
+            block = next;
+        }
+
+        this->blocks_ = nullptr;
+        this->current_ = nullptr;
+        this->end_ = nullptr;
+        this->allocated_ = 0;
+        this->capacity_ = 0;
+        this->block_count_ = 0;
+        if (largest != nullptr)
+        {
+            largest->next = nullptr;
+            this->use_block(largest);
+        }
+    }
+
+
+    void
+    Arena::release(void)
+    {
+        this->reset();
+        if (this->blocks_ != nullptr)
+        {
+            this->upstream_->deallocate(this->blocks_, this->blocks_->size, alignof(Block));
+        }
+        this->blocks_ = nullptr;
+        this->current_ = nullptr;
+        this->end_ = nullptr;
+        this->capacity_ = 0;
+        this->block_count_ = 0;
+    }
+
+
+    void
+    Arena::do_deallocate(void*, std::size_t, std::size_t)
+    {
+        // Everything goes at once, in reset() or release()
+    }
+
+
+    bool
+    Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        return (this == &other);
+    }
+
+
+    void*
+    Arena::allocate_block(std::size_t bytes, std::size_t alignment)
+    {
+        // Room for the header and the worst case padding. What is left of the current block is abandoned.
+        if (bytes > std::numeric_limits<std::size_t>::max() - sizeof(Block) - alignment)
+        {
+            throw std::bad_alloc();
+        }
+        std::size_t needed = sizeof(Block) + alignment - 1 + bytes;
+        std::size_t size = this->next_block_size_;
+        if (needed > size)
+        {
+            // Oversized requests get a block of their own and leave the growth alone
+            size = needed;
+        }
+        else
+        {
+            this->next_block_size_ *= 2;
+        }
+
+        Block* block = static_cast<Block*>(this->upstream_->allocate(size, alignof(Block)));
+        block->next = this->blocks_;
+        block->size = size;
+        this->use_block(block);
+        return this->do_allocate(bytes, alignment);
+    }
+
+
+    void
+    Arena::use_block(Block* block)
+    {
+        this->blocks_ = block;
+        this->current_ = reinterpret_cast<char*>(block + 1);
+        this->end_ = reinterpret_cast<char*>(block) + block->size;
+        this->capacity_ += block->size;
+        ++this->block_count_;
+    }
+}
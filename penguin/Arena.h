@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_ARENA_H
+#define PENGUIN_ARENA_H
+
+
+#include "Penguin_export.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+
+namespace Penguin
+{
+    // A monotonic memory resource for allocations that die together, such as everything one request
+    // makes. Allocating bumps a pointer through the current block, deallocating does nothing, and
+    // blocks are chained and taken from upstream twice as large each time. reset() rewinds the arena
+    // for the next request but, unlike std::pmr::monotonic_buffer_resource::release(), keeps its
+    // largest block, so a steady stream of similar requests stops touching upstream at all. Pass it
+    // wherever a std::pmr allocator is taken. Not thread safe.
+    class Penguin_Export Arena : public std::pmr::memory_resource
+    {
+    public:
+        explicit Arena(std::size_t block_size = 4096, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+        ~Arena(void) override;
+
+        // Handed out since the last reset, alignment padding included
+        std::size_t                 get_allocated_bytes(void) const;
+        std::size_t                 get_block_count(void) const;
+
+        // Taken from upstream and still held
+        std::size_t                 get_capacity(void) const;
+        std::pmr::memory_resource*  get_upstream(void) const;
+
+        // Frees every block but the largest and starts again at its beginning. Nothing allocated from the
+        // arena may be used afterwards.
+        void                        reset(void);
+
+        // Frees every block
+        void                        release(void);
+
+    protected:
+        void*   do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void    do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+        bool    do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        Arena(const Arena&) = delete;
+        Arena(Arena&&) = delete;
+
+    private:
+        Arena& operator = (const Arena&) = delete;
+        Arena& operator = (Arena&&) = delete;
+
+    private:
+        // Starts every block, the newest first
+        struct alignas(alignof(std::max_align_t)) Block
+        {
+            Block*      next;
+            std::size_t size;
+        };
+
+    private:
+        void*   allocate_block(std::size_t bytes, std::size_t alignment);
+        void    use_block(Block* block);
+
+    private:
+        std::pmr::memory_resource*  upstream_;
+        std::size_t                 next_block_size_;
+        Block*                      blocks_;
+        char*                       current_;
+        char*                       end_;
+        std::size_t                 allocated_;
+        std::size_t                 capacity_;
+        std::size_t                 block_count_;
+    };
+
+
+    inline void*
+    Arena::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        // Zero bytes still gets a distinct address
+        bytes += (bytes == 0);
+        std::size_t padding = (0 - reinterpret_cast<std::uintptr_t>(this->current_)) & (alignment - 1);
+        std::size_t remaining = static_cast<std::size_t>(this->end_ - this->current_);
+
+        // Compared without adding them, a huge request must not wrap around and pass
+        if (padding <= remaining && bytes <= remaining - padding)
+        {
+            void* pointer = this->current_ + padding;
+            this->current_ += padding + bytes;
+            this->allocated_ += padding + bytes;
+            return pointer;
+        }
+        return this->allocate_block(bytes, alignment);
+    }
+}
+
+
+#endif // PENGUIN_ARENA_H
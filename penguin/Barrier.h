@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_BARRIER_H
+#define PENGUIN_BARRIER_H
+
+
+#include "Futex.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+
+namespace Penguin
+{
+    // A reusable barrier for a fixed group of threads working in phases. Arriving is one atomic
+    // subtraction. The last thread to arrive runs the completion function, if any, and then opens the
+    // next phase; everybody else spins briefly and then sleeps on the phase number. The phase word's
+    // low bit records that somebody is asleep, so phases nobody slept through cost no wake call.
+    class Barrier
+    {
+    public:
+        using _phase_type = std::uint32_t;
+        using _completion_type = std::function<void(void)>;
+
+    public:
+        explicit Barrier(std::uint32_t participants);
+        Barrier(std::uint32_t participants, _completion_type completion);
+
+        // Returns the phase arrived at, for a later wait
+        _phase_type arrive(void);
+        void        wait(_phase_type phase);
+        void        arrive_and_wait(void);
+
+        // Arrives and leaves the group for every later phase
+        void        arrive_and_drop(void);
+
+    private:
+        Barrier(const Barrier&) = delete;
+        Barrier(Barrier&&) = delete;
+
+    private:
+        Barrier& operator = (const Barrier&) = delete;
+        Barrier& operator = (Barrier&&) = delete;
+
+    private:
+        static constexpr std::uint32_t SLEEPERS = 1;
+        static constexpr std::uint32_t PHASE_STEP = 2;
+
+    private:
+        std::atomic<std::uint32_t>  remaining_;
+        std::atomic<std::uint32_t>  participants_;
+        _completion_type            completion_;
+
+        // Waiters poll it, keep it off the line every arrival writes
+        alignas(64) Futex::_word_type phase_;
+    };
+
+
+    inline
+    Barrier::Barrier(std::uint32_t participants)
+        : Barrier(participants, nullptr)
+    {
+    }
+
+
+    inline
+    Barrier::Barrier(std::uint32_t participants, _completion_type completion)
+        : remaining_(participants)
+        , participants_(participants)
+        , completion_(completion)
+        , phase_(0)
+    {
+    }
+
+
+    inline Barrier::_phase_type
+    Barrier::arrive(void)
+    {
+        // The phase cannot move on before this thread arrives, so it is still the one being arrived at
+        _phase_type phase = this->phase_.load(std::memory_order_acquire) & ~SLEEPERS;
+        if (this->remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            // Every arrival happened before this point, including drops
+            this->remaining_.store(this->participants_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            if (this->completion_)
+            {
+                this->completion_();
+            }
+            if (this->phase_.exchange(phase + PHASE_STEP, std::memory_order_release) & SLEEPERS)
+            {
+                Futex::wake_all(this->phase_);
+            }
+        }
+        return phase;
+    }
+
+
+    inline void
+    Barrier::wait(_phase_type phase)
+    {
+        Spin_Wait spin_wait;
+        std::uint32_t word = this->phase_.load(std::memory_order_acquire);
+        while ((word & ~SLEEPERS) == phase)
+        {
+            if (!spin_wait.will_yield())
+            {
+                spin_wait.wait();
+            }
+            else if ((word & SLEEPERS) || this->phase_.compare_exchange_weak(word, word | SLEEPERS, std::memory_order_acquire))
+            {
+                Futex::wait(this->phase_, phase | SLEEPERS);
+            }
+            word = this->phase_.load(std::memory_order_acquire);
+        }
+    }
+
+
+    inline void
+    Barrier::arrive_and_wait(void)
+    {
+        this->wait(this->arrive());
+    }
+
+
+    inline void
+    Barrier::arrive_and_drop(void)
+    {
+        this->participants_.fetch_sub(1, std::memory_order_relaxed);
+        this->arrive();
+    }
+}
+
+
+#endif // PENGUIN_BARRIER_H
@@ -0,0 +1,485 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Benchmark.h"
+#include "Running_Statistics.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+
+namespace
+{
+    using Sample_Timer = Penguin::Timer<double, std::nano, Penguin::Plain_Finish_Flag>;
+
+
+    double run_threads(std::size_t threads, std::size_t iterations, const Penguin::Benchmark::_threaded_body_type& body)
+    {
+        std::atomic<bool> go(false);
+        std::atomic<std::size_t> ready(0);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (std::size_t thread_index = 0; thread_index < threads; ++thread_index)
+        {
+            workers.emplace_back([&, thread_index] {
+                ready.fetch_add(1);
+                while (go.load(std::memory_order_acquire) == false)
+                {
+                    std::this_thread::yield();
+                }
+                body(thread_index, iterations);
+            });
+        }
+
+        // Only time the work itself, not the thread creation
+        while (ready.load() != threads)
+        {
+            std::this_thread::yield();
+        }
+        Sample_Timer timer;
+        timer.start();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        timer.stop();
+        return timer.get_finish_duration();
+    }
+
+
+    void write_json_string(std::ostream& stream, const std::string& value)
+    {
+        stream << '"';
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                stream << '\\';
+            }
+            stream << c;
+        }
+        stream << '"';
+    }
+
+
+    bool read_string_field(const std::string& line, const std::string& key, std::string& value)
+    {
+        std::string pattern = "\"" + key + "\": \"";
+        std::size_t position = line.find(pattern);
+        if (position == std::string::npos)
+        {
+            return false;
+        }
+
+        value.clear();
+        for (position += pattern.size(); position < line.size() && line[position] != '"'; ++position)
+        {
+            if (line[position] == '\\' && position + 1 < line.size())
+            {
+                ++position;
+            }
+            value.push_back(line[position]);
+        }
+        return true;
+    }
+
+
+    bool read_number_field(const std::string& line, const std::string& key, double& value)
+    {
+        std::string pattern = "\"" + key + "\": ";
+        std::size_t position = line.find(pattern);
+        if (position == std::string::npos)
+        {
+            return false;
+        }
+        value = std::strtod(line.c_str() + position + pattern.size(), nullptr);
+        return true;
+    }
+}
+
+
+namespace Penguin
+{
+    namespace Benchmark_Detail
+    {
+        void use_character_pointer(const volatile char*)
+        {
+        }
+    }
+
+
+    Benchmark::Benchmark(std::string suite_name)
+        : Benchmark(std::move(suite_name), Options())
+    {
+    }
+
+
+    Benchmark::Benchmark(std::string suite_name, Options options)
+        : suite_name_(std::move(suite_name))
+        , options_(std::move(options))
+        , tolerance_(0.1)
+    {
+    }
+
+
+    Benchmark::~Benchmark(void)
+    {
+    }
+
+
+    bool
+    Benchmark::parse_arguments(int argc, char* argv[])
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string argument(argv[i]);
+            bool has_value = (i + 1 < argc);
+            if (argument == "--quick")
+            {
+                this->options_.warm_up_time = std::chrono::milliseconds(10);
+                this->options_.sample_time = std::chrono::milliseconds(5);
+                this->options_.samples = 5;
+            }
+            else if (argument == "--json" && has_value)
+            {
+                this->json_path_ = argv[++i];
+            }
+            else if (argument == "--baseline" && has_value)
+            {
+                this->baseline_path_ = argv[++i];
+            }
+            else if (argument == "--tolerance" && has_value)
+            {
+                this->tolerance_ = std::strtod(argv[++i], nullptr);
+            }
+            else if (argument == "--filter" && has_value)
+            {
+                this->options_.filter = argv[++i];
+            }
+            else if (argument == "--threads" && has_value)
+            {
+                this->options_.max_threads = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else
+            {
+                std::cerr << "Usage: " << argv[0] << " [--quick] [--json <file>] [--baseline <file>] [--tolerance <fraction>] [--filter <text>] [--threads <count>]\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    void
+    Benchmark::run(const std::string& name, _body_type body, std::size_t items_per_iteration)
+    {
+        this->measure(name, 1, items_per_iteration, [&body](std::size_t iterations) {
+            Sample_Timer timer;
+            timer.start();
+            body(iterations);
+            timer.stop();
+            return timer.get_finish_duration();
+        });
+    }
+
+
+    void
+    Benchmark::run_threaded(const std::string& name, std::size_t threads, _threaded_body_type body, std::size_t items_per_iteration)
+    {
+        this->measure(name, threads, items_per_iteration, [threads, &body](std::size_t iterations) {
+            return run_threads(threads, iterations, body);
+        });
+    }
+
+
+    void
+    Benchmark::run_threaded(const std::string& name, std::size_t threads, Fixture& fixture, std::size_t items_per_iteration)
+    {
+        this->measure(name, threads, items_per_iteration, [threads, &fixture](std::size_t iterations) {
+            fixture.set_up(threads);
+            double elapsed = run_threads(threads, iterations, [&fixture](std::size_t thread_index, std::size_t iterations) {
+                fixture.run(thread_index, iterations);
+            });
+            fixture.tear_down();
+            return elapsed;
+        });
+    }
+
+
+    const Benchmark::Options&
+    Benchmark::get_options(void) const
+    {
+        return this->options_;
+    }
+
+
+    const std::vector<Benchmark::Result>&
+    Benchmark::get_results(void) const
+    {
+        return this->results_;
+    }
+
+
+    const std::string&
+    Benchmark::get_suite_name(void) const
+    {
+        return this->suite_name_;
+    }
+
+
+    std::vector<std::size_t>
+    Benchmark::get_thread_counts(std::size_t minimum) const
+    {
+        std::size_t limit = this->options_.max_threads;
+        if (limit == 0)
+        {
+            limit = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        limit = std::max(limit, minimum);
+
+        std::vector<std::size_t> thread_counts;
+        for (std::size_t threads = 1; threads < limit; threads *= 2)
+        {
+            if (threads >= minimum)
+            {
+                thread_counts.push_back(threads);
+            }
+        }
+        thread_counts.push_back(limit);
+        return thread_counts;
+    }
+
+
+    std::vector<Benchmark::Comparison>
+    Benchmark::compare(const std::vector<Result>& baseline, double tolerance) const
+    {
+        std::vector<Comparison> comparisons;
+        for (const auto& result : this->results_)
+        {
+            auto previous = std::find_if(baseline.begin(), baseline.end(), [&result](const Result& candidate) {
+                return candidate.name == result.name && candidate.threads == result.threads;
+            });
+            if (previous == baseline.end())
+            {
+                continue;
+            }
+
+            Comparison comparison;
+            comparison.name = result.name;
+            comparison.threads = result.threads;
+            comparison.baseline_ns = previous->median_ns;
+            comparison.current_ns = result.median_ns;
+            comparison.regressed = (result.median_ns > previous->median_ns * (1.0 + tolerance));
+            comparisons.push_back(comparison);
+        }
+        return comparisons;
+    }
+
+
+    void
+    Benchmark::print(std::ostream& stream) const
+    {
+        std::ios_base::fmtflags flags = stream.flags();
+        stream << this->suite_name_ << '\n';
+        stream << std::left << std::setw(48) << "Benchmark" << std::right
+            << std::setw(8) << "Threads"
+            << std::setw(12) << "Iterations"
+            << std::setw(14) << "Mean(ns)"
+            << std::setw(14) << "Median(ns)"
+            << std::setw(14) << "Stddev(ns)"
+            << std::setw(14) << "Min(ns)"
+            << std::setw(14) << "Max(ns)"
+            << std::setw(16) << "Items/s"
+            << '\n';
+        stream << std::fixed << std::setprecision(2);
+        for (const auto& result : this->results_)
+        {
+            stream << std::left << std::setw(48) << result.name << std::right
+                << std::setw(8) << result.threads
+                << std::setw(12) << result.iterations
+                << std::setw(14) << result.mean_ns
+                << std::setw(14) << result.median_ns
+                << std::setw(14) << result.stddev_ns
+                << std::setw(14) << result.min_ns
+                << std::setw(14) << result.max_ns
+                << std::setw(16) << std::setprecision(0) << result.items_per_second << std::setprecision(2)
+                << '\n';
+        }
+        stream.flags(flags);
+    }
+
+
+    void
+    Benchmark::write_json(std::ostream& stream) const
+    {
+        // One result per line keeps the output diffable and lets read_json stay trivial
+        stream << "{\n  \"suite\": ";
+        write_json_string(stream, this->suite_name_);
+        stream << ",\n  \"results\": [\n";
+        for (std::size_t i = 0; i < this->results_.size(); ++i)
+        {
+            const Result& result = this->results_[i];
+            stream << "    {\"name\": ";
+            write_json_string(stream, result.name);
+            stream << ", \"threads\": " << result.threads
+                << ", \"iterations\": " << result.iterations
+                << ", \"samples\": " << result.samples
+                << ", \"mean_ns\": " << result.mean_ns
+                << ", \"median_ns\": " << result.median_ns
+                << ", \"stddev_ns\": " << result.stddev_ns
+                << ", \"min_ns\": " << result.min_ns
+                << ", \"max_ns\": " << result.max_ns
+                << ", \"items_per_second\": " << result.items_per_second
+                << "}" << (i + 1 < this->results_.size() ? "," : "") << '\n';
+        }
+        stream << "  ]\n}\n";
+    }
+
+
+    bool
+    Benchmark::write_json(const std::filesystem::path& json_path) const
+    {
+        std::ofstream stream(json_path);
+        if (!stream)
+        {
+            return false;
+        }
+        this->write_json(stream);
+        return static_cast<bool>(stream);
+    }
+
+
+    int
+    Benchmark::report(void) const
+    {
+        this->print(std::cout);
+
+        int exit_code = 0;
+        if (!this->json_path_.empty() && !this->write_json(this->json_path_))
+        {
+            std::cerr << "ERROR! Failed to write " << this->json_path_.string() << '\n';
+            exit_code = 1;
+        }
+
+        if (!this->baseline_path_.empty())
+        {
+            std::vector<Result> baseline = read_json(this->baseline_path_);
+            for (const auto& comparison : this->compare(baseline, this->tolerance_))
+            {
+                double change = (comparison.baseline_ns > 0.0 ? comparison.current_ns / comparison.baseline_ns - 1.0 : 0.0);
+                std::cout << "[" << (comparison.regressed ? "SLOW" : " OK ") << "] " << comparison.name
+                    << " (" << comparison.threads << " threads) " << std::showpos << std::fixed << std::setprecision(1)
+                    << change * 100.0 << std::noshowpos << "%\n";
+                if (comparison.regressed)
+                {
+                    exit_code = 1;
+                }
+            }
+        }
+        return exit_code;
+    }
+
+
+    std::vector<Benchmark::Result>
+    Benchmark::read_json(const std::filesystem::path& json_path)
+    {
+        std::vector<Result> results;
+        std::ifstream stream(json_path);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            Result result;
+            double threads = 0.0;
+            double iterations = 0.0;
+            double samples = 0.0;
+            if (read_string_field(line, "name", result.name)
+                && read_number_field(line, "threads", threads)
+                && read_number_field(line, "iterations", iterations)
+                && read_number_field(line, "samples", samples)
+                && read_number_field(line, "mean_ns", result.mean_ns)
+                && read_number_field(line, "median_ns", result.median_ns)
+                && read_number_field(line, "stddev_ns", result.stddev_ns)
+                && read_number_field(line, "min_ns", result.min_ns)
+                && read_number_field(line, "max_ns", result.max_ns))
+            {
+                result.threads = static_cast<std::size_t>(threads);
+                result.iterations = static_cast<std::size_t>(iterations);
+                result.samples = static_cast<std::size_t>(samples);
+                read_number_field(line, "items_per_second", result.items_per_second);
+                results.push_back(result);
+            }
+        }
+        return results;
+    }
+
+
+    void
+    Benchmark::measure(const std::string& name, std::size_t threads, std::size_t items_per_iteration, const std::function<double(std::size_t)>& run_sample)
+    {
+        if (!this->options_.filter.empty() && name.find(this->options_.filter) == std::string::npos)
+        {
+            return;
+        }
+
+        Sample_Timer warm_up_timer;
+        warm_up_timer.start();
+
+        // Grow the iteration count until a single sample takes about the requested sample time
+        double target_ns = std::chrono::duration<double, std::nano>(this->options_.sample_time).count();
+        std::size_t iterations = 1;
+        for (;;)
+        {
+            double elapsed_ns = run_sample(iterations);
+            if (elapsed_ns >= target_ns || iterations >= this->options_.max_iterations)
+            {
+                break;
+            }
+            double scale = (elapsed_ns > 0.0 ? 1.4 * target_ns / elapsed_ns : 10.0);
+            scale = std::min(std::max(scale, 2.0), 10.0);
+            iterations = std::min(this->options_.max_iterations, static_cast<std::size_t>(static_cast<double>(iterations) * scale));
+        }
+
+        double warm_up_ns = std::chrono::duration<double, std::nano>(this->options_.warm_up_time).count();
+        while (warm_up_timer.get_current_duration() < warm_up_ns)
+        {
+            run_sample(iterations);
+        }
+
+        Running_Statistics statistics;
+        std::vector<double> samples;
+        samples.reserve(this->options_.samples);
+        for (std::size_t sample = 0; sample < this->options_.samples; ++sample)
+        {
+            double per_iteration_ns = run_sample(iterations) / static_cast<double>(iterations);
+            statistics.add(per_iteration_ns);
+            samples.push_back(per_iteration_ns);
+        }
+
+        Result result;
+        result.name = name;
+        result.threads = threads;
+        result.iterations = iterations;
+        result.samples = samples.size();
+        if (!samples.empty())
+        {
+            std::sort(samples.begin(), samples.end());
+            std::size_t middle = samples.size() / 2;
+            result.median_ns = (samples.size() % 2 == 1 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2.0);
+        }
+        result.mean_ns = statistics.mean();
+        result.stddev_ns = statistics.standard_deviation();
+        result.min_ns = statistics.min();
+        result.max_ns = statistics.max();
+        if (result.median_ns > 0.0)
+        {
+            result.items_per_second = static_cast<double>(items_per_iteration) * 1e9 / result.median_ns;
+        }
+        this->results_.push_back(result);
+    }
+}
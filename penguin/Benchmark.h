@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_BENCHMARK_H
+#define PENGUIN_BENCHMARK_H
+
+
+#include "Penguin_export.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+namespace Penguin
+{
+    namespace Benchmark_Detail
+    {
+        Penguin_Export void use_character_pointer(const volatile char* pointer);
+    }
+
+
+    // Forces the compiler to materialise value, so the computation producing it is not elided
+    template <class T>
+    inline void do_not_optimize(const T& value)
+    {
+#if defined(__GNUG__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        Benchmark_Detail::use_character_pointer(&reinterpret_cast<const volatile char&>(value));
+#endif
+    }
+
+
+    // Forces pending writes to memory to be treated as observable
+    inline void clobber_memory(void)
+    {
+#if defined(__GNUG__)
+        asm volatile("" : : : "memory");
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+
+    class Penguin_Export Benchmark
+    {
+    public:
+        using _body_type            = std::function<void(std::size_t iterations)>;
+        using _threaded_body_type   = std::function<void(std::size_t thread_index, std::size_t iterations)>;
+
+        struct Options
+        {
+            std::chrono::milliseconds   warm_up_time = std::chrono::milliseconds(100);
+            std::chrono::milliseconds   sample_time = std::chrono::milliseconds(20);
+            std::size_t                 samples = 15;
+            std::size_t                 max_iterations = std::size_t(1) << 30;
+            std::size_t                 max_threads = 0;
+            std::string                 filter;
+        };
+
+        // Times are wall clock nanoseconds per iteration, every thread runs the given iterations
+        struct Result
+        {
+            std::string     name;
+            std::size_t     threads = 1;
+            std::size_t     iterations = 0;
+            std::size_t     samples = 0;
+            double          mean_ns = 0.0;
+            double          median_ns = 0.0;
+            double          stddev_ns = 0.0;
+            double          min_ns = 0.0;
+            double          max_ns = 0.0;
+            double          items_per_second = 0.0;
+        };
+
+        struct Comparison
+        {
+            std::string     name;
+            std::size_t     threads = 1;
+            double          baseline_ns = 0.0;
+            double          current_ns = 0.0;
+            bool            regressed = false;
+        };
+
+        // State shared by the threads of a multi-threaded benchmark, set up again for every sample
+        class Fixture
+        {
+        public:
+            virtual ~Fixture(void) {}
+
+            virtual void set_up(std::size_t) {}
+            virtual void run(std::size_t thread_index, std::size_t iterations) = 0;
+            virtual void tear_down(void) {}
+        };
+
+    public:
+        explicit Benchmark(std::string suite_name);
+        Benchmark(std::string suite_name, Options options);
+        virtual ~Benchmark(void);
+
+    public:
+        // Understands --json <file>, --baseline <file>, --tolerance <fraction>, --filter <text>, --threads <count> and --quick
+        bool parse_arguments(int argc, char* argv[]);
+
+        // Items are the units of work done by one iteration across all threads, used for the throughput
+        void run(const std::string& name, _body_type body, std::size_t items_per_iteration = 1);
+        void run_threaded(const std::string& name, std::size_t threads, _threaded_body_type body, std::size_t items_per_iteration = 1);
+        void run_threaded(const std::string& name, std::size_t threads, Fixture& fixture, std::size_t items_per_iteration = 1);
+
+        const Options&              get_options(void) const;
+        const std::vector<Result>&  get_results(void) const;
+        const std::string&          get_suite_name(void) const;
+
+        // Powers of two from minimum up to the thread limit (the core count unless given), and the limit itself
+        std::vector<std::size_t>    get_thread_counts(std::size_t minimum = 1) const;
+
+        std::vector<Comparison>     compare(const std::vector<Result>& baseline, double tolerance) const;
+        void                        print(std::ostream& stream) const;
+        void                        write_json(std::ostream& stream) const;
+        bool                        write_json(const std::filesystem::path& json_path) const;
+
+        // Prints the results, writes and compares JSON as requested on the command line, returns the exit code
+        int report(void) const;
+
+        static std::vector<Result>  read_json(const std::filesystem::path& json_path);
+
+    private:
+        Benchmark(const Benchmark& other) = delete;
+        Benchmark& operator = (const Benchmark& other) = delete;
+
+        Benchmark(Benchmark&& other) = delete;
+        Benchmark& operator = (Benchmark&& other) = delete;
+
+    private:
+        void measure(const std::string& name, std::size_t threads, std::size_t items_per_iteration, const std::function<double(std::size_t)>& run_sample);
+
+    private:
+        std::string             suite_name_;
+        Options                 options_;
+        std::vector<Result>     results_;
+        std::filesystem::path   json_path_;
+        std::filesystem::path   baseline_path_;
+        double                  tolerance_;
+    };
+}
+
+
+#endif // PENGUIN_BENCHMARK_H
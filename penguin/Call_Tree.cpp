@@ -0,0 +1,392 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Call_Tree.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+
+namespace
+{
+    struct Thread_Node
+    {
+        Thread_Node(const char* scope_name, Thread_Node* parent_node)
+            : name(scope_name)
+            , parent(parent_node)
+            , calls(0)
+            , inclusive_ns(0)
+            , min_ns(std::numeric_limits<std::uint64_t>::max())
+            , max_ns(0)
+        {
+        }
+
+        const char*                                 name;
+        Thread_Node*                                parent;
+
+        // Only the owning thread writes these, readers merging the tree load them relaxed
+        std::atomic<std::uint64_t>                  calls;
+        std::atomic<std::uint64_t>                  inclusive_ns;
+        std::atomic<std::uint64_t>                  min_ns;
+        std::atomic<std::uint64_t>                  max_ns;
+
+        // Guarded by the owning Thread_Tree mutex when changed or read by another thread
+        std::vector<std::unique_ptr<Thread_Node>>   children;
+    };
+
+
+    struct Thread_Tree
+    {
+        Thread_Tree(void)
+            : root("", nullptr)
+            , current(&root)
+        {
+        }
+
+        std::mutex      mutex;
+        Thread_Node     root;
+        Thread_Node*    current;
+    };
+
+
+    struct Tree_Registry
+    {
+        std::mutex                                  mutex;
+        std::vector<std::shared_ptr<Thread_Tree>>   trees;
+
+        // What finished threads recorded, folded in so their trees can be freed
+        Penguin::Call_Tree::Node                    retired;
+    };
+
+
+    Tree_Registry& get_registry(void)
+    {
+        static Tree_Registry registry;
+        return registry;
+    }
+
+
+    Thread_Node* find_child(Thread_Node* node, const char* scope_name)
+    {
+        for (auto& child : node->children)
+        {
+            if (child->name == scope_name || std::strcmp(child->name, scope_name) == 0)
+            {
+                return child.get();
+            }
+        }
+        return nullptr;
+    }
+
+
+    Penguin::Call_Tree::Node& find_or_add(Penguin::Call_Tree::Node& node, const char* scope_name)
+    {
+        for (auto& child : node.children)
+        {
+            if (child.name == scope_name)
+            {
+                return child;
+            }
+        }
+        node.children.emplace_back();
+        node.children.back().name = scope_name;
+        return node.children.back();
+    }
+
+
+    void merge_node(Penguin::Call_Tree::Node& target, const Thread_Node& source)
+    {
+        std::uint64_t calls = source.calls.load(std::memory_order_relaxed);
+        if (calls != 0)
+        {
+            std::chrono::nanoseconds min_time(source.min_ns.load(std::memory_order_relaxed));
+            std::chrono::nanoseconds max_time(source.max_ns.load(std::memory_order_relaxed));
+            target.min_time = (target.calls == 0 ? min_time : std::min(target.min_time, min_time));
+            target.max_time = std::max(target.max_time, max_time);
+            target.calls += calls;
+            target.inclusive_time += std::chrono::nanoseconds(source.inclusive_ns.load(std::memory_order_relaxed));
+        }
+
+        for (const auto& child : source.children)
+        {
+            merge_node(find_or_add(target, child->name), *child);
+        }
+    }
+
+
+    // Called with the registry locked. Only the registry still owns the tree of a thread that has
+    // exited, as the thread's own pointer is destroyed with its other thread_local objects.
+    void retire_finished_trees(Tree_Registry& registry)
+    {
+        auto finished = std::remove_if(
+            registry.trees.begin(),
+            registry.trees.end(),
+            [&registry](const std::shared_ptr<Thread_Tree>& tree) {
+                if (tree.use_count() != 1)
+                {
+                    return false;
+                }
+                std::lock_guard<std::mutex> tree_guard(tree->mutex);
+                merge_node(registry.retired, tree->root);
+                return true;
+            });
+        registry.trees.erase(finished, registry.trees.end());
+    }
+
+
+    Thread_Tree& get_thread_tree(void)
+    {
+        // The registry shares ownership so the tree of a finished thread can still be reported, until the
+        // next registration, merge or reset folds it into the retired tree
+        thread_local std::shared_ptr<Thread_Tree> thread_tree;
+        if (!thread_tree)
+        {
+            thread_tree = std::make_shared<Thread_Tree>();
+            Tree_Registry& registry = get_registry();
+            std::lock_guard<std::mutex> registry_guard(registry.mutex);
+            retire_finished_trees(registry);
+            registry.trees.push_back(thread_tree);
+        }
+        return *thread_tree;
+    }
+
+
+    void finalise_node(Penguin::Call_Tree::Node& node)
+    {
+        std::chrono::nanoseconds children_time(0);
+        for (auto& child : node.children)
+        {
+            finalise_node(child);
+            children_time += child.inclusive_time;
+        }
+
+        // A scope still open while merging has no inclusive time yet, but its children might
+        node.exclusive_time = std::max(node.inclusive_time - children_time, std::chrono::nanoseconds::zero());
+
+        std::sort(
+            node.children.begin(),
+            node.children.end(),
+            [](const Penguin::Call_Tree::Node& a, const Penguin::Call_Tree::Node& b) {return a.inclusive_time > b.inclusive_time; });
+    }
+
+
+    void reset_node(Thread_Node& node)
+    {
+        node.calls.store(0, std::memory_order_relaxed);
+        node.inclusive_ns.store(0, std::memory_order_relaxed);
+        node.min_ns.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+        node.max_ns.store(0, std::memory_order_relaxed);
+        for (auto& child : node.children)
+        {
+            reset_node(*child);
+        }
+    }
+
+
+    double to_microseconds(std::chrono::nanoseconds duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+
+    void write_text(std::ostream& stream, const Penguin::Call_Tree::Node& node, size_t depth)
+    {
+        std::string label(depth * 2, ' ');
+        label.append(node.name);
+        stream << std::left << std::setw(40) << label << std::right
+            << std::setw(12) << node.calls
+            << std::setw(16) << to_microseconds(node.inclusive_time)
+            << std::setw(16) << to_microseconds(node.exclusive_time)
+            << std::setw(12) << to_microseconds(node.min_time)
+            << std::setw(12) << to_microseconds(node.max_time)
+            << '\n';
+
+        for (const auto& child : node.children)
+        {
+            write_text(stream, child, depth + 1);
+        }
+    }
+
+
+    void write_json_string(std::ostream& stream, const std::string& value)
+    {
+        stream << '"';
+        for (char c : value)
+        {
+            switch (c)
+            {
+            case '"':  stream << "\\\""; break;
+            case '\\': stream << "\\\\"; break;
+            case '\n': stream << "\\n"; break;
+            case '\t': stream << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+                }
+                else
+                {
+                    stream << c;
+                }
+            }
+        }
+        stream << '"';
+    }
+
+
+    void write_json(std::ostream& stream, const Penguin::Call_Tree::Node& node)
+    {
+        stream << "{\"name\":";
+        write_json_string(stream, node.name);
+        stream << ",\"calls\":" << node.calls
+            << ",\"inclusive_ns\":" << node.inclusive_time.count()
+            << ",\"exclusive_ns\":" << node.exclusive_time.count()
+            << ",\"min_ns\":" << node.min_time.count()
+            << ",\"max_ns\":" << node.max_time.count()
+            << ",\"children\":[";
+        for (size_t i = 0; i < node.children.size(); ++i)
+        {
+            if (i != 0)
+            {
+                stream << ',';
+            }
+            write_json(stream, node.children[i]);
+        }
+        stream << "]}";
+    }
+}
+
+
+namespace Penguin
+{
+    void
+    Call_Tree::enter(const char* scope_name)
+    {
+        Thread_Tree& tree = get_thread_tree();
+        Thread_Node* child = find_child(tree.current, scope_name);
+        if (child == nullptr)
+        {
+            std::lock_guard<std::mutex> tree_guard(tree.mutex);
+            tree.current->children.push_back(std::make_unique<Thread_Node>(scope_name, tree.current));
+            child = tree.current->children.back().get();
+        }
+        tree.current = child;
+    }
+
+
+    void
+    Call_Tree::leave(_duration_type duration)
+    {
+        Thread_Tree& tree = get_thread_tree();
+        Thread_Node* node = tree.current;
+        if (node->parent == nullptr)
+        {
+            // Unbalanced leave, there is no open scope on this thread
+            return;
+        }
+
+        std::uint64_t duration_ns = static_cast<std::uint64_t>(std::max(duration.count(), _duration_type::rep(0)));
+        node->calls.store(node->calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        node->inclusive_ns.store(node->inclusive_ns.load(std::memory_order_relaxed) + duration_ns, std::memory_order_relaxed);
+        if (duration_ns < node->min_ns.load(std::memory_order_relaxed))
+        {
+            node->min_ns.store(duration_ns, std::memory_order_relaxed);
+        }
+        if (duration_ns > node->max_ns.load(std::memory_order_relaxed))
+        {
+            node->max_ns.store(duration_ns, std::memory_order_relaxed);
+        }
+        tree.current = node->parent;
+    }
+
+
+    Call_Tree::Node
+    Call_Tree::merge(void)
+    {
+        Node root;
+        std::vector<std::shared_ptr<Thread_Tree>> trees;
+        {
+            Tree_Registry& registry = get_registry();
+            std::lock_guard<std::mutex> registry_guard(registry.mutex);
+            retire_finished_trees(registry);
+            root = registry.retired;
+            trees = registry.trees;
+        }
+
+        for (auto& tree : trees)
+        {
+            std::lock_guard<std::mutex> tree_guard(tree->mutex);
+            merge_node(root, tree->root);
+        }
+        finalise_node(root);
+        root.inclusive_time = root.exclusive_time = _duration_type::zero();
+        for (const auto& child : root.children)
+        {
+            root.inclusive_time += child.inclusive_time;
+        }
+        return root;
+    }
+
+
+    void
+    Call_Tree::reset(void)
+    {
+        Tree_Registry& registry = get_registry();
+        std::lock_guard<std::mutex> registry_guard(registry.mutex);
+        retire_finished_trees(registry);
+        registry.retired = Node();
+        for (auto& tree : registry.trees)
+        {
+            std::lock_guard<std::mutex> tree_guard(tree->mutex);
+            reset_node(tree->root);
+        }
+    }
+
+
+    std::string
+    Call_Tree::report_text(void)
+    {
+        return report_text(merge());
+    }
+
+
+    std::string
+    Call_Tree::report_text(const Node& root)
+    {
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(3);
+        stream << std::left << std::setw(40) << "Scope" << std::right
+            << std::setw(12) << "Calls"
+            << std::setw(16) << "Inclusive(us)"
+            << std::setw(16) << "Exclusive(us)"
+            << std::setw(12) << "Min(us)"
+            << std::setw(12) << "Max(us)"
+            << '\n';
+        for (const auto& child : root.children)
+        {
+            write_text(stream, child, 0);
+        }
+        return stream.str();
+    }
+
+
+    std::string
+    Call_Tree::report_json(void)
+    {
+        return report_json(merge());
+    }
+
+
+    std::string
+    Call_Tree::report_json(const Node& root)
+    {
+        std::ostringstream stream;
+        write_json(stream, root);
+        return stream.str();
+    }
+}
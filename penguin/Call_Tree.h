@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_CALL_TREE_H
+#define PENGUIN_CALL_TREE_H
+
+
+#include "Penguin_export.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace Penguin
+{
+    // Aggregates nested scopes into a per-thread call tree. Each thread only touches its own
+    // tree when entering and leaving scopes; the trees are merged by name on demand. The trees of
+    // threads that have exited are folded into one and freed, so thread churn does not grow memory.
+    class Penguin_Export Call_Tree
+    {
+    public:
+        using _duration_type = std::chrono::nanoseconds;
+
+        struct Node
+        {
+            std::string         name;
+            std::uint64_t       calls = 0;
+            _duration_type      inclusive_time = _duration_type::zero();
+            _duration_type      exclusive_time = _duration_type::zero();
+            _duration_type      min_time = _duration_type::zero();
+            _duration_type      max_time = _duration_type::zero();
+            std::vector<Node>   children;
+        };
+
+    public:
+        // The scope name must outlive the scope, a string literal is the intended use
+        static void enter(const char* scope_name);
+        static void leave(_duration_type duration);
+
+        // Merges the trees of every thread that has entered a scope, siblings sorted by inclusive time
+        static Node merge(void);
+        static void reset(void);
+
+        static std::string report_text(void);
+        static std::string report_text(const Node& root);
+        static std::string report_json(void);
+        static std::string report_json(const Node& root);
+
+    private:
+        Call_Tree(void) = delete;
+    };
+}
+
+
+#endif // PENGUIN_CALL_TREE_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_CLOCK_CALIBRATION_H
+#define PENGUIN_CLOCK_CALIBRATION_H
+
+
+#include "Running_Statistics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+
+namespace Penguin
+{
+    // Cost and jitter of reading Clock back to back, measured once on first use. Every interval timed
+    // with two reads includes roughly one read's worth of overhead, which timers can subtract.
+    template <class Clock>
+    class Clock_Calibration
+    {
+    public:
+        using _clock_type = Clock;
+        using _duration_type = typename Clock::duration;
+
+    public:
+        static const Clock_Calibration& get(void);
+
+    public:
+        _duration_type  get_jitter(void) const;
+        _duration_type  get_overhead(void) const;
+        _duration_type  get_resolution(void) const;
+
+        // Removes the read overhead from a measured interval, never going below zero
+        _duration_type  compensate(_duration_type measured) const;
+
+    private:
+        Clock_Calibration(void);
+
+    private:
+        _duration_type  jitter_;
+        _duration_type  overhead_;
+        _duration_type  resolution_;
+    };
+
+
+    template <class Clock>
+    const Clock_Calibration<Clock>&
+    Clock_Calibration<Clock>::get(void)
+    {
+        static const Clock_Calibration calibration;
+        return calibration;
+    }
+
+
+    template <class Clock>
+    Clock_Calibration<Clock>::Clock_Calibration(void)
+    {
+        constexpr std::size_t reads = 20001;
+        std::vector<typename Clock::time_point> times(reads);
+
+        // Warm the clock path (vDSO page, caches) before the reads that count
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+            times[0] = Clock::now();
+        }
+        for (std::size_t i = 0; i < reads; ++i)
+        {
+            times[i] = Clock::now();
+        }
+
+        std::vector<double> deltas(reads - 1);
+        _duration_type resolution = _duration_type::max();
+        for (std::size_t i = 1; i < reads; ++i)
+        {
+            _duration_type delta = times[i] - times[i - 1];
+            deltas[i - 1] = static_cast<double>(delta.count());
+            if (delta > _duration_type::zero())
+            {
+                resolution = std::min(resolution, delta);
+            }
+        }
+
+        // Drop the slowest percent, those reads were interrupted or preempted. The mean of the rest
+        // stays accurate even when the clock ticks more coarsely than a read takes.
+        std::vector<double> sorted(deltas);
+        std::size_t cutoff = sorted.size() - sorted.size() / 100;
+        std::nth_element(sorted.begin(), sorted.begin() + cutoff, sorted.end());
+        double limit = sorted[cutoff];
+
+        Running_Statistics statistics;
+        for (double delta : deltas)
+        {
+            if (delta <= limit)
+            {
+                statistics.add(delta);
+            }
+        }
+
+        using _representation_type = typename _duration_type::rep;
+        this->overhead_ = _duration_type(static_cast<_representation_type>(std::llround(statistics.mean())));
+        this->jitter_ = _duration_type(static_cast<_representation_type>(std::llround(statistics.standard_deviation())));
+        this->resolution_ = (resolution == _duration_type::max() ? _duration_type(1) : resolution);
+    }
+
+
+    template <class Clock>
+    typename Clock_Calibration<Clock>::_duration_type
+    Clock_Calibration<Clock>::get_jitter(void) const
+    {
+        return this->jitter_;
+    }
+
+
+    template <class Clock>
+    typename Clock_Calibration<Clock>::_duration_type
+    Clock_Calibration<Clock>::get_overhead(void) const
+    {
+        return this->overhead_;
+    }
+
+
+    template <class Clock>
+    typename Clock_Calibration<Clock>::_duration_type
+    Clock_Calibration<Clock>::get_resolution(void) const
+    {
+        return this->resolution_;
+    }
+
+
+    template <class Clock>
+    typename Clock_Calibration<Clock>::_duration_type
+    Clock_Calibration<Clock>::compensate(_duration_type measured) const
+    {
+        return std::max(measured - this->overhead_, _duration_type::zero());
+    }
+}
+
+
+#endif // PENGUIN_CLOCK_CALIBRATION_H
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_COUNTDOWN_EVENT_H
+#define PENGUIN_COUNTDOWN_EVENT_H
+
+
+#include "Futex.h"
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+
+
+namespace Penguin
+{
+    // Counts outstanding work, such as tasks handed to a pool, and is set once the count reaches
+    // zero. Unlike a Latch the count can grow while work is still in flight, and the event can be
+    // reset for the next batch once it is set and nobody is waiting.
+    class Countdown_Event
+    {
+    public:
+        explicit Countdown_Event(std::uint32_t count);
+
+        // Fails once the event is set, the work it counted is already over
+        bool add_count(std::uint32_t count = 1);
+
+        // Returns true for the signal that set the event
+        bool signal(std::uint32_t count = 1);
+
+        void reset(std::uint32_t count);
+
+        std::uint32_t   get_count(void) const;
+        bool            is_set(void) const;
+
+        void wait(void);
+
+        template <class Rep, class Period>
+        bool wait_for(const std::chrono::duration<Rep, Period>& rel_time);
+
+    private:
+        Countdown_Event(const Countdown_Event&) = delete;
+        Countdown_Event(Countdown_Event&&) = delete;
+
+    private:
+        Countdown_Event& operator = (const Countdown_Event&) = delete;
+        Countdown_Event& operator = (Countdown_Event&&) = delete;
+
+    private:
+        Futex::_word_type counter_;
+    };
+
+
+    inline
+    Countdown_Event::Countdown_Event(std::uint32_t count)
+        : counter_(count)
+    {
+    }
+
+
+    inline bool
+    Countdown_Event::add_count(std::uint32_t count)
+    {
+        std::uint32_t current = this->counter_.load(std::memory_order_relaxed);
+        do
+        {
+            if (current == 0)
+            {
+                return false;
+            }
+        } while (!this->counter_.compare_exchange_weak(current, current + count, std::memory_order_relaxed));
+        return true;
+    }
+
+
+    inline bool
+    Countdown_Event::signal(std::uint32_t count)
+    {
+        std::uint32_t previous = this->counter_.fetch_sub(count, std::memory_order_acq_rel);
+        assert(previous >= count && "Countdown_Event signalled past zero");
+        if (previous == count)
+        {
+            Futex::wake_all(this->counter_);
+            return true;
+        }
+        return false;
+    }
+
+
+    inline void
+    Countdown_Event::reset(std::uint32_t count)
+    {
+        this->counter_.store(count, std::memory_order_relaxed);
+    }
+
+
+    inline std::uint32_t
+    Countdown_Event::get_count(void) const
+    {
+        return this->counter_.load(std::memory_order_acquire);
+    }
+
+
+    inline bool
+    Countdown_Event::is_set(void) const
+    {
+        return this->get_count() == 0;
+    }
+
+
+    inline void
+    Countdown_Event::wait(void)
+    {
+        std::uint32_t counter = this->counter_.load(std::memory_order_acquire);
+        while (counter != 0)
+        {
+            Futex::wait_while(this->counter_, counter);
+            counter = this->counter_.load(std::memory_order_acquire);
+        }
+    }
+
+
+    template <class Rep, class Period>
+    bool
+    Countdown_Event::wait_for(const std::chrono::duration<Rep, Period>& rel_time)
+    {
+        std::chrono::steady_clock::time_point timeout_time = std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(rel_time);
+        std::uint32_t counter = this->counter_.load(std::memory_order_acquire);
+        while (counter != 0)
+        {
+            if (!Futex::wait_while_until(this->counter_, counter, timeout_time))
+            {
+                return false;
+            }
+            counter = this->counter_.load(std::memory_order_acquire);
+        }
+        return true;
+    }
+}
+
+
+#endif // PENGUIN_COUNTDOWN_EVENT_H
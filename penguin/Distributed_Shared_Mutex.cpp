@@ -0,0 +1,138 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Distributed_Shared_Mutex.h"
+#include <algorithm>
+#include <thread>
+
+
+namespace Penguin
+{
+    Distributed_Shared_Mutex::Distributed_Shared_Mutex(void)
+        : writer_(NO_WRITER)
+    {
+        // A power of two, so a thread's slot is a mask rather than a division
+        std::size_t processors = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        std::size_t slots = 1;
+        while (slots < processors)
+        {
+            slots *= 2;
+        }
+        this->slots_ = std::make_unique<Reader_Slot[]>(slots);
+        this->slot_mask_ = slots - 1;
+    }
+
+
+    Distributed_Shared_Mutex::~Distributed_Shared_Mutex(void)
+    {
+    }
+
+
+    void
+    Distributed_Shared_Mutex::lock(void)
+    {
+        this->writer_mutex_.lock();
+        this->writer_.store(WRITER, std::memory_order_seq_cst);
+        this->wait_for_readers();
+    }
+
+
+    bool
+    Distributed_Shared_Mutex::try_lock(void)
+    {
+        if (!this->writer_mutex_.try_lock())
+        {
+            return false;
+        }
+        this->writer_.store(WRITER, std::memory_order_seq_cst);
+        for (std::size_t i = 0; i <= this->slot_mask_; ++i)
+        {
+            if (this->slots_[i].readers.load(std::memory_order_seq_cst) != 0)
+            {
+                this->release_writer();
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    void
+    Distributed_Shared_Mutex::unlock(void)
+    {
+        this->release_writer();
+    }
+
+
+    std::size_t
+    Distributed_Shared_Mutex::slot_count(void) const
+    {
+        return this->slot_mask_ + 1;
+    }
+
+
+    void
+    Distributed_Shared_Mutex::wait_for_writer(void)
+    {
+        Spin_Wait spin_wait;
+        std::uint32_t state = this->writer_.load(std::memory_order_acquire);
+        while (state != NO_WRITER)
+        {
+            if (!spin_wait.will_yield())
+            {
+                spin_wait.wait();
+            }
+            else if (state == WRITER_READERS_PARKED
+                || this->writer_.compare_exchange_weak(state, WRITER_READERS_PARKED, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                Futex::wait(this->writer_, WRITER_READERS_PARKED);
+            }
+            state = this->writer_.load(std::memory_order_acquire);
+        }
+    }
+
+
+    void
+    Distributed_Shared_Mutex::wait_for_readers(void)
+    {
+        // New readers back out once they see the writer, so each slot only drains from here on
+        for (std::size_t i = 0; i <= this->slot_mask_; ++i)
+        {
+            Futex::_word_type& readers = this->slots_[i].readers;
+            Spin_Wait spin_wait;
+            std::uint32_t count = readers.load(std::memory_order_seq_cst);
+            while (count != 0)
+            {
+                if (!spin_wait.will_yield())
+                {
+                    spin_wait.wait();
+                }
+                else
+                {
+                    Futex::wait(readers, count);
+                }
+                count = readers.load(std::memory_order_seq_cst);
+            }
+        }
+    }
+
+
+    void
+    Distributed_Shared_Mutex::release_writer(void)
+    {
+        if (this->writer_.exchange(NO_WRITER, std::memory_order_release) == WRITER_READERS_PARKED)
+        {
+            Futex::wake_all(this->writer_);
+        }
+        this->writer_mutex_.unlock();
+    }
+
+
+    std::size_t
+    Distributed_Shared_Mutex::next_thread_index(void)
+    {
+        // Handing out indices in turn spreads threads evenly over the slots
+        static std::atomic<std::size_t> next_index(0);
+        return next_index.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_DISTRIBUTED_SHARED_MUTEX_H
+#define PENGUIN_DISTRIBUTED_SHARED_MUTEX_H
+
+
+#include "Penguin_export.h"
+#include "Adaptive_Mutex.h"
+#include "Futex.h"
+#include "Spin_Wait.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+namespace Penguin
+{
+    // A reader-writer lock whose readers count themselves in one of several cache-line sized slots,
+    // so concurrent readers on different processors never write the same line. Each thread keeps to
+    // one slot and there are at least as many slots as processors. Writers pay for that: they block
+    // new readers, then wait for every slot to drain. Writers are preferred, a steady stream of them
+    // can hold readers off. Meets the SharedMutex requirements, so it works with std::shared_lock,
+    // std::unique_lock and std::condition_variable_any.
+    class Penguin_Export Distributed_Shared_Mutex
+    {
+    public:
+        Distributed_Shared_Mutex(void);
+        ~Distributed_Shared_Mutex(void);
+
+        void lock(void);
+        bool try_lock(void);
+        void unlock(void);
+
+        void lock_shared(void);
+        bool try_lock_shared(void);
+        void unlock_shared(void);
+
+        std::size_t slot_count(void) const;
+
+    private:
+        Distributed_Shared_Mutex(const Distributed_Shared_Mutex&) = delete;
+        Distributed_Shared_Mutex(Distributed_Shared_Mutex&&) = delete;
+
+    private:
+        Distributed_Shared_Mutex& operator = (const Distributed_Shared_Mutex&) = delete;
+        Distributed_Shared_Mutex& operator = (Distributed_Shared_Mutex&&) = delete;
+
+    private:
+        struct alignas(64) Reader_Slot
+        {
+            Futex::_word_type readers{0};
+        };
+
+        Futex::_word_type&  reader_slot(void);
+        void                leave_slot(Futex::_word_type& readers);
+        void                wait_for_writer(void);
+        void                wait_for_readers(void);
+        void                release_writer(void);
+
+        static std::size_t  next_thread_index(void);
+
+    private:
+        static constexpr std::uint32_t NO_WRITER = 0;
+        static constexpr std::uint32_t WRITER = 1;
+        static constexpr std::uint32_t WRITER_READERS_PARKED = 2;
+
+    private:
+        std::unique_ptr<Reader_Slot[]>  slots_;
+        std::size_t                     slot_mask_;
+        Adaptive_Mutex                  writer_mutex_;
+
+        // Its own line, readers poll it on every lock_shared and writers are rare
+        alignas(64) Futex::_word_type   writer_;
+    };
+
+
+    inline void
+    Distributed_Shared_Mutex::lock_shared(void)
+    {
+        Futex::_word_type& readers = this->reader_slot();
+        for (;;)
+        {
+            // Announce first, then check for a writer; the writer does the opposite, so one of the
+            // two always sees the other
+            readers.fetch_add(1, std::memory_order_seq_cst);
+            if (this->writer_.load(std::memory_order_seq_cst) == NO_WRITER)
+            {
+                return;
+            }
+            this->leave_slot(readers);
+            this->wait_for_writer();
+        }
+    }
+
+
+    inline bool
+    Distributed_Shared_Mutex::try_lock_shared(void)
+    {
+        Futex::_word_type& readers = this->reader_slot();
+        readers.fetch_add(1, std::memory_order_seq_cst);
+        if (this->writer_.load(std::memory_order_seq_cst) == NO_WRITER)
+        {
+            return true;
+        }
+        this->leave_slot(readers);
+        return false;
+    }
+
+
+    inline void
+    Distributed_Shared_Mutex::unlock_shared(void)
+    {
+        this->leave_slot(this->reader_slot());
+    }
+
+
+    inline Futex::_word_type&
+    Distributed_Shared_Mutex::reader_slot(void)
+    {
+        thread_local const std::size_t thread_index = next_thread_index();
+        return this->slots_[thread_index & this->slot_mask_].readers;
+    }
+
+
+    inline void
+    Distributed_Shared_Mutex::leave_slot(Futex::_word_type& readers)
+    {
+        // The last reader out of a slot wakes a writer that may be draining it
+        if (readers.fetch_sub(1, std::memory_order_seq_cst) == 1 && this->writer_.load(std::memory_order_seq_cst) != NO_WRITER)
+        {
+            Futex::wake_all(readers);
+        }
+    }
+}
+
+
+#endif // PENGUIN_DISTRIBUTED_SHARED_MUTEX_H
@@ -2,13 +2,30 @@
 * Copyright (c) 2018 Michael Mathers
 */
 #include "Dynamic_Library.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <thread>
+#include <utility>
+
+
+#if defined(__linux__)
+# include <fcntl.h>
+# include <link.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
 
 
 namespace
 {
+    // Enough for the optional symbols a plugin interface probes for
+    constexpr std::size_t max_cached_misses = 64;
+
+
 #if defined(__GNUG__) 
-    void* get_library_function_linux(void* library_handle, const std::string& function_name)
+    void* get_library_function_linux(void* library_handle, const std::string& function_name, std::string& error)
     {
         // Call dlerror to clear any old error conditions
         dlerror();
@@ -16,18 +33,18 @@ namespace
         char* error_result = dlerror();
         if (error_result != nullptr)
         {
-            std::cerr << "ERROR! Failed to find address for " << function_name.c_str() << " - " << error_result << '\n';
+            error = error_result;
         }
         return function_address;
     }
 #elif defined(_MSC_VER) 
-    FARPROC get_library_function_windows(HMODULE library_handle, const std::string& function_name)
+    FARPROC get_library_function_windows(HMODULE library_handle, const std::string& function_name, std::string& error)
     {
 
         FARPROC function_address = GetProcAddress(library_handle, function_name.c_str());
         if (function_address == NULL)
         {
-            std::cerr << "ERROR (" << GetLastError() << ")! - Failed to find address for " << function_name.c_str() << '\n';
+            error = "error " + std::to_string(GetLastError());
         }
         return function_address;
     }
@@ -35,22 +52,25 @@ namespace
 
 
 #if defined(__GNUG__) 
-    void* load_library_linux(const std::string& library_path)
+    void* load_library_linux(const std::string& library_path, const Penguin::Load_Options& options, std::string& error)
     {
-        void* handle = dlopen(library_path.c_str(), RTLD_LAZY);
+        int flags = (options.binding == Penguin::Load_Options::Binding::NOW ? RTLD_NOW : RTLD_LAZY);
+        flags |= (options.visibility == Penguin::Load_Options::Visibility::GLOBAL ? RTLD_GLOBAL : RTLD_LOCAL);
+        flags |= (options.no_delete ? RTLD_NODELETE : 0);
+        void* handle = dlopen(library_path.c_str(), flags);
         if (handle == NULL)
         {
-            std::cerr << "ERROR! Failed to load library " << library_path.c_str() << " - " << dlerror() << '\n';
+            error = dlerror();
         }
         return handle;
     }
 #elif defined(_MSC_VER) 
-    HMODULE load_library_windows(const std::string& library_path)
+    HMODULE load_library_windows(const std::string& library_path, const Penguin::Load_Options& options, std::string& error)
     {
         HMODULE module_handle = LoadLibrary(library_path.c_str());
         if (module_handle == NULL)
         {
-            std::cerr << "ERROR (" << GetLastError() << ")! - Failed to load library " << library_path.c_str() << '\n';
+            error = "error " + std::to_string(GetLastError());
         }
         return module_handle;
     }
@@ -74,33 +94,721 @@ namespace
 #endif
         return library_path.string();
     }
-}
 
 
-namespace Penguin
-{
-    Library_Handle load_library(const std::filesystem::path& library_path)
+    Penguin::Library_Handle open_library(const std::filesystem::path& library_path, const Penguin::Load_Options& options, std::string& error)
     {
 #if defined(__GNUG__) 
-        return load_library_linux(fix_dynamic_library_filename(library_path));
+        return load_library_linux(fix_dynamic_library_filename(library_path), options, error);
 #elif defined(_MSC_VER) 
-        return load_library_windows(fix_dynamic_library_filename(library_path));
+        return load_library_windows(fix_dynamic_library_filename(library_path), options, error);
 #endif
     }
 
 
-    Function_Address get_library_function(Library_Handle library_handle, const std::string& function_name)
+#if defined(__linux__)
+    int prefetch_loaded_segments(struct dl_phdr_info* info, std::size_t, void* data)
+    {
+        const struct link_map* library_map = static_cast<const struct link_map*>(data);
+        if (info->dlpi_addr != library_map->l_addr || std::strcmp(info->dlpi_name, library_map->l_name) != 0)
+        {
+            return 0;
+        }
+
+        const std::uintptr_t page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+        for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i)
+        {
+            const ElfW(Phdr)& header = info->dlpi_phdr[i];
+            if (header.p_type != PT_LOAD || (header.p_flags & PF_R) == 0)
+            {
+                continue;
+            }
+            std::uintptr_t begin = (info->dlpi_addr + header.p_vaddr) & ~(page_size - 1);
+            std::uintptr_t end = info->dlpi_addr + header.p_vaddr + header.p_memsz;
+            madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+
+            // Reading a byte of every page maps it now, rather than on the request that first runs it
+            for (std::uintptr_t page = begin; page < end; page += page_size)
+            {
+                static_cast<void>(*reinterpret_cast<const volatile char*>(page));
+            }
+        }
+        return 1;
+    }
+#endif
+
+
+    void prefetch_library_pages(Penguin::Library_Handle library_handle)
+    {
+#if defined(__linux__)
+        struct link_map* library_map = nullptr;
+        if (dlinfo(library_handle, RTLD_DI_LINKMAP, &library_map) == 0 && library_map != nullptr)
+        {
+            dl_iterate_phdr(prefetch_loaded_segments, library_map);
+        }
+#endif
+    }
+
+
+    void close_library(Penguin::Library_Handle library_handle)
+    {
+#if defined(__GNUG__) 
+        dlclose(library_handle);
+#elif defined(_MSC_VER) 
+        FreeLibrary(library_handle);
+#endif
+    }
+
+
+    Penguin::Function_Address find_library_function(Penguin::Library_Handle library_handle, const std::string& function_name, std::string& error)
     {
 #if defined(__GNUG__) 
-        return get_library_function_linux(library_handle, function_name);
+        return get_library_function_linux(library_handle, function_name, error);
 #elif defined(_MSC_VER) 
-        return get_library_function_windows(library_handle, function_name);
+        return get_library_function_windows(library_handle, function_name, error);
 #endif
     }
 
 
+    // The key a library is shared under: its fixed file name, made absolute when it names a directory so
+    // relative and absolute spellings agree. Symbolic links are left alone, dlopen already shares those.
+    std::string canonical_library_path(const std::filesystem::path& library_path)
+    {
+        std::filesystem::path fixed_path(fix_dynamic_library_filename(library_path));
+        if (fixed_path.has_parent_path())
+        {
+            std::error_code error;
+            std::filesystem::path absolute_path = std::filesystem::absolute(fixed_path, error);
+            if (!error)
+            {
+                return absolute_path.lexically_normal().string();
+            }
+        }
+        return fixed_path.string();
+    }
+
+
+    // Shell-style matching of '*' and '?', backtracking to the most recent star on a mismatch
+    bool matches_pattern(const std::string& name, const std::string& pattern)
+    {
+        std::size_t name_index = 0;
+        std::size_t pattern_index = 0;
+        std::size_t star_index = std::string::npos;
+        std::size_t star_name_index = 0;
+        while (name_index < name.size())
+        {
+            if (pattern_index < pattern.size() && (pattern[pattern_index] == '?' || pattern[pattern_index] == name[name_index]))
+            {
+                ++name_index;
+                ++pattern_index;
+            }
+            else if (pattern_index < pattern.size() && pattern[pattern_index] == '*')
+            {
+                star_index = pattern_index++;
+                star_name_index = name_index;
+            }
+            else if (star_index != std::string::npos)
+            {
+                pattern_index = star_index + 1;
+                name_index = ++star_name_index;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        while (pattern_index < pattern.size() && pattern[pattern_index] == '*')
+        {
+            ++pattern_index;
+        }
+        return (pattern_index == pattern.size());
+    }
+
+
+    std::vector<std::filesystem::path> find_libraries(const std::filesystem::path& directory, const std::string& pattern)
+    {
+        std::vector<std::filesystem::path> library_paths;
+        std::error_code error;
+        for (std::filesystem::directory_iterator entry(directory, error), end; !error && entry != end; entry.increment(error))
+        {
+            const std::filesystem::path& library_path = entry->path();
+            if (entry->is_regular_file(error) == false || fix_dynamic_library_filename(library_path) != library_path.string())
+            {
+                continue;
+            }
+            std::string name(library_path.stem().string());
+#if defined(__GNUG__)
+            name.erase(0, Penguin::dynamic_library_prefix.size());
+#endif
+            if (matches_pattern(name, pattern))
+            {
+                library_paths.push_back(library_path);
+            }
+        }
+        std::sort(library_paths.begin(), library_paths.end());
+        return library_paths;
+    }
+
+
+    void prefetch_library(const std::filesystem::path& library_path)
+    {
+#if defined(__linux__)
+        // Starts reading the whole file into the page cache without waiting, so loads serialised behind
+        // the loader's lock find their pages already there
+        int descriptor = ::open(library_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor >= 0)
+        {
+            posix_fadvise(descriptor, 0, 0, POSIX_FADV_WILLNEED);
+            ::close(descriptor);
+        }
+#endif
+    }
+}
+
+
+namespace Penguin
+{
+    Library_Handle load_library(const std::filesystem::path& library_path)
+    {
+        std::string error;
+        Library_Handle handle = open_library(library_path, Load_Options(), error);
+        if (handle == NULL)
+        {
+            std::cerr << "ERROR! Failed to load library " << fix_dynamic_library_filename(library_path).c_str() << " - " << error.c_str() << '\n';
+        }
+        return handle;
+    }
+
+
+    Function_Address get_library_function(Library_Handle library_handle, const std::string& function_name)
+    {
+        std::string error;
+        Function_Address function_address = find_library_function(library_handle, function_name, error);
+        if (error.empty() == false)
+        {
+            std::cerr << "ERROR! Failed to find address for " << function_name.c_str() << " - " << error.c_str() << '\n';
+        }
+        return function_address;
+    }
+
+
+    namespace Dynamic_Library_Detail
+    {
+        // Maps strings to values for lookups that never lock. Entries are only ever added, and keys and
+        // outgrown tables live as long as the map, so a reader can finish probing whichever table it loaded.
+        // Callers serialise insert().
+        template <class Value>
+        class Lookup_Table
+        {
+        public:
+            Lookup_Table(void);
+
+            // nullptr when the key has not been inserted
+            const Value*    find(std::string_view key) const;
+            const Value&    insert(std::string_view key, Value value);
+
+        private:
+            Lookup_Table(const Lookup_Table&) = delete;
+            Lookup_Table(Lookup_Table&&) = delete;
+
+        private:
+            Lookup_Table& operator = (const Lookup_Table&) = delete;
+            Lookup_Table& operator = (Lookup_Table&&) = delete;
+
+        private:
+            struct Slot
+            {
+                // Published last, a slot is in use once its key is set
+                std::atomic<const std::string*> key;
+                std::uint64_t                   hash;
+                Value                           value;
+            };
+
+            struct Table
+            {
+                explicit Table(std::size_t capacity);
+
+                std::size_t             mask;
+                std::size_t             size;
+                std::unique_ptr<Slot[]> slots;
+            };
+
+        private:
+            // FNV-1a, keys are short names and paths so a byte at a time is fine
+            static std::uint64_t    hash(std::string_view key);
+            static const Slot*      probe(const Table& table, std::string_view key, std::uint64_t key_hash);
+            static Slot&            place(Table& table, const std::string* key, std::uint64_t key_hash, Value value);
+
+        private:
+            std::atomic<Table*>                 current_;
+            std::deque<std::string>             keys_;
+            std::vector<std::unique_ptr<Table>> tables_;
+        };
+
+
+        template <class Value>
+        Lookup_Table<Value>::Table::Table(std::size_t capacity)
+            : mask(capacity - 1)
+            , size(0)
+            , slots(new Slot[capacity])
+        {
+            for (std::size_t i = 0; i < capacity; ++i)
+            {
+                this->slots[i].key.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+
+        template <class Value>
+        Lookup_Table<Value>::Lookup_Table(void)
+            : current_(nullptr)
+        {
+            this->tables_.push_back(std::make_unique<Table>(16));
+            this->current_.store(this->tables_.back().get(), std::memory_order_release);
+        }
+
+
+        template <class Value>
+        const Value*
+        Lookup_Table<Value>::find(std::string_view key) const
+        {
+            const Slot* slot = probe(*this->current_.load(std::memory_order_acquire), key, hash(key));
+            return (slot != nullptr ? &slot->value : nullptr);
+        }
+
+
+        template <class Value>
+        const Value&
+        Lookup_Table<Value>::insert(std::string_view key, Value value)
+        {
+            Table* table = this->current_.load(std::memory_order_relaxed);
+            if ((table->size + 1) * 4 > (table->mask + 1) * 3)
+            {
+                // Rehash into a table twice the size; readers still in the old one finish there
+                std::unique_ptr<Table> grown = std::make_unique<Table>((table->mask + 1) * 2);
+                for (std::size_t i = 0; i <= table->mask; ++i)
+                {
+                    const Slot& slot = table->slots[i];
+                    const std::string* slot_key = slot.key.load(std::memory_order_relaxed);
+                    if (slot_key != nullptr)
+                    {
+                        place(*grown, slot_key, slot.hash, slot.value);
+                    }
+                }
+                table = grown.get();
+                this->tables_.push_back(std::move(grown));
+            }
+
+            this->keys_.emplace_back(key);
+            Slot& slot = place(*table, &this->keys_.back(), hash(key), value);
+            this->current_.store(table, std::memory_order_release);
+            return slot.value;
+        }
+
+
+        template <class Value>
+        std::uint64_t
+        Lookup_Table<Value>::hash(std::string_view key)
+        {
+            std::uint64_t key_hash = 14695981039346656037ull;
+            for (char character : key)
+            {
+                key_hash ^= static_cast<unsigned char>(character);
+                key_hash *= 1099511628211ull;
+            }
+            return key_hash;
+        }
+
+
+        template <class Value>
+        const typename Lookup_Table<Value>::Slot*
+        Lookup_Table<Value>::probe(const Table& table, std::string_view key, std::uint64_t key_hash)
+        {
+            // Tables are never more than three quarters full, so every probe ends at an empty slot
+            for (std::size_t index = key_hash & table.mask; ; index = (index + 1) & table.mask)
+            {
+                const Slot& slot = table.slots[index];
+                const std::string* slot_key = slot.key.load(std::memory_order_acquire);
+                if (slot_key == nullptr)
+                {
+                    return nullptr;
+                }
+                if (slot.hash == key_hash && *slot_key == key)
+                {
+                    return &slot;
+                }
+            }
+        }
+
+
+        template <class Value>
+        typename Lookup_Table<Value>::Slot&
+        Lookup_Table<Value>::place(Table& table, const std::string* key, std::uint64_t key_hash, Value value)
+        {
+            std::size_t index = key_hash & table.mask;
+            while (table.slots[index].key.load(std::memory_order_relaxed) != nullptr)
+            {
+                index = (index + 1) & table.mask;
+            }
+            Slot& slot = table.slots[index];
+            slot.hash = key_hash;
+            slot.value = value;
+            slot.key.store(key, std::memory_order_release);
+            ++table.size;
+            return slot;
+        }
+    }
+
+
+    Library::Library(const std::filesystem::path& library_path)
+        : Library(library_path, Load_Options())
+    {
+    }
+
+
+    Library::Library(const std::filesystem::path& library_path, const Load_Options& options)
+        : handle_(NULL)
+        , symbols_(std::make_unique<Dynamic_Library_Detail::Lookup_Table<Function_Address>>())
+        , cached_misses_(0)
+    {
+        this->handle_ = open_library(library_path, options, this->error_);
+        if (this->handle_ == NULL)
+        {
+            return;
+        }
+        if (options.prefetch_pages)
+        {
+            prefetch_library_pages(this->handle_);
+        }
+        for (const std::string& symbol_name : options.prewarm_symbols)
+        {
+            this->find(symbol_name);
+        }
+    }
+
+
+    Library::~Library(void)
+    {
+        if (this->handle_ != NULL)
+        {
+            close_library(this->handle_);
+        }
+    }
+
+
+    const std::string&
+    Library::get_error(void) const
+    {
+        return this->error_;
+    }
+
+
+    Library_Handle
+    Library::get_handle(void) const
+    {
+        return this->handle_;
+    }
+
+
+    bool
+    Library::is_loaded(void) const
+    {
+        return (this->handle_ != NULL);
+    }
+
+
+    Function_Address
+    Library::find(std::string_view symbol_name) const
+    {
+        if (this->handle_ == NULL)
+        {
+            return nullptr;
+        }
+        const Function_Address* cached = this->symbols_->find(symbol_name);
+        if (cached != nullptr)
+        {
+            return *cached;
+        }
+        return this->resolve(symbol_name);
+    }
+
+
+    Function_Address
+    Library::resolve(std::string_view symbol_name) const
+    {
+        std::lock_guard<std::mutex> resolve_guard(this->resolve_mutex_);
+
+        // Another thread may have resolved it while we waited
+        const Function_Address* cached = this->symbols_->find(symbol_name);
+        if (cached != nullptr)
+        {
+            return *cached;
+        }
+
+        std::string error;
+        Function_Address address = find_library_function(this->handle_, std::string(symbol_name), error);
+        if (error.empty())
+        {
+            return this->symbols_->insert(symbol_name, address);
+        }
+        // Names that are never found would otherwise grow the table without bound
+        if (this->cached_misses_ < max_cached_misses)
+        {
+            ++this->cached_misses_;
+            this->symbols_->insert(symbol_name, nullptr);
+        }
+        return nullptr;
+    }
+
+
+    Library_Registry::Entry::Entry(std::string canonical_path)
+        : path(std::move(canonical_path))
+        , references(0)
+        , library(nullptr)
+    {
+    }
+
+
+    Library_Registry::Reference::Reference(void)
+        : entry_(nullptr)
+    {
+    }
+
+
+    Library_Registry::Reference::Reference(Entry* entry)
+        : entry_(entry)
+    {
+    }
+
+
+    Library_Registry::Reference::Reference(const Reference& other)
+        : entry_(other.entry_)
+    {
+        if (this->entry_ != nullptr)
+        {
+            // Holding other keeps the count above zero, so this can never revive a closed library
+            this->entry_->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+
+    Library_Registry::Reference::Reference(Reference&& other)
+        : entry_(other.entry_)
+    {
+        other.entry_ = nullptr;
+    }
+
+
+    Library_Registry::Reference::~Reference(void)
+    {
+        if (this->entry_ != nullptr)
+        {
+            Library_Registry::release(this->entry_);
+        }
+    }
+
+
+    Library_Registry::Reference&
+    Library_Registry::Reference::operator = (const Reference& other)
+    {
+        Reference copy(other);
+        std::swap(this->entry_, copy.entry_);
+        return *this;
+    }
+
+
+    Library_Registry::Reference&
+    Library_Registry::Reference::operator = (Reference&& other)
+    {
+        Reference moved(std::move(other));
+        std::swap(this->entry_, moved.entry_);
+        return *this;
+    }
+
+
+    Library_Registry::Reference::operator bool(void) const
+    {
+        return (this->entry_ != nullptr);
+    }
+
+
+    const Library&
+    Library_Registry::Reference::operator * (void) const
+    {
+        return *this->get();
+    }
+
+
+    const Library*
+    Library_Registry::Reference::operator -> (void) const
+    {
+        return this->get();
+    }
+
+
+    const Library*
+    Library_Registry::Reference::get(void) const
+    {
+        return (this->entry_ != nullptr ? this->entry_->library.load(std::memory_order_relaxed) : nullptr);
+    }
+
+
+    Library_Registry::Library_Registry(void)
+        : requested_paths_(std::make_unique<Dynamic_Library_Detail::Lookup_Table<Entry*>>())
+    {
+    }
+
+
+    Library_Registry::~Library_Registry(void)
+    {
+        // References must not outlive their registry, whatever is still open closes here
+        for (std::pair<const std::string, std::unique_ptr<Entry>>& entry : this->entries_)
+        {
+            delete entry.second->library.load(std::memory_order_relaxed);
+        }
+    }
+
+
+    Library_Registry&
+    Library_Registry::get(void)
+    {
+        static Library_Registry* registry = new Library_Registry();
+        return *registry;
+    }
+
+
+    Library_Registry::Reference
+    Library_Registry::load(const std::filesystem::path& library_path, const Load_Options& options)
+    {
+        // A relative path with a directory in it means another file after a change of directory, so
+        // only absolute paths and bare names, which are looked up on the search path, are remembered
+        bool remembered = (library_path.is_absolute() || library_path.has_parent_path() == false);
+        std::string requested_path(library_path.string());
+        Entry* const* known_entry = remembered ? this->requested_paths_->find(requested_path) : nullptr;
+        if (known_entry != nullptr)
+        {
+            if (try_share(*known_entry))
+            {
+                return Reference(*known_entry);
+            }
+            return open(*known_entry, options);
+        }
+
+        Entry* entry = nullptr;
+        {
+            std::lock_guard<std::mutex> registry_guard(this->mutex_);
+            known_entry = remembered ? this->requested_paths_->find(requested_path) : nullptr;
+            if (known_entry != nullptr)
+            {
+                entry = *known_entry;
+            }
+            else
+            {
+                // Different spellings of the same library land on one entry
+                std::string canonical_path(canonical_library_path(library_path));
+                std::unique_ptr<Entry>& canonical_entry = this->entries_[canonical_path];
+                if (canonical_entry == nullptr)
+                {
+                    canonical_entry = std::make_unique<Entry>(canonical_path);
+                }
+                entry = canonical_entry.get();
+                if (remembered)
+                {
+                    this->requested_paths_->insert(requested_path, entry);
+                }
+            }
+        }
+        // Only opening the same library waits here, different libraries open concurrently
+        return open(entry, options);
+    }
+
+
+    Library_Registry::Reference
+    Library_Registry::open(Entry* entry, const Load_Options& options)
+    {
+        std::lock_guard<std::mutex> entry_guard(entry->mutex);
+        if (entry->library.load(std::memory_order_relaxed) == nullptr)
+        {
+            entry->library.store(new Library(entry->path, options), std::memory_order_relaxed);
+        }
+        entry->references.fetch_add(1, std::memory_order_release);
+        return Reference(entry);
+    }
+
+
+    bool
+    Library_Registry::try_share(Entry* entry)
+    {
+        // Only while someone else holds it open; from zero the library may be closing
+        std::uint32_t references = entry->references.load(std::memory_order_relaxed);
+        while (references != 0)
+        {
+            if (entry->references.compare_exchange_weak(references, references + 1, std::memory_order_acquire))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    void
+    Library_Registry::release(Entry* entry)
+    {
+        if (entry->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            // A load may have taken a new reference before we got the lock, then it stays open
+            std::lock_guard<std::mutex> entry_guard(entry->mutex);
+            if (entry->references.load(std::memory_order_relaxed) == 0)
+            {
+                delete entry->library.exchange(nullptr, std::memory_order_relaxed);
+            }
+        }
+    }
+
+
+    std::future<std::vector<Preloaded_Library>> preload_libraries(const std::filesystem::path& directory, const std::string& pattern, std::size_t threads, const Load_Options& options)
+    {
+        return std::async(std::launch::async, [directory, pattern, threads, options] {
+            std::vector<std::filesystem::path> library_paths = find_libraries(directory, pattern);
+            for (const std::filesystem::path& library_path : library_paths)
+            {
+                prefetch_library(library_path);
+            }
+
+            std::vector<Preloaded_Library> libraries(library_paths.size());
+            std::atomic<std::size_t> next_library(0);
+            auto load_libraries = [&library_paths, &libraries, &next_library, &options] {
+                for (std::size_t index = next_library.fetch_add(1); index < library_paths.size(); index = next_library.fetch_add(1))
+                {
+                    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+                    libraries[index].library = Library_Registry::get().load(library_paths[index], options);
+                    libraries[index].load_time = std::chrono::steady_clock::now() - start_time;
+                    libraries[index].path = library_paths[index];
+                }
+            };
+
+            std::size_t worker_count = (threads != 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u));
+            worker_count = std::min(worker_count, library_paths.size());
+
+            // This thread is one of the workers
+            std::vector<std::thread> workers;
+            for (std::size_t i = 1; i < worker_count; ++i)
+            {
+                workers.emplace_back(load_libraries);
+            }
+            load_libraries();
+            for (std::thread& worker : workers)
+            {
+                worker.join();
+            }
+            return libraries;
+        });
+    }
+
+
     int test_library_function(void)
     {
         return 1;
     }
-}
\ No newline at end of file
+}
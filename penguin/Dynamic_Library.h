@@ -6,7 +6,17 @@
 
 
 #include "Penguin_export.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 
 #if defined(__GNUG__) 
@@ -33,9 +43,195 @@ namespace Penguin
 #endif 
 
 
+    // How a library is opened. The defaults are what load_library() has always done: lazy binding with
+    // local symbols. Binding, visibility and no_delete only apply to dlopen.
+    struct Load_Options
+    {
+        enum class Binding
+        {
+            LAZY,   // RTLD_LAZY, imports resolve on their first call
+            NOW     // RTLD_NOW, every import resolves while loading
+        };
+
+        enum class Visibility
+        {
+            LOCAL,  // RTLD_LOCAL
+            GLOBAL  // RTLD_GLOBAL, symbols can satisfy libraries loaded later
+        };
+
+        Binding                     binding = Binding::LAZY;
+        Visibility                  visibility = Visibility::LOCAL;
+
+        // RTLD_NODELETE, the library stays mapped after it is closed
+        bool                        no_delete = false;
+
+        // Looked up into the Library's symbol cache straight after loading
+        std::vector<std::string>    prewarm_symbols;
+
+        // Reads the library's mapped pages in and faults them, Linux only
+        bool                        prefetch_pages = false;
+    };
+
+
     Penguin_Export Function_Address    get_library_function(Library_Handle library_handle, const std::string& function_name);
     Penguin_Export Library_Handle      load_library(const std::filesystem::path& library_path);
 
+    namespace Dynamic_Library_Detail
+    {
+        // The lock-free string map behind Library's symbol cache and Library_Registry's path lookups
+        template <class Value>
+        class Lookup_Table;
+    }
+
+
+    // Owns a loaded library, closing it on destruction. Symbols are resolved through the loader once and
+    // then cached in a lock-free table, so resolving on a hot path costs a hash and a string compare.
+    // Failures are reported through return values.
+    class Penguin_Export Library
+    {
+    public:
+        // The same name fixing as load_library() applies, check is_loaded() afterwards
+        explicit Library(const std::filesystem::path& library_path);
+        Library(const std::filesystem::path& library_path, const Load_Options& options);
+        ~Library(void);
+
+        // Why loading failed, empty once loaded
+        const std::string&  get_error(void) const;
+        Library_Handle      get_handle(void) const;
+        bool                is_loaded(void) const;
+
+        // nullptr when the library has no such symbol. Only the first few misses are cached, so probing
+        // for optional symbols stays cheap without names that are never found growing the cache forever.
+        Function_Address    find(std::string_view symbol_name) const;
+
+        template <class Signature>
+        Signature*          get(std::string_view symbol_name) const;
+
+    private:
+        Library(const Library&) = delete;
+        Library(Library&&) = delete;
+
+    private:
+        Library& operator = (const Library&) = delete;
+        Library& operator = (Library&&) = delete;
+
+    private:
+        Function_Address resolve(std::string_view symbol_name) const;
+
+    private:
+        Library_Handle                                                          handle_;
+        std::string                                                             error_;
+        std::unique_ptr<Dynamic_Library_Detail::Lookup_Table<Function_Address>> symbols_;
+        mutable std::size_t                                                     cached_misses_;
+        mutable std::mutex                                                      resolve_mutex_;
+    };
+
+
+    // Shares one Library per canonical path across the process. References count the users of each
+    // library, which is closed when the last reference goes. A path that has been loaded before is
+    // looked up without locking and without touching the file system, and taking a reference to a library
+    // that is still open is an atomic increment.
+    class Penguin_Export Library_Registry
+    {
+    private:
+        struct Entry;
+
+    public:
+        class Penguin_Export Reference
+        {
+        public:
+            Reference(void);
+            Reference(const Reference& other);
+            Reference(Reference&& other);
+            ~Reference(void);
+
+            Reference& operator = (const Reference& other);
+            Reference& operator = (Reference&& other);
+
+            explicit operator bool(void) const;
+            const Library& operator * (void) const;
+            const Library* operator -> (void) const;
+            const Library* get(void) const;
+
+        private:
+            friend class Library_Registry;
+            explicit Reference(Entry* entry);
+
+        private:
+            Entry* entry_;
+        };
+
+    public:
+        Library_Registry(void);
+        ~Library_Registry(void);
+
+        // Never destroyed, so references held by other statics stay valid through exit
+        static Library_Registry& get(void);
+
+        // Check is_loaded() on the result, a failed load is retried once its references are gone. Options
+        // only take effect when this load is the one that opens the library.
+        Reference load(const std::filesystem::path& library_path, const Load_Options& options = Load_Options());
+
+    private:
+        Library_Registry(const Library_Registry&) = delete;
+        Library_Registry(Library_Registry&&) = delete;
+
+    private:
+        Library_Registry& operator = (const Library_Registry&) = delete;
+        Library_Registry& operator = (Library_Registry&&) = delete;
+
+    private:
+        struct Entry
+        {
+            explicit Entry(std::string canonical_path);
+
+            const std::string           path;
+            std::atomic<std::uint32_t>  references;
+            std::atomic<const Library*> library;
+
+            // Held while opening and closing the library
+            std::mutex                  mutex;
+        };
+
+    private:
+        static Reference    open(Entry* entry, const Load_Options& options);
+        static bool         try_share(Entry* entry);
+        static void         release(Entry* entry);
+
+    private:
+        // Keyed by the path as requested, so repeat loads skip canonicalising it. Only absolute paths
+        // and bare names, which mean the same library whatever the working directory.
+        std::unique_ptr<Dynamic_Library_Detail::Lookup_Table<Entry*>>   requested_paths_;
+        std::unordered_map<std::string, std::unique_ptr<Entry>>         entries_;
+        std::mutex                                                      mutex_;
+    };
+
+
+    struct Preloaded_Library
+    {
+        std::filesystem::path       path;
+
+        // Check is_loaded() and get_error() for libraries that failed
+        Library_Registry::Reference library;
+        std::chrono::nanoseconds    load_time;
+    };
+
+
+    // Loads every library in directory whose name, less the platform prefix and extension, matches
+    // pattern ('*' and '?' wildcards), through Library_Registry::get() on a pool of worker threads.
+    // Only file names load_library() would not need to fix are considered. Results are sorted by path.
+    // The future is ready once every load has finished or failed, so callers can carry on meanwhile.
+    Penguin_Export std::future<std::vector<Preloaded_Library>> preload_libraries(const std::filesystem::path& directory, const std::string& pattern = "*", std::size_t threads = 0, const Load_Options& options = Load_Options());
+
+
+    template <class Signature>
+    Signature*
+    Library::get(std::string_view symbol_name) const
+    {
+        return reinterpret_cast<Signature*>(this->find(symbol_name));
+    }
+
+
     // Using C linkage here to provide a non-mangled name that can be found with a simplified look up
     extern "C" Penguin_Export int       test_library_function(void);
 }
@@ -0,0 +1,239 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Epoch_Domain.h"
+#include "Spin_Wait.h"
+#include <vector>
+
+
+namespace Penguin
+{
+    Epoch_Domain::Participant::Participant(Epoch_Domain& domain)
+        : domain_(domain)
+        , record_(nullptr)
+        , nesting_(0)
+        , next_reclaim_(domain.batch_size_)
+    {
+        std::lock_guard<std::mutex> lock(this->domain_.mutex_);
+        for (Record* record = this->domain_.records_.load(std::memory_order_relaxed); record != nullptr; record = record->next)
+        {
+            if (!record->in_use)
+            {
+                this->record_ = record;
+                break;
+            }
+        }
+        if (this->record_ == nullptr)
+        {
+            // Published with its next pointer set, so try_advance() can walk the list without locking
+            this->record_ = new Record();
+            this->record_->next = this->domain_.records_.load(std::memory_order_relaxed);
+            this->domain_.records_.store(this->record_, std::memory_order_release);
+        }
+        this->record_->in_use = true;
+        ++this->domain_.participants_;
+    }
+
+
+    Epoch_Domain::Participant::~Participant(void)
+    {
+        this->record_->epoch.store(INACTIVE, std::memory_order_release);
+        this->reclaim();
+
+        // Whatever is still unsafe is handed to the domain, for the next reclaim() by anyone
+        std::lock_guard<std::mutex> lock(this->domain_.mutex_);
+        this->domain_.orphan_count_.fetch_add(this->retired_.size(), std::memory_order_relaxed);
+        this->domain_.orphans_.insert(this->domain_.orphans_.end(), this->retired_.begin(), this->retired_.end());
+        this->record_->in_use = false;
+        --this->domain_.participants_;
+    }
+
+
+    void
+    Epoch_Domain::Participant::retire(void* object, void (*deleter)(void*))
+    {
+        // The fence orders the caller's unlinking before the epoch is read
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        this->retired_.push_back(Retired{object, deleter, this->domain_.epoch_.load(std::memory_order_relaxed)});
+        this->domain_.garbage_.fetch_add(1, std::memory_order_relaxed);
+
+        if (this->retired_.size() >= this->next_reclaim_)
+        {
+            this->reclaim();
+            this->next_reclaim_ = this->retired_.size() + this->domain_.batch_size_;
+        }
+
+        // Inside a critical section waiting would wait on ourselves, so leave() does it instead
+        if (this->nesting_ == 0 && this->retired_.size() > this->domain_.max_garbage_)
+        {
+            this->reclaim_to_bound();
+        }
+    }
+
+
+    std::size_t
+    Epoch_Domain::Participant::reclaim(void)
+    {
+        this->domain_.try_advance();
+        std::uint64_t epoch = this->domain_.epoch_.load(std::memory_order_acquire);
+
+        // Retired in epoch order, so the safe ones are at the front. Each is removed before its deleter
+        // runs, which may retire more.
+        std::size_t freed = 0;
+        while (!this->retired_.empty() && is_safe(this->retired_.front(), epoch))
+        {
+            Retired retired = this->retired_.front();
+            this->retired_.pop_front();
+            retired.deleter(retired.object);
+            ++freed;
+        }
+        this->domain_.garbage_.fetch_sub(freed, std::memory_order_relaxed);
+
+        if (this->domain_.orphan_count_.load(std::memory_order_relaxed) != 0)
+        {
+            freed += this->domain_.free_orphans(epoch);
+        }
+        return freed;
+    }
+
+
+    void
+    Epoch_Domain::Participant::reclaim_to_bound(void)
+    {
+        Spin_Wait spin_wait;
+        while (this->retired_.size() > this->domain_.max_garbage_)
+        {
+            if (this->reclaim() == 0)
+            {
+                spin_wait.wait();
+            }
+        }
+        this->next_reclaim_ = this->retired_.size() + this->domain_.batch_size_;
+    }
+
+
+    Epoch_Domain::Epoch_Domain(std::size_t batch_size, std::size_t max_garbage)
+        : batch_size_(batch_size > 0 ? batch_size : 1)
+        , max_garbage_(max_garbage)
+        , epoch_(0)
+        , records_(nullptr)
+        , garbage_(0)
+        , orphan_count_(0)
+        , participants_(0)
+    {
+    }
+
+
+    Epoch_Domain::~Epoch_Domain(void)
+    {
+        // With no participants left nothing can be reading, so everything is safe
+        for (const Retired& retired : this->orphans_)
+        {
+            retired.deleter(retired.object);
+        }
+
+        Record* record = this->records_.load(std::memory_order_relaxed);
+        while (record != nullptr)
+        {
+            Record* next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+
+    std::uint64_t
+    Epoch_Domain::get_epoch(void) const
+    {
+        return this->epoch_.load(std::memory_order_relaxed);
+    }
+
+
+    std::size_t
+    Epoch_Domain::get_garbage_count(void) const
+    {
+        return this->garbage_.load(std::memory_order_relaxed);
+    }
+
+
+    std::size_t
+    Epoch_Domain::get_participant_count(void) const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        return this->participants_;
+    }
+
+
+    std::size_t
+    Epoch_Domain::reclaim(void)
+    {
+        this->try_advance();
+        return this->free_orphans(this->epoch_.load(std::memory_order_acquire));
+    }
+
+
+    std::size_t
+    Epoch_Domain::free_orphans(std::uint64_t epoch)
+    {
+        // Deleters run unlocked, in case they register a participant of their own
+        std::vector<Retired> safe;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex_, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                return 0;
+            }
+            for (std::deque<Retired>::iterator retired = this->orphans_.begin(); retired != this->orphans_.end(); )
+            {
+                if (is_safe(*retired, epoch))
+                {
+                    safe.push_back(*retired);
+                    retired = this->orphans_.erase(retired);
+                }
+                else
+                {
+                    ++retired;
+                }
+            }
+            this->orphan_count_.store(this->orphans_.size(), std::memory_order_relaxed);
+        }
+
+        for (const Retired& retired : safe)
+        {
+            retired.deleter(retired.object);
+        }
+        this->garbage_.fetch_sub(safe.size(), std::memory_order_relaxed);
+        return safe.size();
+    }
+
+
+    bool
+    Epoch_Domain::try_advance(void)
+    {
+        std::uint64_t epoch = this->epoch_.load(std::memory_order_relaxed);
+
+        // Pairs with the fence in enter(): either that participant's announcement is seen here, or it
+        // will see every node unlinked before now as gone
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (Record* record = this->records_.load(std::memory_order_acquire); record != nullptr; record = record->next)
+        {
+            std::uint64_t announced = record->epoch.load(std::memory_order_relaxed);
+            if (announced != INACTIVE && announced != epoch)
+            {
+                return false;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Losing the race means another thread advanced it for us
+        this->epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_release, std::memory_order_relaxed);
+        return true;
+    }
+
+
+    bool
+    Epoch_Domain::is_safe(const Retired& retired, std::uint64_t epoch)
+    {
+        return (epoch >= retired.epoch + 2);
+    }
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_EPOCH_DOMAIN_H
+#define PENGUIN_EPOCH_DOMAIN_H
+
+
+#include "Penguin_export.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+
+
+namespace Penguin
+{
+    // Epoch-based reclamation for lock-free structures. A thread registers with the domain through a
+    // Participant and reads shared nodes only between enter() and leave(). A node that has been unlinked
+    // is retired rather than deleted, and is deleted once every thread that could still hold it has left
+    // its critical section, which the domain tracks with a global epoch that only advances when every
+    // active participant has seen the current one. Entering writes the participant's own cache line and
+    // nothing shared. Retired nodes are kept per participant and freed in batches. A reader that stalls
+    // holds up every node retired since it entered, so once a participant holds more than max_garbage
+    // it waits, outside its critical sections, for the epoch to move on.
+    class Penguin_Export Epoch_Domain
+    {
+    private:
+        struct Record;
+        struct Retired;
+
+    public:
+        // One thread's registration, used by that thread alone. A thread should not hold two
+        // participants of the same domain, waiting for the bound in one would wait on the other.
+        class Penguin_Export Participant
+        {
+        public:
+            explicit Participant(Epoch_Domain& domain);
+            ~Participant(void);
+
+            // Nests, only the outermost pair announces anything
+            void        enter(void);
+            void        leave(void);
+            bool        is_active(void) const;
+
+            // Call once the object can no longer be reached through the structure. It is deleted once no
+            // critical section that could have reached it remains, possibly by another thread after this
+            // participant is destroyed.
+            template <class T>
+            void        retire(T* object);
+            void        retire(void* object, void (*deleter)(void*));
+
+            // Tries to advance the epoch and frees this participant's nodes that are now safe, returning how many
+            std::size_t reclaim(void);
+            std::size_t get_garbage_count(void) const;
+
+        private:
+            Participant(const Participant&) = delete;
+            Participant(Participant&&) = delete;
+
+        private:
+            Participant& operator = (const Participant&) = delete;
+            Participant& operator = (Participant&&) = delete;
+
+        private:
+            void        reclaim_to_bound(void);
+
+        private:
+            Epoch_Domain&       domain_;
+            Record*             record_;
+            std::uint32_t       nesting_;
+            std::deque<Retired> retired_;
+
+            // Reclaiming scans every participant, so it is done once per batch of retirements
+            std::size_t         next_reclaim_;
+        };
+
+        // Enters on construction and leaves on destruction
+        class Guard
+        {
+        public:
+            explicit Guard(Participant& participant);
+            ~Guard(void);
+
+        private:
+            Guard(const Guard&) = delete;
+            Guard(Guard&&) = delete;
+
+        private:
+            Guard& operator = (const Guard&) = delete;
+            Guard& operator = (Guard&&) = delete;
+
+        private:
+            Participant& participant_;
+        };
+
+    public:
+        explicit Epoch_Domain(std::size_t batch_size = 64, std::size_t max_garbage = 4096);
+
+        // Frees everything still retired. Every participant must have been destroyed.
+        ~Epoch_Domain(void);
+
+        std::uint64_t   get_epoch(void) const;
+
+        // Retired and not yet freed, across every participant and those already destroyed
+        std::size_t     get_garbage_count(void) const;
+        std::size_t     get_participant_count(void) const;
+
+        // Tries to advance the epoch and frees what destroyed participants left behind, returning how many
+        std::size_t     reclaim(void);
+
+    private:
+        Epoch_Domain(const Epoch_Domain&) = delete;
+        Epoch_Domain(Epoch_Domain&&) = delete;
+
+    private:
+        Epoch_Domain& operator = (const Epoch_Domain&) = delete;
+        Epoch_Domain& operator = (Epoch_Domain&&) = delete;
+
+    private:
+        static constexpr std::uint64_t INACTIVE = std::numeric_limits<std::uint64_t>::max();
+
+        // Records are reused by later participants and only freed with the domain
+        struct alignas(64) Record
+        {
+            // The epoch seen on entering, or INACTIVE
+            std::atomic<std::uint64_t>  epoch{INACTIVE};
+            Record*                     next = nullptr;
+            bool                        in_use = false;
+        };
+
+        struct Retired
+        {
+            void*           object;
+            void            (*deleter)(void*);
+            std::uint64_t   epoch;
+        };
+
+    private:
+        std::size_t     free_orphans(std::uint64_t epoch);
+        bool            try_advance(void);
+
+        // Nodes retired in an epoch are safe once the epoch has advanced twice since
+        static bool     is_safe(const Retired& retired, std::uint64_t epoch);
+
+    private:
+        const std::size_t           batch_size_;
+        const std::size_t           max_garbage_;
+
+        alignas(64) std::atomic<std::uint64_t> epoch_;
+        std::atomic<Record*>        records_;
+        std::atomic<std::size_t>    garbage_;
+        std::atomic<std::size_t>    orphan_count_;
+
+        // Held to register participants and to take over what they leave behind
+        mutable std::mutex          mutex_;
+        std::deque<Retired>         orphans_;
+        std::size_t                 participants_;
+    };
+
+
+    inline void
+    Epoch_Domain::Participant::enter(void)
+    {
+        if (this->nesting_++ == 0)
+        {
+            this->record_->epoch.store(this->domain_.epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+            // Announced before any shared pointer is read, pairs with the fence in try_advance()
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+
+    inline void
+    Epoch_Domain::Participant::leave(void)
+    {
+        if (--this->nesting_ == 0)
+        {
+            this->record_->epoch.store(INACTIVE, std::memory_order_release);
+            if (this->retired_.size() > this->domain_.max_garbage_)
+            {
+                this->reclaim_to_bound();
+            }
+        }
+    }
+
+
+    inline bool
+    Epoch_Domain::Participant::is_active(void) const
+    {
+        return (this->nesting_ != 0);
+    }
+
+
+    template <class T>
+    void
+    Epoch_Domain::Participant::retire(T* object)
+    {
+        this->retire(object, [](void* retired) { delete static_cast<T*>(retired); });
+    }
+
+
+    inline std::size_t
+    Epoch_Domain::Participant::get_garbage_count(void) const
+    {
+        return this->retired_.size();
+    }
+
+
+    inline
+    Epoch_Domain::Guard::Guard(Participant& participant)
+        : participant_(participant)
+    {
+        this->participant_.enter();
+    }
+
+
+    inline
+    Epoch_Domain::Guard::~Guard(void)
+    {
+        this->participant_.leave();
+    }
+}
+
+
+#endif // PENGUIN_EPOCH_DOMAIN_H
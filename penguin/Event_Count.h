@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_EVENT_COUNT_H
+#define PENGUIN_EVENT_COUNT_H
+
+
+#include "Futex.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+
+namespace Penguin
+{
+    // Lets threads sleep until a lock-free structure changes, without a lock on the producer side.
+    // A consumer announces itself, re-checks its condition and only then sleeps:
+    //
+    //     if (!queue.try_pop(value)) {
+    //         auto key = event_count.prepare_wait();
+    //         if (queue.try_pop(value)) event_count.cancel_wait();
+    //         else event_count.wait(key);
+    //     }
+    //
+    // and producers call notify() after publishing. A notify between prepare_wait() and wait() changes
+    // the key, so the wait returns at once instead of sleeping through it. With nobody waiting,
+    // notify() is a fence and a load.
+    class Event_Count
+    {
+    public:
+        using _key_type = std::uint32_t;
+
+    public:
+        Event_Count(void);
+
+        _key_type   prepare_wait(void);
+        void        cancel_wait(void);
+        void        wait(_key_type key);
+
+        // Returns false if timeout_time passed before a notification
+        bool        wait_until(_key_type key, std::chrono::steady_clock::time_point timeout_time);
+
+        void        notify(void);
+        void        notify_all(void);
+
+    private:
+        Event_Count(const Event_Count&) = delete;
+        Event_Count(Event_Count&&) = delete;
+
+    private:
+        Event_Count& operator = (const Event_Count&) = delete;
+        Event_Count& operator = (Event_Count&&) = delete;
+
+    private:
+        bool has_waiters(void) const;
+
+    private:
+        std::atomic<std::uint32_t>  waiters_;
+        Futex::_word_type           epoch_;
+    };
+
+
+    inline
+    Event_Count::Event_Count(void)
+        : waiters_(0)
+        , epoch_(0)
+    {
+    }
+
+
+    inline Event_Count::_key_type
+    Event_Count::prepare_wait(void)
+    {
+        // Counted before the caller re-checks its condition, so a producer publishing after that check
+        // is certain to see us
+        this->waiters_.fetch_add(1, std::memory_order_seq_cst);
+        return this->epoch_.load(std::memory_order_seq_cst);
+    }
+
+
+    inline void
+    Event_Count::cancel_wait(void)
+    {
+        this->waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+
+    inline void
+    Event_Count::wait(_key_type key)
+    {
+        Futex::wait_while(this->epoch_, key);
+        this->waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+
+    inline bool
+    Event_Count::wait_until(_key_type key, std::chrono::steady_clock::time_point timeout_time)
+    {
+        bool notified = Futex::wait_while_until(this->epoch_, key, timeout_time);
+        this->waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return notified;
+    }
+
+
+    inline void
+    Event_Count::notify(void)
+    {
+        if (this->has_waiters())
+        {
+            this->epoch_.fetch_add(1, std::memory_order_seq_cst);
+            Futex::wake_one(this->epoch_);
+        }
+    }
+
+
+    inline void
+    Event_Count::notify_all(void)
+    {
+        if (this->has_waiters())
+        {
+            this->epoch_.fetch_add(1, std::memory_order_seq_cst);
+            Futex::wake_all(this->epoch_);
+        }
+    }
+
+
+    inline bool
+    Event_Count::has_waiters(void) const
+    {
+        // Orders the caller's publishing store before the load, pairing with prepare_wait()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return this->waiters_.load(std::memory_order_relaxed) != 0;
+    }
+}
+
+
+#endif // PENGUIN_EVENT_COUNT_H
@@ -0,0 +1,165 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Futex.h"
+#include <climits>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(_MSC_VER)
+# ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN
+# endif
+# include <Windows.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+
+namespace Penguin
+{
+    static_assert(sizeof(Futex::_word_type) == sizeof(std::uint32_t), "futex words must be plain 32-bit integers");
+
+
+    namespace
+    {
+#if defined(__linux__)
+        long futex(Futex::_word_type& word, int operation, std::uint32_t value, const timespec* timeout, Futex::_word_type* target = nullptr, std::uint32_t value3 = 0)
+        {
+            // Private futexes skip the shared-mapping lookup, these words never cross processes
+            return syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), operation | FUTEX_PRIVATE_FLAG, value, timeout,
+                reinterpret_cast<std::uint32_t*>(target), value3);
+        }
+#elif defined(_MSC_VER)
+        // WaitOnAddress takes whole milliseconds, rounded up so a short wait does not become a poll
+        DWORD to_milliseconds(std::chrono::nanoseconds rel_time)
+        {
+            std::chrono::milliseconds milliseconds = std::chrono::ceil<std::chrono::milliseconds>(rel_time);
+            return (milliseconds.count() >= INFINITE ? INFINITE - 1 : static_cast<DWORD>(milliseconds.count()));
+        }
+#else
+        // Elsewhere waiters park on a condition variable chosen by the word's address. Words share
+        // buckets, so every wake notifies the whole bucket and waiters on other words return spuriously.
+        struct Parking_Bucket
+        {
+            std::mutex              mutex;
+            std::condition_variable condition;
+        };
+
+
+        Parking_Bucket& get_bucket(const Futex::_word_type& word)
+        {
+            static Parking_Bucket buckets[64];
+            return buckets[(reinterpret_cast<std::uintptr_t>(&word) / sizeof(Futex::_word_type)) % 64];
+        }
+
+
+        void wake_bucket(Futex::_word_type& word)
+        {
+            // Taking the mutex orders the wake after any waiter that saw the old value has started waiting
+            Parking_Bucket& bucket = get_bucket(word);
+            {
+                std::lock_guard<std::mutex> bucket_guard(bucket.mutex);
+            }
+            bucket.condition.notify_all();
+        }
+#endif
+    }
+
+
+    void
+    Futex::wait(_word_type& word, std::uint32_t expected)
+    {
+#if defined(__linux__)
+        futex(word, FUTEX_WAIT, expected, nullptr);
+#elif defined(_MSC_VER)
+        WaitOnAddress(&word, &expected, sizeof(expected), INFINITE);
+#else
+        Parking_Bucket& bucket = get_bucket(word);
+        std::unique_lock<std::mutex> bucket_lock(bucket.mutex);
+        if (word.load(std::memory_order_relaxed) == expected)
+        {
+            bucket.condition.wait(bucket_lock);
+        }
+#endif
+    }
+
+
+    bool
+    Futex::wait_for(_word_type& word, std::uint32_t expected, std::chrono::nanoseconds rel_time)
+    {
+        if (rel_time <= std::chrono::nanoseconds::zero())
+        {
+            return false;
+        }
+#if defined(__linux__)
+        std::chrono::seconds seconds = std::chrono::duration_cast<std::chrono::seconds>(rel_time);
+        timespec timeout;
+        timeout.tv_sec = static_cast<time_t>(seconds.count());
+        timeout.tv_nsec = static_cast<long>((rel_time - seconds).count());
+        // FUTEX_WAIT takes a relative timeout, measured against CLOCK_MONOTONIC
+        return !(futex(word, FUTEX_WAIT, expected, &timeout) == -1 && errno == ETIMEDOUT);
+#elif defined(_MSC_VER)
+        return !(WaitOnAddress(&word, &expected, sizeof(expected), to_milliseconds(rel_time)) == FALSE && GetLastError() == ERROR_TIMEOUT);
+#else
+        Parking_Bucket& bucket = get_bucket(word);
+        std::unique_lock<std::mutex> bucket_lock(bucket.mutex);
+        if (word.load(std::memory_order_relaxed) == expected)
+        {
+            return (bucket.condition.wait_for(bucket_lock, rel_time) == std::cv_status::no_timeout);
+        }
+        return true;
+#endif
+    }
+
+
+    void
+    Futex::wake_one(_word_type& word)
+    {
+#if defined(__linux__)
+        futex(word, FUTEX_WAKE, 1, nullptr);
+#elif defined(_MSC_VER)
+        WakeByAddressSingle(&word);
+#else
+        wake_bucket(word);
+#endif
+    }
+
+
+    void
+    Futex::wake_all(_word_type& word)
+    {
+#if defined(__linux__)
+        futex(word, FUTEX_WAKE, INT_MAX, nullptr);
+#elif defined(_MSC_VER)
+        WakeByAddressAll(&word);
+#else
+        wake_bucket(word);
+#endif
+    }
+
+
+    bool
+    Futex::requeue(_word_type& word, std::uint32_t expected, std::uint32_t wake_count, _word_type& target)
+    {
+#if defined(__linux__)
+        // FUTEX_CMP_REQUEUE passes the number to requeue where the timeout would go
+        const timespec* requeue_count = reinterpret_cast<const timespec*>(static_cast<std::uintptr_t>(INT_MAX));
+        return !(futex(word, FUTEX_CMP_REQUEUE, wake_count, requeue_count, &target, expected) == -1 && errno == EAGAIN);
+#else
+        // Nothing can move waiters between words here, so wake them all instead; each re-checks its
+        // condition and then contends for whatever target guards
+        if (word.load(std::memory_order_seq_cst) != expected)
+        {
+            return false;
+        }
+        Futex::wake_all(word);
+        return true;
+#endif
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_FUTEX_H
+#define PENGUIN_FUTEX_H
+
+
+#include "Penguin_export.h"
+#include "Spin_Wait.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+
+namespace Penguin
+{
+    // Blocking on a 32-bit word, the building block for the primitives that park instead of spinning.
+    // Linux uses futex(2) directly and Windows WaitOnAddress. Elsewhere waiters sleep on a condition
+    // variable picked by the word's address. Every wait may return spuriously, and callers re-check the word.
+    class Penguin_Export Futex
+    {
+    public:
+        using _word_type = std::atomic<std::uint32_t>;
+
+    public:
+        // Sleeps while word still holds expected
+        static void wait(_word_type& word, std::uint32_t expected);
+
+        // Returns false when rel_time passed without a wake
+        static bool wait_for(_word_type& word, std::uint32_t expected, std::chrono::nanoseconds rel_time);
+
+        static void wake_one(_word_type& word);
+        static void wake_all(_word_type& word);
+
+        // Wakes up to wake_count waiters on word and moves the rest, without waking them, to wait on
+        // target instead. Does nothing and returns false if word no longer holds expected.
+        static bool requeue(_word_type& word, std::uint32_t expected, std::uint32_t wake_count, _word_type& target);
+
+        // Returns once word no longer holds value, spinning briefly before sleeping in case it
+        // changes soon. The timed form returns false if timeout_time passed first.
+        static void wait_while(_word_type& word, std::uint32_t value);
+        static bool wait_while_until(_word_type& word, std::uint32_t value, std::chrono::steady_clock::time_point timeout_time);
+
+    private:
+        Futex(void) = delete;
+    };
+
+
+    inline void
+    Futex::wait_while(_word_type& word, std::uint32_t value)
+    {
+        Spin_Wait spin_wait;
+        while (word.load(std::memory_order_acquire) == value)
+        {
+            if (spin_wait.will_yield())
+            {
+                Futex::wait(word, value);
+            }
+            else
+            {
+                spin_wait.wait();
+            }
+        }
+    }
+
+
+    inline bool
+    Futex::wait_while_until(_word_type& word, std::uint32_t value, std::chrono::steady_clock::time_point timeout_time)
+    {
+        Spin_Wait spin_wait;
+        while (word.load(std::memory_order_acquire) == value)
+        {
+            std::chrono::steady_clock::duration remaining = timeout_time - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::steady_clock::duration::zero())
+            {
+                return false;
+            }
+            if (spin_wait.will_yield())
+            {
+                Futex::wait_for(word, value, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+            }
+            else
+            {
+                spin_wait.wait();
+            }
+        }
+        return true;
+    }
+}
+
+
+#endif // PENGUIN_FUTEX_H
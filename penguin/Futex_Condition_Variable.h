@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_FUTEX_CONDITION_VARIABLE_H
+#define PENGUIN_FUTEX_CONDITION_VARIABLE_H
+
+
+#include "Adaptive_Mutex.h"
+#include "Futex.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+
+namespace Penguin
+{
+    // A condition variable for Penguin::Adaptive_Mutex whose notify_all does not stampede. It wakes one
+    // waiter and requeues the rest onto the mutex's futex, so each is woken by the unlock of the one
+    // before it instead of all waking at once to fight over the mutex (wait morphing). Every waiter
+    // re-acquires the mutex marked contended, which keeps that chain of unlock wakes going.
+    class Futex_Condition_Variable
+    {
+    public:
+        using _mutex_type = Penguin::Adaptive_Mutex;
+        using _guard_type = std::unique_lock<_mutex_type>;
+
+    public:
+        Futex_Condition_Variable(void);
+
+        void notify_one(void) noexcept;
+        void notify_all(void) noexcept;
+
+        void wait(_guard_type& guard);
+
+        template <class Predicate>
+        void wait(_guard_type& guard, Predicate predicate);
+
+        template <class Rep, class Period>
+        std::cv_status wait_for(_guard_type& guard, const std::chrono::duration<Rep, Period>& rel_time);
+
+        template <class Rep, class Period, class Predicate>
+        bool wait_for(_guard_type& guard, const std::chrono::duration<Rep, Period>& rel_time, Predicate predicate);
+
+        template <class Clock, class Duration>
+        std::cv_status wait_until(_guard_type& guard, const std::chrono::time_point<Clock, Duration>& timeout_time);
+
+        template <class Clock, class Duration, class Predicate>
+        bool wait_until(_guard_type& guard, const std::chrono::time_point<Clock, Duration>& timeout_time, Predicate predicate);
+
+    private:
+        Futex_Condition_Variable(const Futex_Condition_Variable&) = delete;
+        Futex_Condition_Variable(Futex_Condition_Variable&&) = delete;
+
+    private:
+        Futex_Condition_Variable& operator = (const Futex_Condition_Variable&) = delete;
+        Futex_Condition_Variable& operator = (Futex_Condition_Variable&&) = delete;
+
+    private:
+        // Returns false if rel_time passed without a notification
+        bool wait_for_notification(_guard_type& guard, const std::chrono::nanoseconds* rel_time);
+
+    private:
+        // Bumped by every notification, so a waiter that saw the old value cannot sleep through it
+        Futex::_word_type               sequence_;
+        std::atomic<std::uint32_t>      waiters_;
+
+        // The mutex waiters last released, where notify_all requeues them
+        std::atomic<_mutex_type*>       mutex_;
+    };
+
+
+    inline
+    Futex_Condition_Variable::Futex_Condition_Variable(void)
+        : sequence_(0)
+        , waiters_(0)
+        , mutex_(nullptr)
+    {
+    }
+
+
+    inline void
+    Futex_Condition_Variable::notify_one(void) noexcept
+    {
+        if (this->waiters_.load(std::memory_order_seq_cst) == 0)
+        {
+            return;
+        }
+        this->sequence_.fetch_add(1, std::memory_order_seq_cst);
+        Futex::wake_one(this->sequence_);
+    }
+
+
+    inline void
+    Futex_Condition_Variable::notify_all(void) noexcept
+    {
+        if (this->waiters_.load(std::memory_order_seq_cst) == 0)
+        {
+            return;
+        }
+        _mutex_type* mutex = this->mutex_.load(std::memory_order_relaxed);
+        std::uint32_t sequence = this->sequence_.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+        // The requeue is refused if another notification moved the sequence meanwhile; that one wakes
+        // the same waiters, so trying again with the newer value is enough
+        while (!Futex::requeue(this->sequence_, sequence, 1, mutex->state_))
+        {
+            sequence = this->sequence_.load(std::memory_order_seq_cst);
+        }
+    }
+
+
+    inline void
+    Futex_Condition_Variable::wait(_guard_type& guard)
+    {
+        this->wait_for_notification(guard, nullptr);
+    }
+
+
+    template <class Predicate>
+    void
+    Futex_Condition_Variable::wait(_guard_type& guard, Predicate predicate)
+    {
+        while (!predicate())
+        {
+            this->wait(guard);
+        }
+    }
+
+
+    template <class Rep, class Period>
+    std::cv_status
+    Futex_Condition_Variable::wait_for(_guard_type& guard, const std::chrono::duration<Rep, Period>& rel_time)
+    {
+        std::chrono::nanoseconds timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(rel_time);
+        return this->wait_for_notification(guard, &timeout) ? std::cv_status::no_timeout : std::cv_status::timeout;
+    }
+
+
+    template <class Rep, class Period, class Predicate>
+    bool
+    Futex_Condition_Variable::wait_for(_guard_type& guard, const std::chrono::duration<Rep, Period>& rel_time, Predicate predicate)
+    {
+        return this->wait_until(guard, std::chrono::steady_clock::now() + rel_time, predicate);
+    }
+
+
+    template <class Clock, class Duration>
+    std::cv_status
+    Futex_Condition_Variable::wait_until(_guard_type& guard, const std::chrono::time_point<Clock, Duration>& timeout_time)
+    {
+        std::chrono::nanoseconds timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout_time - Clock::now());
+        this->wait_for_notification(guard, &timeout);
+        return (Clock::now() < timeout_time ? std::cv_status::no_timeout : std::cv_status::timeout);
+    }
+
+
+    template <class Clock, class Duration, class Predicate>
+    bool
+    Futex_Condition_Variable::wait_until(_guard_type& guard, const std::chrono::time_point<Clock, Duration>& timeout_time, Predicate predicate)
+    {
+        while (!predicate())
+        {
+            if (this->wait_until(guard, timeout_time) == std::cv_status::timeout)
+            {
+                return predicate();
+            }
+        }
+        return true;
+    }
+
+
+    inline bool
+    Futex_Condition_Variable::wait_for_notification(_guard_type& guard, const std::chrono::nanoseconds* rel_time)
+    {
+        assert(guard.owns_lock());
+        _mutex_type* mutex = guard.mutex();
+        assert((this->mutex_.load(std::memory_order_relaxed) == nullptr || this->mutex_.load(std::memory_order_relaxed) == mutex)
+            && "Futex_Condition_Variable waiters must all use the same mutex");
+
+        // Both are read by notifiers; the mutex is still held, so no notification can slip in between
+        this->mutex_.store(mutex, std::memory_order_relaxed);
+        this->waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::uint32_t sequence = this->sequence_.load(std::memory_order_seq_cst);
+        guard.unlock();
+
+        bool notified = true;
+        if (rel_time == nullptr)
+        {
+            Futex::wait(this->sequence_, sequence);
+        }
+        else
+        {
+            notified = Futex::wait_for(this->sequence_, sequence, *rel_time);
+        }
+
+        // We may have been requeued onto the mutex, whose other sleepers only we know about
+        mutex->lock_parked();
+        guard.release();
+        guard = _guard_type(*mutex, std::adopt_lock);
+        this->waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return notified;
+    }
+}
+
+
+#endif // PENGUIN_FUTEX_CONDITION_VARIABLE_H
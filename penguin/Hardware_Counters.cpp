@@ -0,0 +1,259 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Hardware_Counters.h"
+#include <atomic>
+
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/mman.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+# include <cstring>
+#endif
+
+
+namespace
+{
+    std::atomic<bool> counters_enabled(false);
+
+
+#if defined(__linux__)
+    constexpr int counter_count = 4;
+
+    const std::uint64_t counter_configs[counter_count] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+
+    class Counter_Group
+    {
+    public:
+        Counter_Group(void)
+            : available_(0)
+            , group_size_(0)
+        {
+            for (int i = 0; i < counter_count; ++i)
+            {
+                this->fds_[i] = -1;
+                this->pages_[i] = nullptr;
+                this->group_slots_[i] = -1;
+            }
+
+            long page_size = sysconf(_SC_PAGESIZE);
+            int leader = -1;
+            for (int i = 0; i < counter_count; ++i)
+            {
+                perf_event_attr attributes;
+                std::memset(&attributes, 0, sizeof(attributes));
+                attributes.size = sizeof(attributes);
+                attributes.type = PERF_TYPE_HARDWARE;
+                attributes.config = counter_configs[i];
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv = 1;
+                attributes.read_format = PERF_FORMAT_GROUP;
+
+                int fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0));
+                if (fd < 0)
+                {
+                    // Unsupported or not permitted, the next counter that opens leads the group instead
+                    continue;
+                }
+                if (leader < 0)
+                {
+                    leader = fd;
+                }
+
+                this->fds_[i] = fd;
+                this->group_slots_[i] = this->group_size_++;
+                this->available_ |= (1u << i);
+
+                // The mapped page exposes the hardware counter index for rdpmc when the kernel allows it
+                void* page = mmap(nullptr, static_cast<size_t>(page_size), PROT_READ, MAP_SHARED, fd, 0);
+                this->pages_[i] = (page == MAP_FAILED ? nullptr : static_cast<perf_event_mmap_page*>(page));
+            }
+            this->leader_ = leader;
+            this->page_size_ = page_size;
+        }
+
+        ~Counter_Group(void)
+        {
+            for (int i = 0; i < counter_count; ++i)
+            {
+                if (this->pages_[i] != nullptr)
+                {
+                    munmap(this->pages_[i], static_cast<size_t>(this->page_size_));
+                }
+                if (this->fds_[i] >= 0)
+                {
+                    close(this->fds_[i]);
+                }
+            }
+        }
+
+        bool is_available(void) const
+        {
+            return this->available_ != 0;
+        }
+
+        bool read(Penguin::Hardware_Counter_Values& values) const
+        {
+            std::uint64_t counts[counter_count] = {0, 0, 0, 0};
+            if (!this->read_user_space(counts) && !this->read_group(counts))
+            {
+                return false;
+            }
+            values.cycles = counts[0];
+            values.instructions = counts[1];
+            values.cache_misses = counts[2];
+            values.branch_misses = counts[3];
+            values.available = this->available_;
+            return true;
+        }
+
+    private:
+        bool read_user_space(std::uint64_t (&counts)[counter_count]) const
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            for (int i = 0; i < counter_count; ++i)
+            {
+                if (this->fds_[i] < 0)
+                {
+                    continue;
+                }
+                const volatile perf_event_mmap_page* page = this->pages_[i];
+                if (page == nullptr)
+                {
+                    return false;
+                }
+
+                // The kernel updates the page under a sequence lock, retry if it changed while reading
+                std::uint32_t sequence;
+                std::uint64_t count;
+                do
+                {
+                    sequence = page->lock;
+                    std::atomic_signal_fence(std::memory_order_seq_cst);
+                    std::uint32_t index = page->index;
+                    if (page->cap_user_rdpmc == 0 || index == 0)
+                    {
+                        return false;
+                    }
+                    count = page->offset;
+
+                    std::uint32_t low;
+                    std::uint32_t high;
+                    asm volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(index - 1));
+                    std::uint64_t pmc = (static_cast<std::uint64_t>(high) << 32) | low;
+                    std::uint16_t width = page->pmc_width;
+                    pmc <<= (64 - width);
+                    count += static_cast<std::uint64_t>(static_cast<std::int64_t>(pmc) >> (64 - width));
+                    std::atomic_signal_fence(std::memory_order_seq_cst);
+                } while (page->lock != sequence);
+                counts[i] = count;
+            }
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        bool read_group(std::uint64_t (&counts)[counter_count]) const
+        {
+            if (this->leader_ < 0)
+            {
+                return false;
+            }
+
+            std::uint64_t buffer[1 + counter_count];
+            ssize_t bytes = ::read(this->leader_, buffer, sizeof(buffer));
+            if (bytes < static_cast<ssize_t>(sizeof(std::uint64_t) * (1 + this->group_size_)))
+            {
+                return false;
+            }
+            for (int i = 0; i < counter_count; ++i)
+            {
+                if (this->group_slots_[i] >= 0)
+                {
+                    counts[i] = buffer[1 + this->group_slots_[i]];
+                }
+            }
+            return true;
+        }
+
+    private:
+        int                     fds_[counter_count];
+        perf_event_mmap_page*   pages_[counter_count];
+        int                     group_slots_[counter_count];
+        std::uint32_t           available_;
+        int                     group_size_;
+        int                     leader_;
+        long                    page_size_;
+    };
+
+
+    const Counter_Group& get_counter_group(void)
+    {
+        // Counters count for the thread that opened them, so each thread gets its own group
+        thread_local Counter_Group counter_group;
+        return counter_group;
+    }
+#endif
+}
+
+
+namespace Penguin
+{
+    void
+    Hardware_Counters::disable(void)
+    {
+        counters_enabled.store(false, std::memory_order_relaxed);
+    }
+
+
+    void
+    Hardware_Counters::enable(void)
+    {
+        counters_enabled.store(true, std::memory_order_relaxed);
+    }
+
+
+    bool
+    Hardware_Counters::is_enabled(void)
+    {
+        return counters_enabled.load(std::memory_order_relaxed);
+    }
+
+
+    bool
+    Hardware_Counters::is_available(void)
+    {
+#if defined(__linux__)
+        return get_counter_group().is_available();
+#else
+        return false;
+#endif
+    }
+
+
+    std::optional<Hardware_Counter_Values>
+    Hardware_Counters::sample(void)
+    {
+        if (!is_enabled())
+        {
+            return std::nullopt;
+        }
+#if defined(__linux__)
+        const Counter_Group& counter_group = get_counter_group();
+        Hardware_Counter_Values values;
+        if (counter_group.is_available() && counter_group.read(values))
+        {
+            return values;
+        }
+#endif
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_HARDWARE_COUNTERS_H
+#define PENGUIN_HARDWARE_COUNTERS_H
+
+
+#include "Penguin_export.h"
+#include <cstdint>
+#include <optional>
+
+
+namespace Penguin
+{
+    struct Hardware_Counter_Values
+    {
+        enum Counter : std::uint32_t
+        {
+            CYCLES          = 1 << 0,
+            INSTRUCTIONS    = 1 << 1,
+            CACHE_MISSES    = 1 << 2,
+            BRANCH_MISSES   = 1 << 3
+        };
+
+        std::uint64_t cycles = 0;
+        std::uint64_t instructions = 0;
+        std::uint64_t cache_misses = 0;
+        std::uint64_t branch_misses = 0;
+
+        // Counters the hardware or kernel refused to open read as zero and are missing from the mask
+        std::uint32_t available = 0;
+
+        bool has(Counter counter) const { return (this->available & counter) != 0; }
+
+        Hardware_Counter_Values operator - (const Hardware_Counter_Values& earlier) const
+        {
+            Hardware_Counter_Values difference;
+            difference.cycles = this->cycles - earlier.cycles;
+            difference.instructions = this->instructions - earlier.instructions;
+            difference.cache_misses = this->cache_misses - earlier.cache_misses;
+            difference.branch_misses = this->branch_misses - earlier.branch_misses;
+            difference.available = this->available & earlier.available;
+            return difference;
+        }
+    };
+
+
+    // Per-thread cycle, instruction, cache miss and branch miss counters opened with perf_event_open on
+    // Linux and read with rdpmc where the kernel permits it. Collection is off until enabled; where the
+    // counters cannot be opened (other platforms, containers without permission) reads return nothing.
+    class Penguin_Export Hardware_Counters
+    {
+    public:
+        static void disable(void);
+        static void enable(void);
+        static bool is_enabled(void);
+
+        // Opens the calling thread's counter group on first use
+        static bool is_available(void);
+
+        // Current counts for the calling thread, nothing when disabled or unavailable
+        static std::optional<Hardware_Counter_Values> sample(void);
+
+    private:
+        Hardware_Counters(void) = delete;
+    };
+}
+
+
+#endif // PENGUIN_HARDWARE_COUNTERS_H
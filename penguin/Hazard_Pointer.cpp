@@ -0,0 +1,257 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Hazard_Pointer.h"
+#include <algorithm>
+
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace Penguin
+{
+    namespace
+    {
+        // Registers the process for expedited private membarriers, false where the kernel has none
+        bool register_membarrier(void)
+        {
+#if defined(__linux__) && defined(SYS_membarrier)
+            long commands = syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0);
+            if (commands < 0 || (commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED) == 0)
+            {
+                return false;
+            }
+            return (syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0);
+#else
+            return false;
+#endif
+        }
+    }
+
+
+    Hazard_Pointer_Domain::Participant::Participant(Hazard_Pointer_Domain& domain)
+        : domain_(domain)
+        , record_(nullptr)
+        , next_scan_(0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->domain_.mutex_);
+            for (Record* record = this->domain_.records_.load(std::memory_order_relaxed); record != nullptr; record = record->next)
+            {
+                if (!record->in_use)
+                {
+                    this->record_ = record;
+                    break;
+                }
+            }
+            if (this->record_ == nullptr)
+            {
+                // Published with its next pointer set, so scans can walk the list without locking
+                this->record_ = new Record();
+                this->record_->next = this->domain_.records_.load(std::memory_order_relaxed);
+                this->domain_.records_.store(this->record_, std::memory_order_release);
+                this->domain_.record_count_.fetch_add(1, std::memory_order_relaxed);
+            }
+            this->record_->in_use = true;
+            ++this->domain_.participants_;
+        }
+        this->next_scan_ = this->domain_.scan_threshold();
+    }
+
+
+    Hazard_Pointer_Domain::Participant::~Participant(void)
+    {
+        this->clear();
+        this->reclaim();
+
+        // Whatever is still protected is handed to the domain, for the next reclaim() by anyone
+        std::lock_guard<std::mutex> lock(this->domain_.mutex_);
+        this->domain_.orphan_count_.fetch_add(this->retired_.size(), std::memory_order_relaxed);
+        this->domain_.orphans_.insert(this->domain_.orphans_.end(), this->retired_.begin(), this->retired_.end());
+        this->record_->in_use = false;
+        --this->domain_.participants_;
+    }
+
+
+    void
+    Hazard_Pointer_Domain::Participant::retire(void* object, void (*deleter)(void*))
+    {
+        this->retired_.push_back(Retired{object, deleter});
+        this->domain_.garbage_.fetch_add(1, std::memory_order_relaxed);
+        if (this->retired_.size() >= this->next_scan_)
+        {
+            this->reclaim();
+        }
+    }
+
+
+    std::size_t
+    Hazard_Pointer_Domain::Participant::reclaim(void)
+    {
+        std::vector<const void*> hazards = this->domain_.collect_hazards();
+
+        // Nodes still protected are kept, and scanning again waits for a threshold's worth of new ones
+        std::size_t freed = free_unprotected(this->retired_, hazards);
+        this->domain_.garbage_.fetch_sub(freed, std::memory_order_relaxed);
+        this->next_scan_ = this->retired_.size() + this->domain_.scan_threshold();
+
+        if (this->domain_.orphan_count_.load(std::memory_order_relaxed) != 0)
+        {
+            freed += this->domain_.free_orphans();
+        }
+        return freed;
+    }
+
+
+    Hazard_Pointer_Domain::Hazard_Pointer_Domain(Fence fence, std::size_t batch_size)
+        : asymmetric_(fence == Fence::ASYMMETRIC && register_membarrier())
+        , batch_size_(batch_size > 0 ? batch_size : 1)
+        , records_(nullptr)
+        , record_count_(0)
+        , garbage_(0)
+        , orphan_count_(0)
+        , participants_(0)
+    {
+    }
+
+
+    Hazard_Pointer_Domain::~Hazard_Pointer_Domain(void)
+    {
+        // With no participants left no slot can hold anything
+        for (const Retired& retired : this->orphans_)
+        {
+            retired.deleter(retired.object);
+        }
+
+        Record* record = this->records_.load(std::memory_order_relaxed);
+        while (record != nullptr)
+        {
+            Record* next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+
+    bool
+    Hazard_Pointer_Domain::is_asymmetric(void) const
+    {
+        return this->asymmetric_;
+    }
+
+
+    std::size_t
+    Hazard_Pointer_Domain::get_garbage_count(void) const
+    {
+        return this->garbage_.load(std::memory_order_relaxed);
+    }
+
+
+    std::size_t
+    Hazard_Pointer_Domain::get_participant_count(void) const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        return this->participants_;
+    }
+
+
+    std::size_t
+    Hazard_Pointer_Domain::reclaim(void)
+    {
+        return this->free_orphans();
+    }
+
+
+    void
+    Hazard_Pointer_Domain::heavy_fence(void) const
+    {
+#if defined(__linux__) && defined(SYS_membarrier)
+        if (this->asymmetric_)
+        {
+            // Every running thread of the process executes a full fence before this returns
+            syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+            return;
+        }
+#endif
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+
+    std::vector<const void*>
+    Hazard_Pointer_Domain::collect_hazards(void) const
+    {
+        // Pairs with the fence in protect(): either the hazard is seen here, or that protect() sees
+        // the node already unlinked and tries again
+        this->heavy_fence();
+
+        std::vector<const void*> hazards;
+        hazards.reserve(this->record_count_.load(std::memory_order_relaxed) * SLOTS);
+        for (Record* record = this->records_.load(std::memory_order_acquire); record != nullptr; record = record->next)
+        {
+            for (const std::atomic<const void*>& hazard : record->hazards)
+            {
+                const void* pointer = hazard.load(std::memory_order_acquire);
+                if (pointer != nullptr)
+                {
+                    hazards.push_back(pointer);
+                }
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+        return hazards;
+    }
+
+
+    std::size_t
+    Hazard_Pointer_Domain::free_orphans(void)
+    {
+        // Deleters run unlocked, in case they register a participant of their own
+        std::vector<Retired> orphans;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex_, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                return 0;
+            }
+            orphans.swap(this->orphans_);
+        }
+
+        std::size_t freed = free_unprotected(orphans, this->collect_hazards());
+        this->garbage_.fetch_sub(freed, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->orphans_.insert(this->orphans_.end(), orphans.begin(), orphans.end());
+        this->orphan_count_.store(this->orphans_.size(), std::memory_order_relaxed);
+        return freed;
+    }
+
+
+    std::size_t
+    Hazard_Pointer_Domain::scan_threshold(void) const
+    {
+        // At least twice the slots, so every scan frees at least half of what it looks at
+        return std::max(this->batch_size_, 2 * SLOTS * this->record_count_.load(std::memory_order_relaxed));
+    }
+
+
+    std::size_t
+    Hazard_Pointer_Domain::free_unprotected(std::vector<Retired>& retired, const std::vector<const void*>& hazards)
+    {
+        std::vector<Retired> unprotected;
+        std::vector<Retired>::iterator kept = std::partition(retired.begin(), retired.end(), [&hazards](const Retired& node) {
+            return std::binary_search(hazards.begin(), hazards.end(), node.object);
+        });
+        unprotected.assign(kept, retired.end());
+        retired.erase(kept, retired.end());
+
+        // Removed before the deleters run, which may retire more
+        for (const Retired& node : unprotected)
+        {
+            node.deleter(node.object);
+        }
+        return unprotected.size();
+    }
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_HAZARD_POINTER_H
+#define PENGUIN_HAZARD_POINTER_H
+
+
+#include "Penguin_export.h"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+
+namespace Penguin
+{
+    // Hazard-pointer reclamation for lock-free structures. A thread registers through a Participant and
+    // publishes each node it is about to dereference in one of its hazard slots. A retired node is only
+    // deleted by a scan that finds it in no slot. Unlike Epoch_Domain a stalled reader only holds back
+    // the few nodes it has published, but every protect() costs a fence. Scans walk every slot, so they
+    // are made once the retired nodes outnumber the slots by a margin, which keeps them amortised
+    // constant per node and each participant's garbage bounded by about twice the slot count.
+    //
+    // With Fence::ASYMMETRIC, protect() only stops the compiler reordering and every scan has the
+    // kernel interrupt all of the process's running threads instead (Linux membarrier), which suits
+    // structures read far more often than they are changed. Where that is unavailable the domain falls
+    // back to ordinary fences, is_asymmetric() tells which is in use.
+    class Penguin_Export Hazard_Pointer_Domain
+    {
+    private:
+        struct Record;
+        struct Retired;
+
+    public:
+        enum class Fence
+        {
+            SYMMETRIC,  // a full fence in every protect()
+            ASYMMETRIC  // a compiler fence in protect(), membarrier in every scan
+        };
+
+        // Enough for the lists and queues that are the usual clients
+        static constexpr std::size_t SLOTS = 4;
+
+        // One thread's registration and its hazard slots, used by that thread alone
+        class Penguin_Export Participant
+        {
+        public:
+            explicit Participant(Hazard_Pointer_Domain& domain);
+            ~Participant(void);
+
+            // Loads source and publishes it in slot, repeating until source still holds what was
+            // published, after which it stays valid until the slot is cleared or reused
+            template <class T>
+            T*          protect(std::size_t slot, const std::atomic<T*>& source);
+            void        clear(std::size_t slot);
+            void        clear(void);
+
+            // Call once the object can no longer be reached through the structure
+            template <class T>
+            void        retire(T* object);
+            void        retire(void* object, void (*deleter)(void*));
+
+            // Scans every slot and frees this participant's nodes that none of them hold, returning how many
+            std::size_t reclaim(void);
+            std::size_t get_garbage_count(void) const;
+
+        private:
+            Participant(const Participant&) = delete;
+            Participant(Participant&&) = delete;
+
+        private:
+            Participant& operator = (const Participant&) = delete;
+            Participant& operator = (Participant&&) = delete;
+
+        private:
+            Hazard_Pointer_Domain&  domain_;
+            Record*                 record_;
+            std::vector<Retired>    retired_;
+            std::size_t             next_scan_;
+        };
+
+    public:
+        explicit Hazard_Pointer_Domain(Fence fence = Fence::SYMMETRIC, std::size_t batch_size = 64);
+
+        // Frees everything still retired. Every participant must have been destroyed.
+        ~Hazard_Pointer_Domain(void);
+
+        bool            is_asymmetric(void) const;
+
+        // Retired and not yet freed, across every participant and those already destroyed
+        std::size_t     get_garbage_count(void) const;
+        std::size_t     get_participant_count(void) const;
+
+        // Frees what destroyed participants left behind that no slot holds, returning how many
+        std::size_t     reclaim(void);
+
+    private:
+        Hazard_Pointer_Domain(const Hazard_Pointer_Domain&) = delete;
+        Hazard_Pointer_Domain(Hazard_Pointer_Domain&&) = delete;
+
+    private:
+        Hazard_Pointer_Domain& operator = (const Hazard_Pointer_Domain&) = delete;
+        Hazard_Pointer_Domain& operator = (Hazard_Pointer_Domain&&) = delete;
+
+    private:
+        // Records are reused by later participants and only freed with the domain
+        struct alignas(64) Record
+        {
+            std::atomic<const void*>    hazards[SLOTS] = {};
+            Record*                     next = nullptr;
+            bool                        in_use = false;
+        };
+
+        struct Retired
+        {
+            void*   object;
+            void    (*deleter)(void*);
+        };
+
+    private:
+        // Together these order a protect() against a scan, whichever fence is in use
+        void                        light_fence(void) const;
+        void                        heavy_fence(void) const;
+
+        // Sorted, so scans can binary search it
+        std::vector<const void*>    collect_hazards(void) const;
+        std::size_t                 free_orphans(void);
+        std::size_t                 scan_threshold(void) const;
+
+        // Frees the unprotected nodes and keeps the rest in retired, returning how many were freed
+        static std::size_t          free_unprotected(std::vector<Retired>& retired, const std::vector<const void*>& hazards);
+
+    private:
+        const bool                  asymmetric_;
+        const std::size_t           batch_size_;
+
+        std::atomic<Record*>        records_;
+        std::atomic<std::size_t>    record_count_;
+        std::atomic<std::size_t>    garbage_;
+        std::atomic<std::size_t>    orphan_count_;
+
+        // Held to register participants and to take over what they leave behind
+        mutable std::mutex          mutex_;
+        std::vector<Retired>        orphans_;
+        std::size_t                 participants_;
+    };
+
+
+    template <class T>
+    T*
+    Hazard_Pointer_Domain::Participant::protect(std::size_t slot, const std::atomic<T*>& source)
+    {
+        std::atomic<const void*>& hazard = this->record_->hazards[slot];
+        T* pointer = source.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            hazard.store(pointer, std::memory_order_relaxed);
+            this->domain_.light_fence();
+
+            // Still reachable after publishing, so any scan from here on sees the hazard
+            T* current = source.load(std::memory_order_acquire);
+            if (current == pointer)
+            {
+                return pointer;
+            }
+            pointer = current;
+        }
+    }
+
+
+    inline void
+    Hazard_Pointer_Domain::Participant::clear(std::size_t slot)
+    {
+        this->record_->hazards[slot].store(nullptr, std::memory_order_release);
+    }
+
+
+    inline void
+    Hazard_Pointer_Domain::Participant::clear(void)
+    {
+        for (std::size_t slot = 0; slot < SLOTS; ++slot)
+        {
+            this->clear(slot);
+        }
+    }
+
+
+    template <class T>
+    void
+    Hazard_Pointer_Domain::Participant::retire(T* object)
+    {
+        this->retire(object, [](void* retired) { delete static_cast<T*>(retired); });
+    }
+
+
+    inline std::size_t
+    Hazard_Pointer_Domain::Participant::get_garbage_count(void) const
+    {
+        return this->retired_.size();
+    }
+
+
+    inline void
+    Hazard_Pointer_Domain::light_fence(void) const
+    {
+        if (this->asymmetric_)
+        {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        }
+        else
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+}
+
+
+#endif // PENGUIN_HAZARD_POINTER_H
@@ -0,0 +1,313 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Hot_Library.h"
+#include "Spin_Wait.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <exception>
+
+
+#if defined(__linux__)
+# include <poll.h>
+# include <sys/eventfd.h>
+# include <sys/inotify.h>
+# include <unistd.h>
+#elif defined(_MSC_VER)
+# include <process.h>
+#endif
+
+
+namespace
+{
+    int current_process_id(void)
+    {
+#if defined(_MSC_VER)
+        return _getpid();
+#else
+        return static_cast<int>(getpid());
+#endif
+    }
+}
+
+
+namespace Penguin
+{
+    Hot_Library::Version::Version(const std::filesystem::path& shadow_path, const std::vector<std::string>& function_names, const Load_Options& options, std::uint64_t generation)
+        : library_(shadow_path, options)
+        , generation_(generation)
+    {
+        for (const std::string& function_name : function_names)
+        {
+            this->functions_.push_back(this->library_.find(function_name));
+        }
+    }
+
+
+    Hot_Library::Hot_Library(const std::filesystem::path& library_path, std::vector<std::string> function_names, Load_Options options)
+        : library_path_(library_path)
+        , function_names_(std::move(function_names))
+        , options_(std::move(options))
+        , slot_mask_(0)
+        , reader_index_(0)
+        , current_(nullptr)
+        , generation_(0)
+        , stop_descriptor_(-1)
+    {
+        // As many slots as processors, a power of two so a thread's slot is a mask
+        std::size_t processors = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        std::size_t slots = 1;
+        while (slots < processors)
+        {
+            slots *= 2;
+        }
+        this->slots_ = std::make_unique<Reader_Slot[]>(slots);
+        this->slot_mask_ = slots - 1;
+        for (std::size_t i = 0; i < slots; ++i)
+        {
+            this->slots_[i].readers[0].store(0, std::memory_order_relaxed);
+            this->slots_[i].readers[1].store(0, std::memory_order_relaxed);
+        }
+
+        this->reload();
+    }
+
+
+    Hot_Library::~Hot_Library(void)
+    {
+#if defined(__linux__)
+        if (this->watcher_.joinable())
+        {
+            // The watcher uses this object until it returns, so it must be joined. Writing to an eventfd
+            // only fails on a signal or when the counter would overflow, which one stop request cannot do.
+            std::uint64_t stop = 1;
+            ssize_t written = 0;
+            do
+            {
+                written = write(this->stop_descriptor_, &stop, sizeof(stop));
+            }
+            while (written < 0 && errno == EINTR);
+            if (written != sizeof(stop))
+            {
+                std::terminate();
+            }
+            this->watcher_.join();
+        }
+        if (this->stop_descriptor_ >= 0)
+        {
+            close(this->stop_descriptor_);
+        }
+#endif
+    }
+
+
+    std::string
+    Hot_Library::get_error(void) const
+    {
+        std::lock_guard<std::mutex> reload_guard(this->reload_mutex_);
+        return this->error_;
+    }
+
+
+    std::uint64_t
+    Hot_Library::get_generation(void) const
+    {
+        const Version* version = this->current_.load(std::memory_order_acquire);
+        return (version != nullptr ? version->get_generation() : 0);
+    }
+
+
+    bool
+    Hot_Library::reload(void)
+    {
+        std::lock_guard<std::mutex> reload_guard(this->reload_mutex_);
+
+        // dlopen hands back the already loaded library for a path it has seen, so every version is
+        // loaded from its own copy. The copy can go as soon as it is mapped.
+        std::error_code error;
+        std::filesystem::path shadow_path = this->make_shadow_copy(error);
+        if (error)
+        {
+            this->error_ = "Failed to copy " + this->library_path_.string() + " - " + error.message();
+            return false;
+        }
+        std::unique_ptr<Version> version = std::make_unique<Version>(shadow_path, this->function_names_, this->options_, this->generation_ + 1);
+        std::filesystem::remove(shadow_path, error);
+
+        if (version->library_.is_loaded() == false)
+        {
+            this->error_ = version->library_.get_error();
+            return false;
+        }
+        for (std::size_t i = 0; i < this->function_names_.size(); ++i)
+        {
+            if (version->functions_[i] == nullptr)
+            {
+                this->error_ = "Failed to find address for " + this->function_names_[i] + " in " + this->library_path_.string();
+                return false;
+            }
+        }
+
+        this->current_.store(version.get(), std::memory_order_seq_cst);
+        std::unique_ptr<Version> retired = std::move(this->current_owner_);
+        this->current_owner_ = std::move(version);
+        ++this->generation_;
+        this->error_.clear();
+
+        if (retired != nullptr)
+        {
+            this->wait_for_readers();
+        }
+        return true;
+    }
+
+
+    bool
+    Hot_Library::watch(void)
+    {
+#if defined(__linux__)
+        std::lock_guard<std::mutex> reload_guard(this->reload_mutex_);
+        if (this->watcher_.joinable())
+        {
+            return true;
+        }
+
+        // The directory rather than the file, deployments usually rename a new file over the old one
+        int watch_descriptor = inotify_init1(IN_CLOEXEC);
+        if (watch_descriptor < 0)
+        {
+            return false;
+        }
+        std::filesystem::path directory = this->library_path_.has_parent_path() ? this->library_path_.parent_path() : std::filesystem::path(".");
+        if (inotify_add_watch(watch_descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            close(watch_descriptor);
+            return false;
+        }
+        this->stop_descriptor_ = eventfd(0, EFD_CLOEXEC);
+        if (this->stop_descriptor_ < 0)
+        {
+            close(watch_descriptor);
+            return false;
+        }
+        this->watcher_ = std::thread(&Hot_Library::watch_loop, this, watch_descriptor);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+
+    std::filesystem::path
+    Hot_Library::make_shadow_copy(std::error_code& error)
+    {
+        // Keeps the prefix and extension, so the name needs no fixing when it is loaded
+        std::string shadow_name(this->library_path_.stem().string());
+        shadow_name += ".hot-" + std::to_string(current_process_id()) + "-" + std::to_string(reinterpret_cast<std::uintptr_t>(this));
+        shadow_name += "-" + std::to_string(this->generation_ + 1) + this->library_path_.extension().string();
+
+        // Next to the library rather than in the temporary directory, which may be mounted noexec. The
+        // watcher only reacts to the library's own name, so copies made here do not trigger reloads.
+        std::filesystem::path shadow_path = this->library_path_;
+        shadow_path.replace_filename(shadow_name);
+        std::filesystem::copy_file(this->library_path_, shadow_path, std::filesystem::copy_options::overwrite_existing, error);
+        return shadow_path;
+    }
+
+
+    void
+    Hot_Library::wait_for_readers(void)
+    {
+        // Readers that picked their counter before the last flip may still be counting on the other
+        // index, so it has to drain before it is reused, then the current index drains after the flip
+        std::uint32_t index = this->reader_index_.load(std::memory_order_relaxed);
+        this->wait_for_index(index ^ 1);
+        this->reader_index_.store(index ^ 1, std::memory_order_seq_cst);
+        this->wait_for_index(index);
+    }
+
+
+    void
+    Hot_Library::wait_for_index(std::uint32_t index) const
+    {
+        Spin_Wait spin_wait;
+        for (;;)
+        {
+            std::int64_t readers = 0;
+            for (std::size_t i = 0; i <= this->slot_mask_; ++i)
+            {
+                readers += this->slots_[i].readers[index].load(std::memory_order_seq_cst);
+            }
+            if (readers == 0)
+            {
+                return;
+            }
+            // Reloads are rare and readers can be slow, so stop spinning early and doze between checks
+            if (spin_wait.will_yield())
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            else
+            {
+                spin_wait.wait();
+            }
+        }
+    }
+
+
+    void
+    Hot_Library::watch_loop(int watch_descriptor)
+    {
+#if defined(__linux__)
+        std::string file_name(this->library_path_.filename().string());
+        alignas(struct inotify_event) char events[4096];
+        struct pollfd descriptors[2] = {
+            { watch_descriptor, POLLIN, 0 },
+            { this->stop_descriptor_, POLLIN, 0 }
+        };
+        for (;;)
+        {
+            if (poll(descriptors, 2, -1) < 0)
+            {
+                // A signal must not end the watch, only the stop descriptor does
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            if ((descriptors[1].revents & POLLIN) != 0)
+            {
+                break;
+            }
+            if ((descriptors[0].revents & POLLIN) == 0)
+            {
+                continue;
+            }
+            ssize_t length = read(watch_descriptor, events, sizeof(events));
+            bool changed = false;
+            for (ssize_t offset = 0; offset < length; )
+            {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(events + offset);
+                changed |= (event->len > 0 && file_name == event->name);
+                offset += sizeof(struct inotify_event) + event->len;
+            }
+            if (changed)
+            {
+                this->reload();
+            }
+        }
+        close(watch_descriptor);
+#endif
+    }
+
+
+    std::size_t
+    Hot_Library::next_thread_index(void)
+    {
+        // Handing out indices in turn spreads threads evenly over the slots
+        static std::atomic<std::size_t> next_index(0);
+        return next_index.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_HOT_LIBRARY_H
+#define PENGUIN_HOT_LIBRARY_H
+
+
+#include "Penguin_export.h"
+#include "Dynamic_Library.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace Penguin
+{
+    // A plugin that can be replaced while it is in use. Each version is loaded from a private copy of the
+    // file, made in the same directory, so the new one loads alongside the old, and it must resolve every
+    // function in the table before it is swapped in. Callers pin a version with a Reader. A swap waits for readers of the old
+    // version to leave, in the manner of sleepable RCU, and only then closes it. Long-lived readers
+    // therefore hold up reloads. Readers must not outlive the Hot_Library. Pinning takes no lock but is
+    // not a single load: it is a sequentially consistent increment of a reader counter followed by a
+    // load of the current version, and unpinning is a decrement. Counters are per processor and handed
+    // to threads in turn, so with more threads than processors several threads write the same counter
+    // and its cache line moves between them.
+    class Penguin_Export Hot_Library
+    {
+    public:
+        // One loaded version of the plugin, with its function table resolved
+        class Penguin_Export Version
+        {
+        public:
+            Version(const std::filesystem::path& shadow_path, const std::vector<std::string>& function_names, const Load_Options& options, std::uint64_t generation);
+
+            // In the order the names were given to the Hot_Library
+            Function_Address    get_function(std::size_t index) const;
+            std::uint64_t       get_generation(void) const;
+            const Library&      get_library(void) const;
+
+            template <class Signature>
+            Signature*          get(std::size_t index) const;
+
+        private:
+            Version(const Version&) = delete;
+            Version(Version&&) = delete;
+
+        private:
+            Version& operator = (const Version&) = delete;
+            Version& operator = (Version&&) = delete;
+
+        private:
+            friend class Hot_Library;
+
+        private:
+            Library                         library_;
+            std::vector<Function_Address>   functions_;
+            std::uint64_t                   generation_;
+        };
+
+        // Keeps the version that was current when it was created loaded until it is destroyed
+        class Penguin_Export Reader
+        {
+        public:
+            explicit Reader(const Hot_Library& hot_library);
+            ~Reader(void);
+
+            // False only while no version has ever loaded
+            explicit operator bool(void) const;
+            const Version& operator * (void) const;
+            const Version* operator -> (void) const;
+
+        private:
+            Reader(const Reader&) = delete;
+            Reader(Reader&&) = delete;
+
+        private:
+            Reader& operator = (const Reader&) = delete;
+            Reader& operator = (Reader&&) = delete;
+
+        private:
+            // Set by enter(), so declared first
+            const Version*              version_;
+            std::atomic<std::int64_t>&  readers_;
+        };
+
+    public:
+        // library_path names the file itself, no prefix or extension is added
+        Hot_Library(const std::filesystem::path& library_path, std::vector<std::string> function_names, Load_Options options = Load_Options());
+        ~Hot_Library(void);
+
+        // Why the last load failed, empty when it succeeded
+        std::string     get_error(void) const;
+
+        // Counts the versions swapped in, zero while none has loaded
+        std::uint64_t   get_generation(void) const;
+
+        // Loads the file as it is now and swaps it in, then waits for the old version's readers to leave
+        // and closes it. False, keeping the current version, if the new one fails to load or resolve.
+        bool            reload(void);
+
+        // Reloads whenever the file is rewritten or renamed into place, using inotify on its directory.
+        // False where that is unavailable; reload() still works.
+        bool            watch(void);
+
+    private:
+        Hot_Library(const Hot_Library&) = delete;
+        Hot_Library(Hot_Library&&) = delete;
+
+    private:
+        Hot_Library& operator = (const Hot_Library&) = delete;
+        Hot_Library& operator = (Hot_Library&&) = delete;
+
+    private:
+        // Counters for readers that started before and after the latest index flip
+        struct alignas(64) Reader_Slot
+        {
+            std::atomic<std::int64_t> readers[2];
+        };
+
+    private:
+        std::atomic<std::int64_t>&  enter(const Version*& version) const;
+        std::filesystem::path       make_shadow_copy(std::error_code& error);
+        void                        wait_for_readers(void);
+        void                        wait_for_index(std::uint32_t index) const;
+        void                        watch_loop(int watch_descriptor);
+
+        static std::size_t          next_thread_index(void);
+
+    private:
+        const std::filesystem::path     library_path_;
+        const std::vector<std::string>  function_names_;
+        const Load_Options              options_;
+
+        std::unique_ptr<Reader_Slot[]>  slots_;
+        std::size_t                     slot_mask_;
+        std::atomic<std::uint32_t>      reader_index_;
+        std::atomic<const Version*>     current_;
+
+        // Held for the whole of a reload
+        mutable std::mutex              reload_mutex_;
+        std::unique_ptr<Version>        current_owner_;
+        std::string                     error_;
+        std::uint64_t                   generation_;
+
+        std::thread                     watcher_;
+        int                             stop_descriptor_;
+    };
+
+
+    inline Function_Address
+    Hot_Library::Version::get_function(std::size_t index) const
+    {
+        return this->functions_[index];
+    }
+
+
+    inline std::uint64_t
+    Hot_Library::Version::get_generation(void) const
+    {
+        return this->generation_;
+    }
+
+
+    inline const Library&
+    Hot_Library::Version::get_library(void) const
+    {
+        return this->library_;
+    }
+
+
+    template <class Signature>
+    Signature*
+    Hot_Library::Version::get(std::size_t index) const
+    {
+        return reinterpret_cast<Signature*>(this->functions_[index]);
+    }
+
+
+    inline
+    Hot_Library::Reader::Reader(const Hot_Library& hot_library)
+        : version_(nullptr)
+        , readers_(hot_library.enter(this->version_))
+    {
+    }
+
+
+    inline
+    Hot_Library::Reader::~Reader(void)
+    {
+        this->readers_.fetch_sub(1, std::memory_order_release);
+    }
+
+
+    inline
+    Hot_Library::Reader::operator bool(void) const
+    {
+        return (this->version_ != nullptr);
+    }
+
+
+    inline const Hot_Library::Version&
+    Hot_Library::Reader::operator * (void) const
+    {
+        return *this->version_;
+    }
+
+
+    inline const Hot_Library::Version*
+    Hot_Library::Reader::operator -> (void) const
+    {
+        return this->version_;
+    }
+
+
+    inline std::atomic<std::int64_t>&
+    Hot_Library::enter(const Version*& version) const
+    {
+        thread_local const std::size_t thread_index = next_thread_index();
+        std::atomic<std::int64_t>& readers = this->slots_[thread_index & this->slot_mask_].readers[this->reader_index_.load(std::memory_order_relaxed)];
+
+        // Counted before the version is read; a swap stores the version before it counts readers, so
+        // either it waits for us or we see the new version
+        readers.fetch_add(1, std::memory_order_seq_cst);
+        version = this->current_.load(std::memory_order_seq_cst);
+        return readers;
+    }
+}
+
+
+#endif // PENGUIN_HOT_LIBRARY_H
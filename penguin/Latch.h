@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_LATCH_H
+#define PENGUIN_LATCH_H
+
+
+#include "Futex.h"
+#include <cassert>
+#include <cstdint>
+
+
+namespace Penguin
+{
+    // A single-use countdown: threads count down, and waiters are released once it reaches zero.
+    // Counting down is one atomic subtraction; the thread that reaches zero makes the only wake call.
+    class Latch
+    {
+    public:
+        explicit Latch(std::uint32_t count);
+
+        void count_down(std::uint32_t count = 1);
+        bool try_wait(void) const;
+        void wait(void);
+        void arrive_and_wait(std::uint32_t count = 1);
+
+    private:
+        Latch(const Latch&) = delete;
+        Latch(Latch&&) = delete;
+
+    private:
+        Latch& operator = (const Latch&) = delete;
+        Latch& operator = (Latch&&) = delete;
+
+    private:
+        Futex::_word_type counter_;
+    };
+
+
+    inline
+    Latch::Latch(std::uint32_t count)
+        : counter_(count)
+    {
+    }
+
+
+    inline void
+    Latch::count_down(std::uint32_t count)
+    {
+        std::uint32_t previous = this->counter_.fetch_sub(count, std::memory_order_acq_rel);
+        assert(previous >= count && "Latch counted down past zero");
+        if (previous == count)
+        {
+            Futex::wake_all(this->counter_);
+        }
+    }
+
+
+    inline bool
+    Latch::try_wait(void) const
+    {
+        return this->counter_.load(std::memory_order_acquire) == 0;
+    }
+
+
+    inline void
+    Latch::wait(void)
+    {
+        std::uint32_t counter = this->counter_.load(std::memory_order_acquire);
+        while (counter != 0)
+        {
+            Futex::wait_while(this->counter_, counter);
+            counter = this->counter_.load(std::memory_order_acquire);
+        }
+    }
+
+
+    inline void
+    Latch::arrive_and_wait(std::uint32_t count)
+    {
+        this->count_down(count);
+        this->wait();
+    }
+}
+
+
+#endif // PENGUIN_LATCH_H
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_LOCK_FREE_STACK_H
+#define PENGUIN_LOCK_FREE_STACK_H
+
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <utility>
+
+
+namespace Penguin
+{
+    // A Treiber stack. The top is a single word packing the top node's address with a tag that every
+    // successful push and pop changes, so a pop that read the top and was preempted while that node was
+    // popped and pushed back fails its compare-exchange rather than installing a stale next (ABA). On
+    // 64-bit targets addresses take the low 48 bits, which user space addresses fit on x86-64 and
+    // AArch64, and the tag the other 16, as Boost.Lockfree does. Popped nodes go on an internal free
+    // list of the same kind and are only freed with the stack, so a pop that loses the race still reads
+    // valid memory; the stack keeps its high-water mark of nodes. Nodes come from the allocator's memory
+    // resource, which must cope with every thread that pushes; an Arena only suits a stack filled by
+    // one thread at a time.
+    template <class T>
+    class Lock_Free_Stack
+    {
+    public:
+        using allocator_type = std::pmr::polymorphic_allocator<T>;
+
+    public:
+        Lock_Free_Stack(void);
+        explicit Lock_Free_Stack(const allocator_type& allocator);
+        ~Lock_Free_Stack(void);
+
+        allocator_type      get_allocator(void) const;
+
+        // Only a hint while other threads push and pop
+        bool                empty(void) const;
+
+        std::optional<T>    pop(void);
+        void                push(const T& value);
+        void                push(T&& value);
+
+        template <class... Args>
+        void                emplace(Args&&... args);
+
+    private:
+        Lock_Free_Stack(const Lock_Free_Stack&) = delete;
+        Lock_Free_Stack(Lock_Free_Stack&&) = delete;
+
+    private:
+        Lock_Free_Stack& operator = (const Lock_Free_Stack&) = delete;
+        Lock_Free_Stack& operator = (Lock_Free_Stack&&) = delete;
+
+    private:
+        struct Node
+        {
+            // Atomic because a pop that is about to lose its race may read it while the node is reused
+            std::atomic<Node*>  next{nullptr};
+            alignas(T) unsigned char storage[sizeof(T)];
+
+            T* value(void)
+            {
+                return std::launder(reinterpret_cast<T*>(this->storage));
+            }
+        };
+
+        using _word_type = std::uint64_t;
+
+    private:
+        static constexpr unsigned   POINTER_BITS = (sizeof(void*) == 8 ? 48 : 32);
+        static constexpr _word_type POINTER_MASK = (_word_type(1) << POINTER_BITS) - 1;
+        static constexpr _word_type TAG_INCREMENT = _word_type(1) << POINTER_BITS;
+
+    private:
+        // The tag of the word replaced, moved on by one
+        static _word_type   pack(Node* node, _word_type replaced);
+        static Node*        unpack(_word_type word);
+
+        static void         push_node(std::atomic<_word_type>& top, Node* node);
+        static Node*        pop_node(std::atomic<_word_type>& top);
+
+    private:
+        std::pmr::polymorphic_allocator<Node>   node_allocator_;
+        alignas(64) std::atomic<_word_type>     top_;
+        alignas(64) std::atomic<_word_type>     free_;
+    };
+
+
+    template <class T>
+    Lock_Free_Stack<T>::Lock_Free_Stack(void)
+        : top_(0)
+        , free_(0)
+    {
+    }
+
+
+    template <class T>
+    Lock_Free_Stack<T>::Lock_Free_Stack(const allocator_type& allocator)
+        : node_allocator_(allocator.resource())
+        , top_(0)
+        , free_(0)
+    {
+    }
+
+
+    template <class T>
+    Lock_Free_Stack<T>::~Lock_Free_Stack(void)
+    {
+        while (Node* node = pop_node(this->top_))
+        {
+            node->value()->~T();
+            node->~Node();
+            this->node_allocator_.deallocate(node, 1);
+        }
+        while (Node* node = pop_node(this->free_))
+        {
+            node->~Node();
+            this->node_allocator_.deallocate(node, 1);
+        }
+    }
+
+
+    template <class T>
+    typename Lock_Free_Stack<T>::allocator_type
+    Lock_Free_Stack<T>::get_allocator(void) const
+    {
+        return allocator_type(this->node_allocator_.resource());
+    }
+
+
+    template <class T>
+    bool
+    Lock_Free_Stack<T>::empty(void) const
+    {
+        return (unpack(this->top_.load(std::memory_order_relaxed)) == nullptr);
+    }
+
+
+    template <class T>
+    std::optional<T>
+    Lock_Free_Stack<T>::pop(void)
+    {
+        Node* node = pop_node(this->top_);
+        if (node == nullptr)
+        {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(*node->value()));
+        node->value()->~T();
+        push_node(this->free_, node);
+        return value;
+    }
+
+
+    template <class T>
+    void
+    Lock_Free_Stack<T>::push(const T& value)
+    {
+        this->emplace(value);
+    }
+
+
+    template <class T>
+    void
+    Lock_Free_Stack<T>::push(T&& value)
+    {
+        this->emplace(std::move(value));
+    }
+
+
+    template <class T>
+    template <class... Args>
+    void
+    Lock_Free_Stack<T>::emplace(Args&&... args)
+    {
+        Node* node = pop_node(this->free_);
+        if (node == nullptr)
+        {
+            node = new (this->node_allocator_.allocate(1)) Node();
+        }
+        try
+        {
+            new (node->storage) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            push_node(this->free_, node);
+            throw;
+        }
+        push_node(this->top_, node);
+    }
+
+
+    template <class T>
+    typename Lock_Free_Stack<T>::_word_type
+    Lock_Free_Stack<T>::pack(Node* node, _word_type replaced)
+    {
+        _word_type address = reinterpret_cast<std::uintptr_t>(node);
+        assert((address & ~POINTER_MASK) == 0);
+        return ((replaced & ~POINTER_MASK) + TAG_INCREMENT) | address;
+    }
+
+
+    template <class T>
+    typename Lock_Free_Stack<T>::Node*
+    Lock_Free_Stack<T>::unpack(_word_type word)
+    {
+        return reinterpret_cast<Node*>(static_cast<std::uintptr_t>(word & POINTER_MASK));
+    }
+
+
+    template <class T>
+    void
+    Lock_Free_Stack<T>::push_node(std::atomic<_word_type>& top, Node* node)
+    {
+        _word_type current = top.load(std::memory_order_relaxed);
+        do
+        {
+            node->next.store(unpack(current), std::memory_order_relaxed);
+        }
+        while (!top.compare_exchange_weak(current, pack(node, current), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+
+    template <class T>
+    typename Lock_Free_Stack<T>::Node*
+    Lock_Free_Stack<T>::pop_node(std::atomic<_word_type>& top)
+    {
+        _word_type current = top.load(std::memory_order_acquire);
+        for (;;)
+        {
+            Node* node = unpack(current);
+            if (node == nullptr)
+            {
+                return nullptr;
+            }
+
+            // Possibly stale if the node was popped meanwhile, in which case the tag has moved on too
+            Node* next = node->next.load(std::memory_order_relaxed);
+            if (top.compare_exchange_weak(current, pack(next, current), std::memory_order_acquire, std::memory_order_acquire))
+            {
+                return node;
+            }
+        }
+    }
+}
+
+
+#endif // PENGUIN_LOCK_FREE_STACK_H
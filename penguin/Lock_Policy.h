@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_LOCK_POLICY_H
+#define PENGUIN_LOCK_POLICY_H
+
+
+#include "Adaptive_Mutex.h"
+#include "Futex_Condition_Variable.h"
+#include "Profiled_Mutex.h"
+#include "Ticket_Lock.h"
+#include <condition_variable>
+#include <mutex>
+
+
+namespace Penguin
+{
+    // Pairs a mutex with a condition variable that can wait on it, for Penguin::Basic_Monitor and
+    // everything built on it
+
+    // The default, std::mutex parks quickly and suits longer critical sections
+    struct Std_Mutex_Policy
+    {
+        using _mutex_type               = std::mutex;
+        using _condition_variable_type  = std::condition_variable;
+    };
+
+
+    // Spins through short contention before parking, for critical sections of around 100ns
+    struct Adaptive_Mutex_Policy
+    {
+        using _mutex_type               = Penguin::Adaptive_Mutex;
+        using _condition_variable_type  = std::condition_variable_any;
+    };
+
+
+    // The adaptive mutex with a condition variable whose notify_all requeues waiters onto the mutex
+    // rather than waking them all at once, for monitors with many waiters
+    struct Futex_Policy
+    {
+        using _mutex_type               = Penguin::Adaptive_Mutex;
+        using _condition_variable_type  = Penguin::Futex_Condition_Variable;
+    };
+
+
+    // FIFO spinning, for very short critical sections with no more threads than processors
+    struct Ticket_Lock_Policy
+    {
+        using _mutex_type               = Penguin::Ticket_Lock;
+        using _condition_variable_type  = std::condition_variable_any;
+    };
+
+
+    // Any of the above with contention statistics recorded in Penguin::Lock_Profiler
+    template <class Policy>
+    struct Profiled_Policy
+    {
+        using _mutex_type               = Penguin::Profiled_Mutex<typename Policy::_mutex_type>;
+        using _condition_variable_type  = std::condition_variable_any;
+    };
+
+
+#if defined(PENGUIN_MONITOR_PROFILING)
+    // Built with PENGUIN_MONITOR_PROFILING, so Penguin::Monitor and its users report contention
+    using Default_Lock_Policy = Profiled_Policy<Std_Mutex_Policy>;
+#else
+    using Default_Lock_Policy = Std_Mutex_Policy;
+#endif
+}
+
+
+#endif // PENGUIN_LOCK_POLICY_H
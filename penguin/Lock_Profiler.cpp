@@ -0,0 +1,161 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Lock_Profiler.h"
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+
+namespace Penguin
+{
+    namespace
+    {
+        struct Record
+        {
+            std::string                 name;
+            Lock_Profiler::Counters     counters;
+        };
+
+
+        struct Registry
+        {
+            // A deque never moves its elements, so references handed out stay valid
+            std::mutex          mutex;
+            std::deque<Record>  records;
+        };
+
+
+        Registry& get_registry(void)
+        {
+            // Never destroyed, locks in other static objects may still report during shutdown
+            static Registry* registry = new Registry();
+            return *registry;
+        }
+
+
+        Lock_Profiler::_duration_type to_duration(const std::atomic<std::uint64_t>& nanoseconds)
+        {
+            return Lock_Profiler::_duration_type(static_cast<Lock_Profiler::_duration_type::rep>(nanoseconds.load(std::memory_order_relaxed)));
+        }
+
+
+        double to_microseconds(Lock_Profiler::_duration_type duration)
+        {
+            return std::chrono::duration<double, std::micro>(duration).count();
+        }
+    }
+
+
+    Lock_Profiler::Counters&
+    Lock_Profiler::get_counters(const char* name)
+    {
+        assert(name != nullptr);
+        std::string key(name);
+        Registry& registry = get_registry();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        for (Record& record : registry.records)
+        {
+            if (record.name == key)
+            {
+                return record.counters;
+            }
+        }
+        registry.records.emplace_back();
+        registry.records.back().name = key;
+        return registry.records.back().counters;
+    }
+
+
+    std::vector<Lock_Profiler::Entry>
+    Lock_Profiler::snapshot(void)
+    {
+        std::vector<Entry> entries;
+        Registry& registry = get_registry();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        for (const Record& record : registry.records)
+        {
+            Entry entry;
+            entry.name = record.name;
+            entry.acquisitions = record.counters.acquisitions.load(std::memory_order_relaxed);
+            entry.contended_acquisitions = record.counters.contended_acquisitions.load(std::memory_order_relaxed);
+            entry.total_wait = to_duration(record.counters.total_wait_ns);
+            entry.max_wait = to_duration(record.counters.max_wait_ns);
+            entry.total_hold = to_duration(record.counters.total_hold_ns);
+            entry.max_hold = to_duration(record.counters.max_hold_ns);
+            entries.push_back(entry);
+        }
+        return entries;
+    }
+
+
+    std::vector<Lock_Profiler::Entry>
+    Lock_Profiler::top_contended(std::size_t count)
+    {
+        std::vector<Entry> entries = snapshot();
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            if (a.total_wait != b.total_wait)
+            {
+                return a.total_wait > b.total_wait;
+            }
+            return a.contended_acquisitions > b.contended_acquisitions;
+        });
+        if (entries.size() > count)
+        {
+            entries.resize(count);
+        }
+        return entries;
+    }
+
+
+    void
+    Lock_Profiler::reset(void)
+    {
+        Registry& registry = get_registry();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        for (Record& record : registry.records)
+        {
+            record.counters.acquisitions.store(0, std::memory_order_relaxed);
+            record.counters.contended_acquisitions.store(0, std::memory_order_relaxed);
+            record.counters.total_wait_ns.store(0, std::memory_order_relaxed);
+            record.counters.max_wait_ns.store(0, std::memory_order_relaxed);
+            record.counters.total_hold_ns.store(0, std::memory_order_relaxed);
+            record.counters.max_hold_ns.store(0, std::memory_order_relaxed);
+        }
+    }
+
+
+    std::string
+    Lock_Profiler::report_text(std::size_t count)
+    {
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(3);
+        stream << std::left << std::setw(32) << "Lock" << std::right
+            << std::setw(14) << "Acquisitions"
+            << std::setw(12) << "Contended"
+            << std::setw(16) << "Wait(us)"
+            << std::setw(14) << "Max wait(us)"
+            << std::setw(16) << "Hold(us)"
+            << std::setw(14) << "Max hold(us)"
+            << '\n';
+        for (const Entry& entry : top_contended(count))
+        {
+            if (entry.acquisitions == 0)
+            {
+                continue;
+            }
+            stream << std::left << std::setw(32) << entry.name << std::right
+                << std::setw(14) << entry.acquisitions
+                << std::setw(12) << entry.contended_acquisitions
+                << std::setw(16) << to_microseconds(entry.total_wait)
+                << std::setw(14) << to_microseconds(entry.max_wait)
+                << std::setw(16) << to_microseconds(entry.total_hold)
+                << std::setw(14) << to_microseconds(entry.max_hold)
+                << '\n';
+        }
+        return stream.str();
+    }
+}
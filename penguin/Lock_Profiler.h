@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_LOCK_PROFILER_H
+#define PENGUIN_LOCK_PROFILER_H
+
+
+#include "Penguin_export.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace Penguin
+{
+    // Process-wide contention statistics for profiled locks, keyed by the name each lock is given.
+    // Locks sharing a name share one record, so every instance of a class can report as one. Records
+    // live until the process exits, which keeps the hot path free of reference counting.
+    class Penguin_Export Lock_Profiler
+    {
+    public:
+        using _duration_type = std::chrono::nanoseconds;
+
+        // Updated with relaxed atomics by the locks themselves. A cache line each, so busy locks with
+        // different names do not share one.
+        struct alignas(64) Counters
+        {
+            std::atomic<std::uint64_t> acquisitions{0};
+            std::atomic<std::uint64_t> contended_acquisitions{0};
+            std::atomic<std::uint64_t> total_wait_ns{0};
+            std::atomic<std::uint64_t> max_wait_ns{0};
+            std::atomic<std::uint64_t> total_hold_ns{0};
+            std::atomic<std::uint64_t> max_hold_ns{0};
+        };
+
+        struct Entry
+        {
+            std::string     name;
+            std::uint64_t   acquisitions = 0;
+            std::uint64_t   contended_acquisitions = 0;
+            _duration_type  total_wait = _duration_type::zero();
+            _duration_type  max_wait = _duration_type::zero();
+            _duration_type  total_hold = _duration_type::zero();
+            _duration_type  max_hold = _duration_type::zero();
+        };
+
+    public:
+        // The record for name, created on first use. Locks without a name are not profiled.
+        static Counters& get_counters(const char* name);
+
+        static std::vector<Entry> snapshot(void);
+
+        // Entries with the most total wait first, then the most contended acquisitions
+        static std::vector<Entry> top_contended(std::size_t count);
+
+        static void reset(void);
+
+        static std::string report_text(std::size_t count = 10);
+
+        // Raises maximum to value if it is larger, without a lock
+        static void update_maximum(std::atomic<std::uint64_t>& maximum, std::uint64_t value);
+
+    private:
+        Lock_Profiler(void) = delete;
+    };
+
+
+    inline void
+    Lock_Profiler::update_maximum(std::atomic<std::uint64_t>& maximum, std::uint64_t value)
+    {
+        std::uint64_t current = maximum.load(std::memory_order_relaxed);
+        while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+
+#endif // PENGUIN_LOCK_PROFILER_H
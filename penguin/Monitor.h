@@ -6,6 +6,7 @@
 
 
 #include "Penguin_export.h"
+#include "Lock_Policy.h"
 #include <cassert>
 #include <mutex>
 #include <condition_variable>
@@ -13,15 +14,20 @@
 
 namespace Penguin
 {
-    class Penguin_Export Monitor
+    template <class Policy>
+    class Basic_Monitor
     {
     public:
-        using _mutex_type               = std::mutex;
-        using _condition_variable_type  = std::condition_variable;
+        using _policy_type              = Policy;
+        using _mutex_type               = typename Policy::_mutex_type;
+        using _condition_variable_type  = typename Policy::_condition_variable_type;
         using _guard_type               = std::unique_lock<_mutex_type>;
 
-        Monitor(void);
-        virtual ~Monitor(void);
+        Basic_Monitor(void);
+
+        // Profiled policies report under name, other policies ignore it
+        explicit Basic_Monitor(const char* name);
+        virtual ~Basic_Monitor(void);
 
         void notify_one(void) noexcept;
         void notify_all(void) noexcept;
@@ -47,61 +53,151 @@ namespace Penguin
 
     protected:
 
+    private:
+        template <class Mutex>
+        static void set_mutex_name(Mutex& mutex, const char* name);
+
+        template <class Mutex>
+        static void set_mutex_name(Profiled_Mutex<Mutex>& mutex, const char* name);
+
     private:
         mutable _mutex_type         mutex_;
         _condition_variable_type    condition_variable_;
 
-        Monitor(const Monitor& other) = delete;
-        Monitor& operator = (const Monitor& other) = delete;
+        Basic_Monitor(const Basic_Monitor& other) = delete;
+        Basic_Monitor& operator = (const Basic_Monitor& other) = delete;
 
-        Monitor(Monitor&& other) = delete;
-        Monitor& operator = (Monitor&& other) = delete;
+        Basic_Monitor(Basic_Monitor&& other) = delete;
+        Basic_Monitor& operator = (Basic_Monitor&& other) = delete;
     };
 
 
+    using Monitor = Basic_Monitor<Default_Lock_Policy>;
+
+
+    template <class Policy>
+    Basic_Monitor<Policy>::Basic_Monitor(void)
+    {
+    }
+
+
+    template <class Policy>
+    Basic_Monitor<Policy>::Basic_Monitor(const char* name)
+    {
+        set_mutex_name(this->mutex_, name);
+    }
+
+
+    template <class Policy>
+    Basic_Monitor<Policy>::~Basic_Monitor(void)
+    {
+    }
+
+
+    template <class Policy>
+    void
+    Basic_Monitor<Policy>::notify_one(void) noexcept
+    {
+        this->condition_variable_.notify_one();
+    }
+
+
+    template <class Policy>
+    void
+    Basic_Monitor<Policy>::notify_all(void) noexcept
+    {
+        this->condition_variable_.notify_all();
+    }
+
+
+    template <class Policy>
+    void
+    Basic_Monitor<Policy>::wait(_guard_type& guard)
+    {
+        assert(guard.owns_lock());
+        this->condition_variable_.wait(guard);
+    }
+
+
+    template <class Policy>
     template <class Predicate>
     void
-    Monitor::wait(_guard_type& guard, Predicate predicate)
+    Basic_Monitor<Policy>::wait(_guard_type& guard, Predicate predicate)
     {
         assert(guard.owns_lock());
         this->condition_variable_.wait(guard, predicate);
     }
 
 
+    template <class Policy>
     template <class Rep, class Period>
     std::cv_status
-    Monitor::wait_for(_guard_type& guard, const std::chrono::duration<Rep, Period>& rel_time)
+    Basic_Monitor<Policy>::wait_for(_guard_type& guard, const std::chrono::duration<Rep, Period>& rel_time)
     {
         assert(guard.owns_lock());
         return this->condition_variable_.wait_for(guard, rel_time);
     }
 
 
+    template <class Policy>
     template <class Rep, class Period, class Predicate>
     bool
-    Monitor::wait_for(_guard_type& guard, const std::chrono::duration<Rep, Period>& rel_time, Predicate predicate)
+    Basic_Monitor<Policy>::wait_for(_guard_type& guard, const std::chrono::duration<Rep, Period>& rel_time, Predicate predicate)
     {
         assert(guard.owns_lock());
         return this->condition_variable_.wait_for(guard, rel_time, predicate);
     }
 
 
+    template <class Policy>
     template <class Clock, class Duration>
     std::cv_status
-    Monitor::wait_until(_guard_type& guard, const std::chrono::time_point<Clock, Duration>& timeout_time)
+    Basic_Monitor<Policy>::wait_until(_guard_type& guard, const std::chrono::time_point<Clock, Duration>& timeout_time)
     {
         assert(guard.owns_lock());
         return this->condition_variable_.wait_until(guard, timeout_time);
     }
 
 
+    template <class Policy>
     template <class Clock, class Duration, class Predicate>
     bool
-    Monitor::wait_until(_guard_type& guard, const std::chrono::time_point<Clock, Duration>& timeout_time, Predicate predicate)
+    Basic_Monitor<Policy>::wait_until(_guard_type& guard, const std::chrono::time_point<Clock, Duration>& timeout_time, Predicate predicate)
     {
         assert(guard.owns_lock());
         return this->condition_variable_.wait_until(guard, timeout_time, predicate);
     }
+
+
+    template <class Policy>
+    Basic_Monitor<Policy>::operator _mutex_type &() const
+    {
+        return this->mutex_;
+    }
+
+
+    template <class Policy>
+    template <class Mutex>
+    void
+    Basic_Monitor<Policy>::set_mutex_name(Mutex&, const char*)
+    {
+    }
+
+
+    template <class Policy>
+    template <class Mutex>
+    void
+    Basic_Monitor<Policy>::set_mutex_name(Profiled_Mutex<Mutex>& mutex, const char* name)
+    {
+        mutex.set_name(name);
+    }
+
+
+    // Instantiated once in the library for the policies it ships
+    extern template class Penguin_Export Basic_Monitor<Std_Mutex_Policy>;
+    extern template class Penguin_Export Basic_Monitor<Adaptive_Mutex_Policy>;
+    extern template class Penguin_Export Basic_Monitor<Futex_Policy>;
+    extern template class Penguin_Export Basic_Monitor<Ticket_Lock_Policy>;
 }
 
 
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_OBJECT_POOL_H
+#define PENGUIN_OBJECT_POOL_H
+
+
+#include "Adaptive_Mutex.h"
+#include "Lock_Free_Stack.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+
+namespace Penguin
+{
+    // Recycles objects, typically large buffers, between threads. Each thread keeps to one of several
+    // cache-line sized slots holding two magazines, small stacks of pooled objects, so acquire() and
+    // release() usually take an uncontended lock on a line no other thread touches. When both
+    // magazines are empty or both full the slot trades one with a depot of full or empty magazines, a
+    // Lock_Free_Stack, so the shared state is touched once per magazine_size objects. Objects made
+    // while the pool is empty are default-initialised and handed out as they were released, the pool
+    // never resets them. Everything acquired must be released to the pool before it is destroyed.
+    template <class T>
+    class Object_Pool
+    {
+    public:
+        explicit Object_Pool(std::size_t magazine_size = 32);
+        ~Object_Pool(void);
+
+        T*          acquire(void);
+        void        release(T* object);
+
+        // Objects the pool has had to make because none were pooled
+        std::size_t get_created_count(void) const;
+
+    private:
+        Object_Pool(const Object_Pool&) = delete;
+        Object_Pool(Object_Pool&&) = delete;
+
+    private:
+        Object_Pool& operator = (const Object_Pool&) = delete;
+        Object_Pool& operator = (Object_Pool&&) = delete;
+
+    private:
+        using _magazine_type = std::vector<T*>;
+
+        struct alignas(64) Slot
+        {
+            Adaptive_Mutex  mutex;
+            _magazine_type  loaded;
+            _magazine_type  previous;
+        };
+
+    private:
+        _magazine_type      make_magazine(_magazine_type magazine) const;
+        Slot&               slot(void);
+
+        static std::size_t  next_thread_index(void);
+
+    private:
+        const std::size_t                       magazine_size_;
+        std::unique_ptr<Slot[]>                 slots_;
+        std::size_t                             slot_mask_;
+        Lock_Free_Stack<_magazine_type>         full_;
+        Lock_Free_Stack<_magazine_type>         empty_;
+        std::atomic<std::size_t>                created_;
+    };
+
+
+    template <class T>
+    Object_Pool<T>::Object_Pool(std::size_t magazine_size)
+        : magazine_size_(std::max<std::size_t>(magazine_size, 1))
+        , created_(0)
+    {
+        // A power of two, so a thread's slot is a mask rather than a division
+        std::size_t processors = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        std::size_t slots = 1;
+        while (slots < processors)
+        {
+            slots *= 2;
+        }
+        this->slots_ = std::make_unique<Slot[]>(slots);
+        this->slot_mask_ = slots - 1;
+        for (std::size_t i = 0; i < slots; ++i)
+        {
+            this->slots_[i].loaded.reserve(this->magazine_size_);
+            this->slots_[i].previous.reserve(this->magazine_size_);
+        }
+    }
+
+
+    template <class T>
+    Object_Pool<T>::~Object_Pool(void)
+    {
+        for (std::size_t i = 0; i <= this->slot_mask_; ++i)
+        {
+            for (T* object : this->slots_[i].loaded)
+            {
+                delete object;
+            }
+            for (T* object : this->slots_[i].previous)
+            {
+                delete object;
+            }
+        }
+        while (std::optional<_magazine_type> magazine = this->full_.pop())
+        {
+            for (T* object : *magazine)
+            {
+                delete object;
+            }
+        }
+    }
+
+
+    template <class T>
+    T*
+    Object_Pool<T>::acquire(void)
+    {
+        Slot& slot = this->slot();
+        {
+            std::lock_guard<Adaptive_Mutex> guard(slot.mutex);
+            if (slot.loaded.empty())
+            {
+                if (!slot.previous.empty())
+                {
+                    slot.loaded.swap(slot.previous);
+                }
+                else if (std::optional<_magazine_type> full = this->full_.pop())
+                {
+                    // Both magazines are empty, trade one for a full one from the depot
+                    slot.loaded.swap(*full);
+                    this->empty_.push(std::move(*full));
+                }
+            }
+            if (!slot.loaded.empty())
+            {
+                T* object = slot.loaded.back();
+                slot.loaded.pop_back();
+                return object;
+            }
+        }
+
+        this->created_.fetch_add(1, std::memory_order_relaxed);
+        return new T;
+    }
+
+
+    template <class T>
+    void
+    Object_Pool<T>::release(T* object)
+    {
+        Slot& slot = this->slot();
+        std::lock_guard<Adaptive_Mutex> guard(slot.mutex);
+        if (slot.loaded.size() == this->magazine_size_)
+        {
+            if (slot.previous.size() == this->magazine_size_)
+            {
+                // Both magazines are full, send one to the depot and take an empty one in its place
+                this->full_.push(std::move(slot.previous));
+                slot.previous = this->make_magazine(this->empty_.pop().value_or(_magazine_type()));
+            }
+            slot.loaded.swap(slot.previous);
+        }
+        slot.loaded.push_back(object);
+    }
+
+
+    template <class T>
+    std::size_t
+    Object_Pool<T>::get_created_count(void) const
+    {
+        return this->created_.load(std::memory_order_relaxed);
+    }
+
+
+    template <class T>
+    typename Object_Pool<T>::_magazine_type
+    Object_Pool<T>::make_magazine(_magazine_type magazine) const
+    {
+        magazine.clear();
+        magazine.reserve(this->magazine_size_);
+        return magazine;
+    }
+
+
+    template <class T>
+    typename Object_Pool<T>::Slot&
+    Object_Pool<T>::slot(void)
+    {
+        thread_local const std::size_t thread_index = next_thread_index();
+        return this->slots_[thread_index & this->slot_mask_];
+    }
+
+
+    template <class T>
+    std::size_t
+    Object_Pool<T>::next_thread_index(void)
+    {
+        // Handing out indices in turn spreads threads evenly over the slots
+        static std::atomic<std::size_t> next_index(0);
+        return next_index.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+#endif // PENGUIN_OBJECT_POOL_H
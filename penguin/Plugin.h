@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_PLUGIN_H
+#define PENGUIN_PLUGIN_H
+
+
+#include "Dynamic_Library.h"
+#include "Version.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+// Exports a plugin's entry point, Penguin_Export is only for Penguin itself
+#if defined(_MSC_VER)
+# define PENGUIN_PLUGIN_EXPORT __declspec(dllexport)
+#else
+# define PENGUIN_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+
+namespace Penguin
+{
+    // A plugin exports one C function, named plugin_entry_point_name, that returns a table of function
+    // pointers. The table is a struct whose first member is a Plugin_Header:
+    //
+    //     struct Codec_Table
+    //     {
+    //         Penguin::Plugin_Header header;
+    //         int (*encode)(const char* input, char* output);
+    //         int (*decode)(const char* input, char* output);
+    //     };
+    //
+    //     extern "C" PENGUIN_PLUGIN_EXPORT const Penguin::Plugin_Header* penguin_plugin_entry_point(void)
+    //     {
+    //         static const Codec_Table table = { Penguin::make_plugin_header<Codec_Table>("codec", 1), &encode, &decode };
+    //         return &table.header;
+    //     }
+    //
+    // The host resolves and validates it once with get_plugin_table() and calls through the struct, one
+    // symbol lookup instead of one per function. Fields have fixed widths so the layout is the same
+    // whichever compiler built each side.
+    struct Plugin_Header
+    {
+        std::uint32_t   magic;
+        std::uint32_t   header_size;
+
+        // Of the whole table, a plugin built against a later interface may have appended functions
+        std::uint32_t   table_size;
+        std::uint32_t   table_version;
+        const char*     table_name;
+
+        // The Penguin the plugin was built against
+        std::int32_t    penguin_major_version;
+        std::int32_t    penguin_minor_version;
+        std::int32_t    penguin_patch_version;
+    };
+
+
+    enum class Plugin_Status
+    {
+        OK,
+        NOT_LOADED,                 // The library itself failed to load
+        NO_ENTRY_POINT,             // Not a plugin, or not one of ours
+        BAD_HEADER,                 // The entry point returned something that is not a Plugin_Header
+        WRONG_TABLE,                // A plugin for some other interface
+        TABLE_VERSION_MISMATCH,
+        TABLE_TOO_SMALL,
+        PENGUIN_VERSION_MISMATCH
+    };
+
+
+    template <class Table>
+    struct Plugin_Table
+    {
+        const Table*    table;
+        Plugin_Status   status;
+
+        explicit operator bool(void) const { return (this->table != nullptr); }
+        const Table* operator -> (void) const { return this->table; }
+    };
+
+
+    using Plugin_Entry_Point = const Plugin_Header* (*)(void);
+
+    constexpr char          plugin_entry_point_name[] = "penguin_plugin_entry_point";
+    constexpr std::uint32_t plugin_magic = 0x50474E50; // "PNGP"
+
+
+    template <class Table>
+    constexpr Plugin_Header make_plugin_header(const char* table_name, std::uint32_t table_version);
+
+    // Penguin releases are compatible within a major version, and before 1.0 within a minor version
+    constexpr bool is_compatible_penguin_version(std::int32_t major_version, std::int32_t minor_version);
+
+    Plugin_Status check_plugin_header(const Plugin_Header* header, const char* table_name, std::uint32_t table_version, std::size_t table_size);
+
+    // The table stays valid for as long as the library is loaded
+    template <class Table>
+    Plugin_Table<Table> get_plugin_table(const Library& library, const char* table_name, std::uint32_t table_version);
+
+
+    template <class Table>
+    constexpr Plugin_Header
+    make_plugin_header(const char* table_name, std::uint32_t table_version)
+    {
+        static_assert(std::is_standard_layout<Table>::value, "A plugin table must be a plain struct");
+        static_assert(offsetof(Table, header) == 0, "A plugin table must start with its Plugin_Header");
+        return Plugin_Header{
+            plugin_magic,
+            static_cast<std::uint32_t>(sizeof(Plugin_Header)),
+            static_cast<std::uint32_t>(sizeof(Table)),
+            table_version,
+            table_name,
+            static_cast<std::int32_t>(PENGUIN_MAJOR_VERSION),
+            static_cast<std::int32_t>(PENGUIN_MINOR_VERSION),
+            static_cast<std::int32_t>(PENGUIN_PATCH_VERSION)
+        };
+    }
+
+
+    constexpr bool
+    is_compatible_penguin_version(std::int32_t major_version, std::int32_t minor_version)
+    {
+        return (major_version == PENGUIN_MAJOR_VERSION && (PENGUIN_MAJOR_VERSION != 0 || minor_version == PENGUIN_MINOR_VERSION));
+    }
+
+
+    inline Plugin_Status
+    check_plugin_header(const Plugin_Header* header, const char* table_name, std::uint32_t table_version, std::size_t table_size)
+    {
+        if (header == nullptr || header->magic != plugin_magic || header->header_size != sizeof(Plugin_Header))
+        {
+            return Plugin_Status::BAD_HEADER;
+        }
+        if (header->table_name == nullptr || std::strcmp(header->table_name, table_name) != 0)
+        {
+            return Plugin_Status::WRONG_TABLE;
+        }
+        if (header->table_version != table_version)
+        {
+            return Plugin_Status::TABLE_VERSION_MISMATCH;
+        }
+        if (header->table_size < table_size)
+        {
+            return Plugin_Status::TABLE_TOO_SMALL;
+        }
+        if (!is_compatible_penguin_version(header->penguin_major_version, header->penguin_minor_version))
+        {
+            return Plugin_Status::PENGUIN_VERSION_MISMATCH;
+        }
+        return Plugin_Status::OK;
+    }
+
+
+    template <class Table>
+    Plugin_Table<Table>
+    get_plugin_table(const Library& library, const char* table_name, std::uint32_t table_version)
+    {
+        if (library.is_loaded() == false)
+        {
+            return { nullptr, Plugin_Status::NOT_LOADED };
+        }
+        Plugin_Entry_Point entry_point = reinterpret_cast<Plugin_Entry_Point>(library.find(plugin_entry_point_name));
+        if (entry_point == nullptr)
+        {
+            return { nullptr, Plugin_Status::NO_ENTRY_POINT };
+        }
+        const Plugin_Header* header = entry_point();
+        Plugin_Status status = check_plugin_header(header, table_name, table_version, sizeof(Table));
+        return { (status == Plugin_Status::OK ? reinterpret_cast<const Table*>(header) : nullptr), status };
+    }
+}
+
+
+#endif // PENGUIN_PLUGIN_H
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_RATE_LIMITER_H
+#define PENGUIN_RATE_LIMITER_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <thread>
+
+
+namespace Penguin
+{
+    // A token bucket that refills lazily from the monotonic clock, so no thread has to release permits
+    // on a timer. The bucket is kept as the time at which it would next be full again (the generic cell
+    // rate algorithm), a single atomic updated with compare-exchange, so uncontended acquires never lock.
+    //
+    // Blocking and timed acquires reserve their tokens first and then sleep until the reservation
+    // matures. Waiters are served in reservation order and the long-run rate does not drift with how
+    // late the scheduler wakes them.
+    class Rate_Limiter
+    {
+    public:
+        using _clock_type = std::chrono::steady_clock;
+
+    public:
+        // Up to burst tokens can be taken at once after an idle period; the bucket starts full
+        explicit Rate_Limiter(double permits_per_second, std::uint64_t burst = 1);
+
+        void            acquire(std::uint64_t permits = 1);
+
+        // Never succeeds for more permits than the burst size
+        bool            try_acquire(std::uint64_t permits = 1);
+
+        // Fail at once when the permits could not be ready before the timeout
+        template <class Rep, class Period>
+        std::cv_status  try_acquire_for(const std::chrono::duration<Rep, Period>& rel_time, std::uint64_t permits = 1);
+
+        template <class Clock, class Duration>
+        std::cv_status  try_acquire_until(const std::chrono::time_point<Clock, Duration>& timeout_time, std::uint64_t permits = 1);
+
+        std::uint64_t   get_available(void) const;
+        std::uint64_t   get_burst(void) const;
+        double          get_rate(void) const;
+
+    private:
+        Rate_Limiter(const Rate_Limiter&) = delete;
+        Rate_Limiter(Rate_Limiter&&) = delete;
+
+    private:
+        Rate_Limiter& operator = (const Rate_Limiter&) = delete;
+        Rate_Limiter& operator = (Rate_Limiter&&) = delete;
+
+    private:
+        // Reserves the permits unless they would only be ready after deadline, returns when they are ready
+        double  reserve(std::uint64_t permits, double deadline);
+        double  now(void) const;
+        void    sleep_until(double ready_time) const;
+
+    private:
+        // Nanoseconds since construction, a double so fractional intervals accumulate without drift
+        std::atomic<double>     theoretical_arrival_;
+        _clock_type::time_point origin_;
+        double                  interval_;
+        double                  burst_tolerance_;
+        std::uint64_t           burst_;
+    };
+
+
+    inline
+    Rate_Limiter::Rate_Limiter(double permits_per_second, std::uint64_t burst)
+        : theoretical_arrival_(0.0)
+        , origin_(_clock_type::now())
+        , interval_(1e9 / permits_per_second)
+        , burst_tolerance_(static_cast<double>(burst) * (1e9 / permits_per_second))
+        , burst_(burst)
+    {
+        assert(permits_per_second > 0.0 && "Rate_Limiter needs a positive rate");
+        assert(burst > 0 && "Rate_Limiter needs a burst of at least one permit");
+    }
+
+
+    inline void
+    Rate_Limiter::acquire(std::uint64_t permits)
+    {
+        this->sleep_until(this->reserve(permits, HUGE_VAL));
+    }
+
+
+    inline bool
+    Rate_Limiter::try_acquire(std::uint64_t permits)
+    {
+        return (this->reserve(permits, this->now()) != HUGE_VAL);
+    }
+
+
+    template <class Rep, class Period>
+    std::cv_status
+    Rate_Limiter::try_acquire_for(const std::chrono::duration<Rep, Period>& rel_time, std::uint64_t permits)
+    {
+        double deadline = this->now() + std::chrono::duration<double, std::nano>(rel_time).count();
+        double ready_time = this->reserve(permits, deadline);
+        if (ready_time == HUGE_VAL)
+        {
+            return std::cv_status::timeout;
+        }
+        this->sleep_until(ready_time);
+        return std::cv_status::no_timeout;
+    }
+
+
+    template <class Clock, class Duration>
+    std::cv_status
+    Rate_Limiter::try_acquire_until(const std::chrono::time_point<Clock, Duration>& timeout_time, std::uint64_t permits)
+    {
+        return this->try_acquire_for(timeout_time - Clock::now(), permits);
+    }
+
+
+    inline std::uint64_t
+    Rate_Limiter::get_available(void) const
+    {
+        double now = this->now();
+        double headroom = now + this->burst_tolerance_ - std::max(this->theoretical_arrival_.load(std::memory_order_relaxed), now);
+        return static_cast<std::uint64_t>(std::max(std::floor(headroom / this->interval_), 0.0));
+    }
+
+
+    inline std::uint64_t
+    Rate_Limiter::get_burst(void) const
+    {
+        return this->burst_;
+    }
+
+
+    inline double
+    Rate_Limiter::get_rate(void) const
+    {
+        return 1e9 / this->interval_;
+    }
+
+
+    inline double
+    Rate_Limiter::reserve(std::uint64_t permits, double deadline)
+    {
+        double cost = static_cast<double>(permits) * this->interval_;
+        double now = this->now();
+        double arrival = this->theoretical_arrival_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            // An idle bucket refills up to now, never beyond, so idle time is not banked past the burst
+            double next_arrival = std::max(arrival, now) + cost;
+            double ready_time = next_arrival - this->burst_tolerance_;
+            if (ready_time > deadline)
+            {
+                return HUGE_VAL;
+            }
+            if (this->theoretical_arrival_.compare_exchange_weak(arrival, next_arrival, std::memory_order_relaxed))
+            {
+                return ready_time;
+            }
+        }
+    }
+
+
+    inline double
+    Rate_Limiter::now(void) const
+    {
+        return std::chrono::duration<double, std::nano>(_clock_type::now() - this->origin_).count();
+    }
+
+
+    inline void
+    Rate_Limiter::sleep_until(double ready_time) const
+    {
+        // Sleeps overshoot by tens of microseconds, so the last stretch is spent yielding instead
+        constexpr double spin_window = 100000.0;
+        for (double remaining = ready_time - this->now(); remaining > 0.0; remaining = ready_time - this->now())
+        {
+            if (remaining > spin_window)
+            {
+                std::this_thread::sleep_for(std::chrono::duration<double, std::nano>(remaining - spin_window));
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+
+#endif // PENGUIN_RATE_LIMITER_H
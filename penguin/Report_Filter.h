@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_REPORT_FILTER_H
+#define PENGUIN_REPORT_FILTER_H
+
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+
+namespace Penguin
+{
+    // Decides which finished scopes are worth reporting. Sampling uses a thread-local generator and
+    // budgets compare against the measured duration, so neither touches shared state. Scopes that are
+    // not reported are counted per thread.
+    class Report_Filter
+    {
+    public:
+        static Report_Filter every(void);
+        static Report_Filter over_budget(std::chrono::nanoseconds budget);
+        static Report_Filter sampled(std::uint32_t one_in);
+
+    public:
+        bool should_report(std::chrono::nanoseconds duration) const;
+
+        // Scopes filtered out on the calling thread
+        static std::uint64_t    get_suppressed_count(void);
+        static void             reset_suppressed_count(void);
+
+    private:
+        enum class Mode
+        {
+            EVERY,
+            OVER_BUDGET,
+            SAMPLED
+        };
+
+        Report_Filter(Mode mode, std::uint32_t sample_threshold, std::chrono::nanoseconds budget);
+
+        static std::uint32_t    next_random(void);
+        static std::uint64_t&   suppressed_count(void);
+
+    private:
+        Mode                        mode_;
+        std::uint32_t               sample_threshold_;
+        std::chrono::nanoseconds    budget_;
+    };
+
+
+    inline
+    Report_Filter::Report_Filter(Mode mode, std::uint32_t sample_threshold, std::chrono::nanoseconds budget)
+        : mode_(mode)
+        , sample_threshold_(sample_threshold)
+        , budget_(budget)
+    {
+    }
+
+
+    inline Report_Filter
+    Report_Filter::every(void)
+    {
+        return Report_Filter(Mode::EVERY, 0, std::chrono::nanoseconds::zero());
+    }
+
+
+    inline Report_Filter
+    Report_Filter::over_budget(std::chrono::nanoseconds budget)
+    {
+        return Report_Filter(Mode::OVER_BUDGET, 0, budget);
+    }
+
+
+    inline Report_Filter
+    Report_Filter::sampled(std::uint32_t one_in)
+    {
+        if (one_in <= 1)
+        {
+            return every();
+        }
+        // Comparing against a threshold avoids a division for every scope
+        return Report_Filter(Mode::SAMPLED, std::numeric_limits<std::uint32_t>::max() / one_in, std::chrono::nanoseconds::zero());
+    }
+
+
+    inline bool
+    Report_Filter::should_report(std::chrono::nanoseconds duration) const
+    {
+        bool report = true;
+        switch (this->mode_)
+        {
+        case Mode::EVERY:
+            break;
+        case Mode::OVER_BUDGET:
+            report = (duration > this->budget_);
+            break;
+        case Mode::SAMPLED:
+            report = (next_random() < this->sample_threshold_);
+            break;
+        }
+
+        if (!report)
+        {
+            ++suppressed_count();
+        }
+        return report;
+    }
+
+
+    inline std::uint64_t
+    Report_Filter::get_suppressed_count(void)
+    {
+        return suppressed_count();
+    }
+
+
+    inline void
+    Report_Filter::reset_suppressed_count(void)
+    {
+        suppressed_count() = 0;
+    }
+
+
+    inline std::uint32_t
+    Report_Filter::next_random(void)
+    {
+        // xorshift32, seeded per thread from the address of its state so threads do not sample in lockstep
+        thread_local std::uint32_t state = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(&state) >> 4) | 1u;
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+
+    inline std::uint64_t&
+    Report_Filter::suppressed_count(void)
+    {
+        thread_local std::uint64_t count = 0;
+        return count;
+    }
+}
+
+
+#endif // PENGUIN_REPORT_FILTER_H
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_RUNNING_STATISTICS_H
+#define PENGUIN_RUNNING_STATISTICS_H
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+
+namespace Penguin
+{
+    // Count, min, max, mean and variance of a stream of samples in constant memory (Welford)
+    class Running_Statistics
+    {
+    public:
+        Running_Statistics(void);
+
+    public:
+        void add(double sample);
+        void merge(const Running_Statistics& other);
+        void reset(void);
+
+        std::uint64_t   count(void) const;
+        double          max(void) const;
+        double          mean(void) const;
+        double          min(void) const;
+        double          standard_deviation(void) const;
+        double          variance(void) const;
+
+    private:
+        std::uint64_t   count_;
+        double          mean_;
+        double          sum_squared_deviations_;
+        double          min_;
+        double          max_;
+    };
+
+
+    // Uniform sample of a stream kept in a fixed size reservoir (Algorithm R) for percentile estimates
+    template <class T, std::size_t Capacity>
+    class Reservoir_Sample
+    {
+    public:
+        static_assert(Capacity > 0, "A reservoir needs at least one slot");
+
+        Reservoir_Sample(void);
+
+    public:
+        void add(const T& sample);
+        void reset(void);
+
+        // Estimated value at the given percentile, in the range [0, 100]
+        T               percentile(double percent) const;
+        std::size_t     size(void) const;
+
+    private:
+        std::uint64_t next_random(void);
+
+    private:
+        std::array<T, Capacity> samples_;
+        std::uint64_t           seen_;
+        std::uint64_t           random_state_;
+    };
+
+
+    inline
+    Running_Statistics::Running_Statistics(void)
+    {
+        this->reset();
+    }
+
+
+    inline void
+    Running_Statistics::add(double sample)
+    {
+        ++this->count_;
+        double delta = sample - this->mean_;
+        this->mean_ += delta / static_cast<double>(this->count_);
+        this->sum_squared_deviations_ += delta * (sample - this->mean_);
+        this->min_ = std::min(this->min_, sample);
+        this->max_ = std::max(this->max_, sample);
+    }
+
+
+    inline void
+    Running_Statistics::merge(const Running_Statistics& other)
+    {
+        if (other.count_ == 0)
+        {
+            return;
+        }
+        if (this->count_ == 0)
+        {
+            *this = other;
+            return;
+        }
+
+        // Chan et al. pairwise combination of two partial aggregates
+        double total = static_cast<double>(this->count_ + other.count_);
+        double delta = other.mean_ - this->mean_;
+        this->mean_ += delta * static_cast<double>(other.count_) / total;
+        this->sum_squared_deviations_ += other.sum_squared_deviations_
+            + delta * delta * static_cast<double>(this->count_) * static_cast<double>(other.count_) / total;
+        this->count_ += other.count_;
+        this->min_ = std::min(this->min_, other.min_);
+        this->max_ = std::max(this->max_, other.max_);
+    }
+
+
+    inline void
+    Running_Statistics::reset(void)
+    {
+        this->count_ = 0;
+        this->mean_ = 0.0;
+        this->sum_squared_deviations_ = 0.0;
+        this->min_ = std::numeric_limits<double>::infinity();
+        this->max_ = -std::numeric_limits<double>::infinity();
+    }
+
+
+    inline std::uint64_t
+    Running_Statistics::count(void) const
+    {
+        return this->count_;
+    }
+
+
+    inline double
+    Running_Statistics::max(void) const
+    {
+        return (this->count_ == 0 ? 0.0 : this->max_);
+    }
+
+
+    inline double
+    Running_Statistics::mean(void) const
+    {
+        return this->mean_;
+    }
+
+
+    inline double
+    Running_Statistics::min(void) const
+    {
+        return (this->count_ == 0 ? 0.0 : this->min_);
+    }
+
+
+    inline double
+    Running_Statistics::standard_deviation(void) const
+    {
+        return std::sqrt(this->variance());
+    }
+
+
+    inline double
+    Running_Statistics::variance(void) const
+    {
+        // Sample variance, zero until there are at least two samples
+        return (this->count_ < 2 ? 0.0 : this->sum_squared_deviations_ / static_cast<double>(this->count_ - 1));
+    }
+
+
+    template <class T, std::size_t Capacity>
+    Reservoir_Sample<T, Capacity>::Reservoir_Sample(void)
+        : samples_()
+        , seen_(0)
+        , random_state_(0x9E3779B97F4A7C15ull)
+    {
+    }
+
+
+    template <class T, std::size_t Capacity>
+    void
+    Reservoir_Sample<T, Capacity>::add(const T& sample)
+    {
+        if (this->seen_ < Capacity)
+        {
+            this->samples_[this->seen_] = sample;
+        }
+        else
+        {
+            std::uint64_t slot = this->next_random() % (this->seen_ + 1);
+            if (slot < Capacity)
+            {
+                this->samples_[slot] = sample;
+            }
+        }
+        ++this->seen_;
+    }
+
+
+    template <class T, std::size_t Capacity>
+    void
+    Reservoir_Sample<T, Capacity>::reset(void)
+    {
+        this->seen_ = 0;
+    }
+
+
+    template <class T, std::size_t Capacity>
+    T
+    Reservoir_Sample<T, Capacity>::percentile(double percent) const
+    {
+        std::size_t samples = this->size();
+        if (samples == 0)
+        {
+            throw std::runtime_error("Reservoir is empty!");
+        }
+
+        std::array<T, Capacity> sorted(this->samples_);
+        double clamped = std::min(std::max(percent, 0.0), 100.0);
+        std::size_t rank = static_cast<std::size_t>(std::lround(clamped / 100.0 * static_cast<double>(samples - 1)));
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + samples);
+        return sorted[rank];
+    }
+
+
+    template <class T, std::size_t Capacity>
+    std::size_t
+    Reservoir_Sample<T, Capacity>::size(void) const
+    {
+        return static_cast<std::size_t>(std::min<std::uint64_t>(this->seen_, Capacity));
+    }
+
+
+    template <class T, std::size_t Capacity>
+    std::uint64_t
+    Reservoir_Sample<T, Capacity>::next_random(void)
+    {
+        // xorshift64*, cheap and good enough to pick reservoir slots
+        this->random_state_ ^= this->random_state_ >> 12;
+        this->random_state_ ^= this->random_state_ << 25;
+        this->random_state_ ^= this->random_state_ >> 27;
+        return this->random_state_ * 0x2545F4914F6CDD1Dull;
+    }
+}
+
+
+#endif // PENGUIN_RUNNING_STATISTICS_H
@@ -5,6 +5,10 @@
 #define PENGUIN_SCOPED_TIMER_H
 
 
+#include "Call_Tree.h"
+#include "Clock_Calibration.h"
+#include "Hardware_Counters.h"
+#include "Report_Filter.h"
 #include <atomic>
 #include <chrono>
 #include <functional>
@@ -24,15 +28,29 @@ namespace Penguin
 
     public:
         Scoped_Timer(std::function<void(const _timer_type&)> on_finish);
+
+        // The filter decides whether on_finish is invoked for this scope, e.g. 1-in-N or over a budget
+        Scoped_Timer(std::function<void(const _timer_type&)> on_finish, Report_Filter report_filter);
+
+        // Named timers also record into the calling thread's Penguin::Call_Tree
+        explicit Scoped_Timer(const char* scope_name);
+        Scoped_Timer(const char* scope_name, std::function<void(const _timer_type&)> on_finish);
+        Scoped_Timer(const char* scope_name, std::function<void(const _timer_type&)> on_finish, Report_Filter report_filter);
         ~Scoped_Timer(void);
 
     public:
+        // Counts over the scope, only while Penguin::Hardware_Counters are enabled and available
+        std::optional<Hardware_Counter_Values>  get_finish_counters(void) const;
+        std::optional<_duration_type>   get_compensated_finish_duration(void) const;
         std::optional<_duration_type>   get_finish_duration(void) const;
         std::optional<_time_point_type> get_finish_time(void) const;
         _duration_type                  get_intermediate_duration(void) const;
         _time_point_type                get_intermediate_time(void) const;
         _time_point_type                get_start_time(void) const;
 
+        static _duration_type           get_clock_overhead(void);
+        static _duration_type           get_clock_resolution(void);
+
     private:
         Scoped_Timer(const _timer_type&) = delete;
         Scoped_Timer(_timer_type&&) = delete;
@@ -43,18 +61,62 @@ namespace Penguin
 
     private:
         std::atomic<bool>                       finished_;
-        _time_point_type                        start_time_;
-        _time_point_type                        finish_time_;
+        const char*                             scope_name_;
         std::function<void(const _timer_type&)> on_finish_;
+        Report_Filter                           report_filter_;
+        std::optional<Hardware_Counter_Values>  start_counters_;
+        std::optional<Hardware_Counter_Values>  finish_counters_;
+        _time_point_type                        finish_time_;
+
+        // Initialised last, so as little work as possible falls between the two clock reads
+        _time_point_type                        start_time_;
     };
 
 
     template <class Rep, class Period>
     Scoped_Timer<Rep, Period>::Scoped_Timer(std::function<void(const _timer_type&)> on_finish)
+        : Scoped_Timer(on_finish, Report_Filter::every())
+    {
+    }
+
+
+    template <class Rep, class Period>
+    Scoped_Timer<Rep, Period>::Scoped_Timer(std::function<void(const _timer_type&)> on_finish, Report_Filter report_filter)
         : finished_(false)
+        , scope_name_(nullptr)
+        , on_finish_(on_finish)
+        , report_filter_(report_filter)
+        , start_counters_(Penguin::Hardware_Counters::sample())
         , start_time_(_clock_type::now())
+    {
+    }
+
+
+    template <class Rep, class Period>
+    Scoped_Timer<Rep, Period>::Scoped_Timer(const char* scope_name)
+        : Scoped_Timer(scope_name, nullptr)
+    {
+    }
+
+
+    template <class Rep, class Period>
+    Scoped_Timer<Rep, Period>::Scoped_Timer(const char* scope_name, std::function<void(const _timer_type&)> on_finish)
+        : Scoped_Timer(scope_name, on_finish, Report_Filter::every())
+    {
+    }
+
+
+    template <class Rep, class Period>
+    Scoped_Timer<Rep, Period>::Scoped_Timer(const char* scope_name, std::function<void(const _timer_type&)> on_finish, Report_Filter report_filter)
+        : finished_(false)
+        , scope_name_(scope_name)
         , on_finish_(on_finish)
+        , report_filter_(report_filter)
     {
+        // Enter the scope before reading the clock so the call tree bookkeeping is not timed
+        Penguin::Call_Tree::enter(this->scope_name_);
+        this->start_counters_ = Penguin::Hardware_Counters::sample();
+        this->start_time_ = _clock_type::now();
     }
 
 
@@ -62,8 +124,55 @@ namespace Penguin
     Scoped_Timer<Rep, Period>::~Scoped_Timer(void)
     {
         this->finish_time_ = _clock_type::now();
+        if (this->start_counters_)
+        {
+            std::optional<Hardware_Counter_Values> counters = Penguin::Hardware_Counters::sample();
+            if (counters)
+            {
+                this->finish_counters_ = *counters - *this->start_counters_;
+            }
+        }
         this->finished_.store(true);
-        this->on_finish_(*this);
+        std::chrono::nanoseconds duration = std::chrono::duration_cast<std::chrono::nanoseconds>(this->finish_time_ - this->start_time_);
+        if (this->scope_name_ != nullptr)
+        {
+            Penguin::Call_Tree::leave(duration);
+        }
+        if (this->on_finish_ && this->report_filter_.should_report(duration))
+        {
+            this->on_finish_(*this);
+        }
+    }
+
+
+    template <class Rep, class Period>
+    std::optional<Hardware_Counter_Values>
+    Scoped_Timer<Rep, Period>::get_finish_counters(void) const
+    {
+        if (this->get_finish_time())
+        {
+            return this->finish_counters_;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+
+
+    template <class Rep, class Period>
+    std::optional<typename Scoped_Timer<Rep, Period>::_duration_type>
+    Scoped_Timer<Rep, Period>::get_compensated_finish_duration(void) const
+    {
+        if (this->get_finish_time())
+        {
+            // Compensate in clock ticks, before any rounding to a coarser period
+            return std::chrono::duration_cast<_duration_type>(Clock_Calibration<_clock_type>::get().compensate(this->finish_time_ - this->start_time_));
+        }
+        else
+        {
+            return std::nullopt;
+        }
     }
 
 
@@ -119,6 +228,22 @@ namespace Penguin
     {
         return this->start_time_;
     }
+
+
+    template <class Rep, class Period>
+    typename Scoped_Timer<Rep, Period>::_duration_type
+    Scoped_Timer<Rep, Period>::get_clock_overhead(void)
+    {
+        return std::chrono::duration_cast<_duration_type>(Clock_Calibration<_clock_type>::get().get_overhead());
+    }
+
+
+    template <class Rep, class Period>
+    typename Scoped_Timer<Rep, Period>::_duration_type
+    Scoped_Timer<Rep, Period>::get_clock_resolution(void)
+    {
+        return std::chrono::duration_cast<_duration_type>(Clock_Calibration<_clock_type>::get().get_resolution());
+    }
 }
 
 
@@ -12,11 +12,17 @@
 
 namespace Penguin
 {
-    class Penguin_Export Semaphore
+    template <class Policy>
+    class Basic_Semaphore
     {
     public:
-        explicit Semaphore(long permits = 0);
-        virtual ~Semaphore(void);
+        using _monitor_type = Penguin::Basic_Monitor<Policy>;
+
+        explicit Basic_Semaphore(long permits = 0);
+
+        // Names the underlying monitor, for profiled policies
+        Basic_Semaphore(long permits, const char* name);
+        virtual ~Basic_Semaphore(void);
 
         void acquire(void);
         void release(void);
@@ -32,68 +38,151 @@ namespace Penguin
 
     protected:
 
+    private:
+        // Takes a permit if one is free, the fast path for acquirers and the predicate for waiters
+        bool try_take_permit(void);
+
     private:
         std::atomic<long> permits_;
         std::atomic<long> waiters_;
 
-        Penguin::Monitor permit_monitor_;
+        _monitor_type permit_monitor_;
 
-        Semaphore(const Semaphore& other) = delete;
-        Semaphore& operator = (const Semaphore& other) = delete;
+        Basic_Semaphore(const Basic_Semaphore& other) = delete;
+        Basic_Semaphore& operator = (const Basic_Semaphore& other) = delete;
 
-        Semaphore(Semaphore&& other) = delete;
-        Semaphore& operator = (Semaphore&& other) = delete;
+        Basic_Semaphore(Basic_Semaphore&& other) = delete;
+        Basic_Semaphore& operator = (Basic_Semaphore&& other) = delete;
     };
 
 
-    template <class Rep, class Period>
-    std::cv_status
-    Semaphore::try_acquire_for(const std::chrono::duration<Rep, Period>& rel_time)
+    using Semaphore = Basic_Semaphore<Default_Lock_Policy>;
+
+
+    template <class Policy>
+    Basic_Semaphore<Policy>::Basic_Semaphore(long permits)
+        : permits_(permits)
+        , waiters_(0)
     {
-        Penguin::Monitor::_guard_type permit_guard(this->permit_monitor_);
+    }
+
+
+    template <class Policy>
+    Basic_Semaphore<Policy>::Basic_Semaphore(long permits, const char* name)
+        : permits_(permits)
+        , waiters_(0)
+        , permit_monitor_(name)
+    {
+    }
+
+
+    template <class Policy>
+    Basic_Semaphore<Policy>::~Basic_Semaphore(void)
+    {
+    }
+
+
+    template <class Policy>
+    void
+    Basic_Semaphore<Policy>::acquire(void)
+    {
+        if (this->try_take_permit())
+        {
+            return;
+        }
+        typename _monitor_type::_guard_type permit_guard(this->permit_monitor_);
         this->waiters_.fetch_add(1);
-        if (this->permits_.load() > 0)
+        this->permit_monitor_.wait(permit_guard, [this] {return this->try_take_permit(); });
+        this->waiters_.fetch_sub(1);
+    }
+
+
+    template <class Policy>
+    void
+    Basic_Semaphore<Policy>::release(void)
+    {
+        // Waiters register before they check for permits, so with none registered nobody can miss this
+        // permit and the monitor can be skipped
+        this->permits_.fetch_add(1);
+        if (this->waiters_.load() > 0)
         {
-            // We don't need to wait, permits are available
+            typename _monitor_type::_guard_type permit_guard(this->permit_monitor_);
+            this->permit_monitor_.notify_one();
         }
-        else
+    }
+
+
+    template <class Policy>
+    template <class Rep, class Period>
+    std::cv_status
+    Basic_Semaphore<Policy>::try_acquire_for(const std::chrono::duration<Rep, Period>& rel_time)
+    {
+        if (this->try_take_permit())
         {
-            if (false == this->permit_monitor_.wait_for(permit_guard, rel_time, [this] {return this->permits_.load() > 0; }))
-            {
-                this->waiters_.fetch_sub(1);
-                return std::cv_status::timeout;
-            }
+            return std::cv_status::no_timeout;
         }
-        assert(this->permits_.load() > 0);
-        this->permits_.fetch_sub(1);
+        typename _monitor_type::_guard_type permit_guard(this->permit_monitor_);
+        this->waiters_.fetch_add(1);
+        bool acquired = this->permit_monitor_.wait_for(permit_guard, rel_time, [this] {return this->try_take_permit(); });
         this->waiters_.fetch_sub(1);
-        return std::cv_status::no_timeout;
+        return (acquired ? std::cv_status::no_timeout : std::cv_status::timeout);
     }
 
 
+    template <class Policy>
     template <class Clock, class Duration>
     std::cv_status
-    Semaphore::try_acquire_until(const std::chrono::time_point<Clock, Duration>& timeout_time)
+    Basic_Semaphore<Policy>::try_acquire_until(const std::chrono::time_point<Clock, Duration>& timeout_time)
     {
-        Penguin::Monitor::_guard_type permit_guard(this->permit_monitor_);
-        this->waiters_.fetch_add(1);
-        if (this->permits_.load() > 0)
+        if (this->try_take_permit())
         {
-            // We don't need to wait, permits are available
+            return std::cv_status::no_timeout;
         }
-        else
+        typename _monitor_type::_guard_type permit_guard(this->permit_monitor_);
+        this->waiters_.fetch_add(1);
+        bool acquired = this->permit_monitor_.wait_until(permit_guard, timeout_time, [this] {return this->try_take_permit(); });
+        this->waiters_.fetch_sub(1);
+        return (acquired ? std::cv_status::no_timeout : std::cv_status::timeout);
+    }
+
+
+    template <class Policy>
+    bool
+    Basic_Semaphore<Policy>::try_take_permit(void)
+    {
+        long permits = this->permits_.load();
+        while (permits > 0)
         {
-            if (false == this->permit_monitor_.wait_until(permit_guard, timeout_time, [this] {return this->permits_.load() > 0; }))
+            if (this->permits_.compare_exchange_weak(permits, permits - 1))
             {
-                this->waiters_.fetch_sub(1);
-                return std::cv_status::timeout;
+                return true;
             }
         }
-        assert(this->permits_.load() > 0);
-        this->permits_.fetch_sub(1);
-        this->waiters_.fetch_sub(1);
-        return std::cv_status::no_timeout;
+        return false;
+    }
+
+
+    template <class Policy>
+    long
+    Basic_Semaphore<Policy>::permits(void) const
+    {
+        return this->permits_.load();
     }
+
+
+    template <class Policy>
+    long
+    Basic_Semaphore<Policy>::waiters(void) const
+    {
+        return this->waiters_.load();
+    }
+
+
+    // Instantiated once in the library for the policies it ships
+    extern template class Penguin_Export Basic_Semaphore<Std_Mutex_Policy>;
+    extern template class Penguin_Export Basic_Semaphore<Adaptive_Mutex_Policy>;
+    extern template class Penguin_Export Basic_Semaphore<Futex_Policy>;
+    extern template class Penguin_Export Basic_Semaphore<Ticket_Lock_Policy>;
 }
 
 
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_SEQLOCK_H
+#define PENGUIN_SEQLOCK_H
+
+
+#include "Spin_Wait.h"
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+
+namespace Penguin
+{
+    // Snapshots of a small value that changes rarely and is read constantly. Readers never write
+    // shared memory: they copy the value and retry if the sequence moved while they copied. One writer
+    // at a time bumps the sequence to odd, writes, and bumps it back to even; concurrent writers must
+    // be serialised by the caller. The payload is held as relaxed atomic words so the racing copy is
+    // well defined, and the sequence sits on its own cache line so readers polling it do not share a
+    // line with the words being rewritten.
+    template <class T>
+    class Seqlock
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Seqlock copies its value byte by byte");
+
+    public:
+        using _value_type = T;
+
+    public:
+        Seqlock(void);
+        explicit Seqlock(const T& value);
+
+    public:
+        // Retries until it gets a consistent copy, which only takes long if the writer never pauses
+        T load(void) const;
+
+        // A single attempt, empty if a write overlapped it
+        std::optional<T> try_load(void) const;
+
+        void store(const T& value);
+
+        // Read-modify-write for the single writer, whose own loads never conflict
+        template <class Function>
+        void update(Function function);
+
+        // Even while stable, advances by two per store
+        std::uint64_t get_version(void) const;
+
+    private:
+        Seqlock(const Seqlock&) = delete;
+        Seqlock(Seqlock&&) = delete;
+
+    private:
+        Seqlock& operator = (const Seqlock&) = delete;
+        Seqlock& operator = (Seqlock&&) = delete;
+
+    private:
+        using _word_type = std::uint64_t;
+        static constexpr std::size_t WORDS = (sizeof(T) + sizeof(_word_type) - 1) / sizeof(_word_type);
+
+        void    read_words(std::array<_word_type, WORDS>& words) const;
+        T       to_value(const std::array<_word_type, WORDS>& words) const;
+
+    private:
+        alignas(64) std::atomic<std::uint64_t>                  sequence_;
+        alignas(64) std::array<std::atomic<_word_type>, WORDS>  payload_;
+    };
+
+
+    template <class T>
+    Seqlock<T>::Seqlock(void)
+        : Seqlock(T())
+    {
+    }
+
+
+    template <class T>
+    Seqlock<T>::Seqlock(const T& value)
+        : sequence_(0)
+    {
+        std::array<_word_type, WORDS> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+        for (std::size_t i = 0; i < WORDS; ++i)
+        {
+            this->payload_[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+
+    template <class T>
+    T
+    Seqlock<T>::load(void) const
+    {
+        Spin_Wait spin_wait;
+        std::optional<T> value = this->try_load();
+        while (!value)
+        {
+            spin_wait.wait();
+            value = this->try_load();
+        }
+        return *value;
+    }
+
+
+    template <class T>
+    std::optional<T>
+    Seqlock<T>::try_load(void) const
+    {
+        std::uint64_t before = this->sequence_.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            return std::nullopt;
+        }
+        std::array<_word_type, WORDS> words;
+        this->read_words(words);
+
+        // Keeps the payload loads above the second sequence load
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (this->sequence_.load(std::memory_order_relaxed) != before)
+        {
+            return std::nullopt;
+        }
+        return this->to_value(words);
+    }
+
+
+    template <class T>
+    void
+    Seqlock<T>::store(const T& value)
+    {
+        std::uint64_t sequence = this->sequence_.load(std::memory_order_relaxed);
+        assert((sequence & 1) == 0 && "Seqlock writers must be serialised");
+        this->sequence_.store(sequence + 1, std::memory_order_relaxed);
+
+        // Keeps the payload stores below the odd sequence
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::array<_word_type, WORDS> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+        for (std::size_t i = 0; i < WORDS; ++i)
+        {
+            this->payload_[i].store(words[i], std::memory_order_relaxed);
+        }
+        this->sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+
+    template <class T>
+    template <class Function>
+    void
+    Seqlock<T>::update(Function function)
+    {
+        std::array<_word_type, WORDS> words;
+        this->read_words(words);
+        T value = this->to_value(words);
+        function(value);
+        this->store(value);
+    }
+
+
+    template <class T>
+    std::uint64_t
+    Seqlock<T>::get_version(void) const
+    {
+        return this->sequence_.load(std::memory_order_acquire);
+    }
+
+
+    template <class T>
+    void
+    Seqlock<T>::read_words(std::array<_word_type, WORDS>& words) const
+    {
+        for (std::size_t i = 0; i < WORDS; ++i)
+        {
+            words[i] = this->payload_[i].load(std::memory_order_relaxed);
+        }
+    }
+
+
+    template <class T>
+    T
+    Seqlock<T>::to_value(const std::array<_word_type, WORDS>& words) const
+    {
+        T value;
+        std::memcpy(&value, words.data(), sizeof(T));
+        return value;
+    }
+}
+
+
+#endif // PENGUIN_SEQLOCK_H
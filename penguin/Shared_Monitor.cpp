@@ -0,0 +1,37 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Shared_Monitor.h"
+
+
+namespace Penguin
+{
+    Shared_Monitor::Shared_Monitor(void)
+    {
+    }
+
+
+    Shared_Monitor::~Shared_Monitor(void)
+    {
+    }
+
+
+    void
+    Shared_Monitor::notify_one(void) noexcept
+    {
+        this->condition_variable_.notify_one();
+    }
+
+
+    void
+    Shared_Monitor::notify_all(void) noexcept
+    {
+        this->condition_variable_.notify_all();
+    }
+
+
+    Shared_Monitor::operator _mutex_type &() const
+    {
+        return this->mutex_;
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_SHARED_MONITOR_H
+#define PENGUIN_SHARED_MONITOR_H
+
+
+#include "Penguin_export.h"
+#include "Distributed_Shared_Mutex.h"
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+
+
+namespace Penguin
+{
+    // A Monitor for read-mostly state. Readers hold a _shared_guard_type and writers a _guard_type,
+    // and either can wait on the condition, which releases and re-acquires the lock in the same mode.
+    class Penguin_Export Shared_Monitor
+    {
+    public:
+        using _mutex_type               = Penguin::Distributed_Shared_Mutex;
+        using _condition_variable_type  = std::condition_variable_any;
+        using _guard_type               = std::unique_lock<_mutex_type>;
+        using _shared_guard_type        = std::shared_lock<_mutex_type>;
+
+        Shared_Monitor(void);
+        virtual ~Shared_Monitor(void);
+
+        void notify_one(void) noexcept;
+        void notify_all(void) noexcept;
+
+        template <class Guard>
+        void wait(Guard& guard);
+
+        template <class Guard, class Predicate>
+        void wait(Guard& guard, Predicate predicate);
+
+        template <class Guard, class Rep, class Period>
+        std::cv_status wait_for(Guard& guard, const std::chrono::duration<Rep, Period>& rel_time);
+
+        template <class Guard, class Rep, class Period, class Predicate>
+        bool wait_for(Guard& guard, const std::chrono::duration<Rep, Period>& rel_time, Predicate predicate);
+
+        template <class Guard, class Clock, class Duration>
+        std::cv_status wait_until(Guard& guard, const std::chrono::time_point<Clock, Duration>& timeout_time);
+
+        template <class Guard, class Clock, class Duration, class Predicate>
+        bool wait_until(Guard& guard, const std::chrono::time_point<Clock, Duration>& timeout_time, Predicate predicate);
+
+        operator _mutex_type& () const;
+
+    protected:
+
+    private:
+        template <class Guard>
+        static void check_guard(const Guard& guard);
+
+    private:
+        mutable _mutex_type         mutex_;
+        _condition_variable_type    condition_variable_;
+
+        Shared_Monitor(const Shared_Monitor& other) = delete;
+        Shared_Monitor& operator = (const Shared_Monitor& other) = delete;
+
+        Shared_Monitor(Shared_Monitor&& other) = delete;
+        Shared_Monitor& operator = (Shared_Monitor&& other) = delete;
+    };
+
+
+    template <class Guard>
+    void
+    Shared_Monitor::wait(Guard& guard)
+    {
+        check_guard(guard);
+        this->condition_variable_.wait(guard);
+    }
+
+
+    template <class Guard, class Predicate>
+    void
+    Shared_Monitor::wait(Guard& guard, Predicate predicate)
+    {
+        check_guard(guard);
+        this->condition_variable_.wait(guard, predicate);
+    }
+
+
+    template <class Guard, class Rep, class Period>
+    std::cv_status
+    Shared_Monitor::wait_for(Guard& guard, const std::chrono::duration<Rep, Period>& rel_time)
+    {
+        check_guard(guard);
+        return this->condition_variable_.wait_for(guard, rel_time);
+    }
+
+
+    template <class Guard, class Rep, class Period, class Predicate>
+    bool
+    Shared_Monitor::wait_for(Guard& guard, const std::chrono::duration<Rep, Period>& rel_time, Predicate predicate)
+    {
+        check_guard(guard);
+        return this->condition_variable_.wait_for(guard, rel_time, predicate);
+    }
+
+
+    template <class Guard, class Clock, class Duration>
+    std::cv_status
+    Shared_Monitor::wait_until(Guard& guard, const std::chrono::time_point<Clock, Duration>& timeout_time)
+    {
+        check_guard(guard);
+        return this->condition_variable_.wait_until(guard, timeout_time);
+    }
+
+
+    template <class Guard, class Clock, class Duration, class Predicate>
+    bool
+    Shared_Monitor::wait_until(Guard& guard, const std::chrono::time_point<Clock, Duration>& timeout_time, Predicate predicate)
+    {
+        check_guard(guard);
+        return this->condition_variable_.wait_until(guard, timeout_time, predicate);
+    }
+
+
+    template <class Guard>
+    void
+    Shared_Monitor::check_guard(const Guard& guard)
+    {
+        static_assert(std::is_same<Guard, _guard_type>::value || std::is_same<Guard, _shared_guard_type>::value,
+            "Shared_Monitor waits take its _guard_type or _shared_guard_type");
+        assert(guard.owns_lock());
+        static_cast<void>(guard);
+    }
+}
+
+
+#endif // PENGUIN_SHARED_MONITOR_H
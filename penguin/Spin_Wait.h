@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_SPIN_WAIT_H
+#define PENGUIN_SPIN_WAIT_H
+
+
+#include <cstdint>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace Penguin
+{
+    // Tells the processor this is a spin loop, which saves power and frees the pipeline for a sibling
+    // hyperthread that may be the one about to release the lock
+    inline void
+    cpu_relax(void)
+    {
+#if defined(__GNUG__) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_ia32_pause();
+#elif defined(__GNUG__) && defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#endif
+    }
+
+
+    // Exponential backoff for a spin loop. Once the backoff has grown past a few dozen pauses the
+    // holder is probably not running, so the waiter yields its time slice instead. On a single
+    // processor the holder cannot run while we spin, so it yields straight away.
+    class Spin_Wait
+    {
+    public:
+        Spin_Wait(void);
+
+        void wait(void);
+        bool will_yield(void) const;
+
+    private:
+        static bool is_multiprocessor(void);
+
+    private:
+        static constexpr std::uint32_t YIELD_THRESHOLD = 6;
+
+    private:
+        std::uint32_t count_;
+    };
+
+
+    inline
+    Spin_Wait::Spin_Wait(void)
+        : count_(is_multiprocessor() ? 0 : YIELD_THRESHOLD)
+    {
+    }
+
+
+    inline void
+    Spin_Wait::wait(void)
+    {
+        if (this->will_yield())
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            for (std::uint32_t i = 0; i < (1u << this->count_); ++i)
+            {
+                cpu_relax();
+            }
+            ++this->count_;
+        }
+    }
+
+
+    inline bool
+    Spin_Wait::will_yield(void) const
+    {
+        return this->count_ >= YIELD_THRESHOLD;
+    }
+
+
+    inline bool
+    Spin_Wait::is_multiprocessor(void)
+    {
+        static const bool multiprocessor = std::thread::hardware_concurrency() > 1;
+        return multiprocessor;
+    }
+}
+
+
+#endif // PENGUIN_SPIN_WAIT_H
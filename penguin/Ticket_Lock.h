@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_TICKET_LOCK_H
+#define PENGUIN_TICKET_LOCK_H
+
+
+#include "Spin_Wait.h"
+#include <atomic>
+#include <cstdint>
+
+
+namespace Penguin
+{
+    // A FIFO spinlock for critical sections of a few dozen nanoseconds. Waiters are served strictly in
+    // arrival order, so nobody starves, but a preempted waiter holds up everyone behind it; keep the
+    // critical section short and the thread count near the processor count. Waiters back off and
+    // eventually yield rather than parking. Meets the Lockable requirements.
+    class Ticket_Lock
+    {
+    public:
+        Ticket_Lock(void);
+
+        void lock(void);
+        bool try_lock(void);
+        void unlock(void);
+
+    private:
+        Ticket_Lock(const Ticket_Lock&) = delete;
+        Ticket_Lock(Ticket_Lock&&) = delete;
+
+    private:
+        Ticket_Lock& operator = (const Ticket_Lock&) = delete;
+        Ticket_Lock& operator = (Ticket_Lock&&) = delete;
+
+    private:
+        std::atomic<std::uint32_t> next_ticket_;
+        std::atomic<std::uint32_t> now_serving_;
+    };
+
+
+    inline
+    Ticket_Lock::Ticket_Lock(void)
+        : next_ticket_(0)
+        , now_serving_(0)
+    {
+    }
+
+
+    inline void
+    Ticket_Lock::lock(void)
+    {
+        std::uint32_t ticket = this->next_ticket_.fetch_add(1, std::memory_order_relaxed);
+        Spin_Wait spin_wait;
+        while (this->now_serving_.load(std::memory_order_acquire) != ticket)
+        {
+            spin_wait.wait();
+        }
+    }
+
+
+    inline bool
+    Ticket_Lock::try_lock(void)
+    {
+        // Only take a ticket when it would be served immediately
+        std::uint32_t serving = this->now_serving_.load(std::memory_order_acquire);
+        std::uint32_t expected = serving;
+        return this->next_ticket_.compare_exchange_strong(expected, serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+
+    inline void
+    Ticket_Lock::unlock(void)
+    {
+        // Only the holder writes now_serving_
+        this->now_serving_.store(this->now_serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+}
+
+
+#endif // PENGUIN_TICKET_LOCK_H
@@ -5,14 +5,55 @@
 #define PENGUIN_TIMER_H
 
 
+#include "Clock_Calibration.h"
+#include "Running_Statistics.h"
 #include <atomic>
 #include <chrono>
 #include <stdexcept>
+#include <type_traits>
 
 
 namespace Penguin
 {
-    template <class Rep, class Period>
+    // Finish flag that may be polled from another thread while the timer is in use
+    class Atomic_Finish_Flag
+    {
+    public:
+        explicit Atomic_Finish_Flag(bool finished) : finished_(finished) {}
+
+        bool load(void) const { return this->finished_.load(std::memory_order_acquire); }
+        void store(bool finished) { this->finished_.store(finished, std::memory_order_release); }
+
+    private:
+        std::atomic<bool> finished_;
+    };
+
+
+    // Finish flag for timers only ever touched by one thread, stopping is a plain store
+    class Plain_Finish_Flag
+    {
+    public:
+        explicit Plain_Finish_Flag(bool finished) : finished_(finished) {}
+
+        bool load(void) const { return this->finished_; }
+        void store(bool finished) { this->finished_ = finished; }
+
+    private:
+        bool finished_;
+    };
+
+
+    namespace Timer_Detail
+    {
+        struct No_Reservoir
+        {
+            void add(double) {}
+            void reset(void) {}
+        };
+    }
+
+
+    template <class Rep, class Period, class Finish_Flag = Atomic_Finish_Flag, std::size_t Reservoir_Size = 0>
     class Timer
     {
     public:
@@ -21,7 +62,8 @@ namespace Penguin
         using _period_type = Period;
         using _duration_type = std::chrono::duration<Rep, Period>;
         using _time_point_type = std::chrono::time_point<_clock_type>;
-        using _timer_type = Timer<Rep, Period>;
+        using _timer_type = Timer<Rep, Period, Finish_Flag, Reservoir_Size>;
+        using _reservoir_type = std::conditional_t<Reservoir_Size == 0, Timer_Detail::No_Reservoir, Reservoir_Sample<double, (Reservoir_Size == 0 ? 1 : Reservoir_Size)>>;
 
     public:
         Timer(void);
@@ -34,10 +76,25 @@ namespace Penguin
         _time_point_type        get_finish_time(void) const;
         _time_point_type        get_start_time(void) const;
 
+        // Statistics over every lap since the last reset, in units of Period
+        const Running_Statistics&   get_lap_statistics(void) const;
+        _representation_type        get_lap_percentile(double percent) const;
+
+        // Records the time since the previous lap (or start) and returns it
+        _representation_type lap(void);
         void reset(void);
         void start(void);
         void stop(void);
 
+        // When enabled, reported durations and laps exclude the calibrated cost of reading the clock
+        void set_overhead_compensation(bool compensate);
+
+        static _duration_type get_clock_overhead(void);
+        static _duration_type get_clock_resolution(void);
+
+    private:
+        _representation_type to_representation(typename _clock_type::duration measured) const;
+
     private:
         Timer(const _timer_type&) = delete;
         Timer(_timer_type&&) = delete;
@@ -47,52 +104,58 @@ namespace Penguin
         _timer_type& operator = (_timer_type&&) = delete;
 
     private:
-        std::atomic<bool>   finished_;
+        Finish_Flag         finished_;
+        bool                compensate_;
         _time_point_type    start_time_;
         _time_point_type    finish_time_;
+        _time_point_type    lap_time_;
+        Running_Statistics  lap_statistics_;
+        _reservoir_type     lap_reservoir_;
     };
 
 
-    template <class Rep, class Period>
-    Timer<Rep, Period>::Timer(void)
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::Timer(void)
         : finished_(false)
+        , compensate_(false)
         , start_time_(_clock_type::now())
         , finish_time_(_clock_type::now())
+        , lap_time_(start_time_)
     {
     }
 
 
-    template <class Rep, class Period>
-    Timer<Rep, Period>::~Timer(void)
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::~Timer(void)
     {
         this->finish_time_ = _clock_type::now();
         this->finished_.store(true);
     }
 
 
-    template <class Rep, class Period>
-    typename Timer<Rep, Period>::_representation_type
-    Timer<Rep, Period>::get_current_duration(void) const
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_representation_type
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::get_current_duration(void) const
     {
-        return std::chrono::duration_cast<_duration_type>(_clock_type::now() - this->start_time_).count();
+        return this->to_representation(_clock_type::now() - this->start_time_);
     }
 
 
-    template <class Rep, class Period>
-    typename Timer<Rep, Period>::_time_point_type
-        Timer<Rep, Period>::get_current_time(void) const
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_time_point_type
+        Timer<Rep, Period, Finish_Flag, Reservoir_Size>::get_current_time(void) const
     {
         return _clock_type::now();
     }
 
 
-    template <class Rep, class Period>
-    typename Timer<Rep, Period>::_representation_type
-    Timer<Rep, Period>::get_finish_duration(void) const
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_representation_type
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::get_finish_duration(void) const
     {
         if (this->finished_.load())
         {
-            return std::chrono::duration_cast<_duration_type>(this->finish_time_ - this->start_time_).count();
+            return this->to_representation(this->finish_time_ - this->start_time_);
         }
         else
         {
@@ -101,9 +164,9 @@ namespace Penguin
     }
 
 
-    template <class Rep, class Period>
-    typename Timer<Rep, Period>::_time_point_type
-    Timer<Rep, Period>::get_finish_time(void) const
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_time_point_type
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::get_finish_time(void) const
     {
         if (this->finished_.load())
         {
@@ -116,40 +179,110 @@ namespace Penguin
     }
 
 
-    template <class Rep, class Period>
-    typename Timer<Rep, Period>::_time_point_type
-    Timer<Rep, Period>::get_start_time(void) const
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_time_point_type
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::get_start_time(void) const
     {
         return this->start_time_;
     }
 
 
-    template <class Rep, class Period>
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    const Running_Statistics&
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::get_lap_statistics(void) const
+    {
+        return this->lap_statistics_;
+    }
+
+
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_representation_type
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::get_lap_percentile(double percent) const
+    {
+        static_assert(Reservoir_Size > 0, "Lap percentiles need a timer with a reservoir");
+        return static_cast<_representation_type>(this->lap_reservoir_.percentile(percent));
+    }
+
+
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_representation_type
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::lap(void)
+    {
+        _time_point_type now = _clock_type::now();
+        _representation_type lap_duration = this->to_representation(now - this->lap_time_);
+        this->lap_time_ = now;
+        this->lap_statistics_.add(static_cast<double>(lap_duration));
+        this->lap_reservoir_.add(static_cast<double>(lap_duration));
+        return lap_duration;
+    }
+
+
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
     void
-    Timer<Rep, Period>::reset(void)
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::reset(void)
     {
+        this->lap_statistics_.reset();
+        this->lap_reservoir_.reset();
         this->start();
     }
 
     
-    template <class Rep, class Period>
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
     void
-    Timer<Rep, Period>::start(void)
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::start(void)
     {
         this->start_time_ = _clock_type::now();
+        this->lap_time_ = this->start_time_;
         this->finished_.store(false);
     }
 
 
-    template <class Rep, class Period>
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
     void
-    Timer<Rep, Period>::stop(void)
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::stop(void)
     {
         this->finish_time_ = _clock_type::now();
         this->finished_.store(true);
     }
+
+
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    void
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::set_overhead_compensation(bool compensate)
+    {
+        this->compensate_ = compensate;
+    }
+
+
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_duration_type
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::get_clock_overhead(void)
+    {
+        return std::chrono::duration_cast<_duration_type>(Clock_Calibration<_clock_type>::get().get_overhead());
+    }
+
+
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_duration_type
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::get_clock_resolution(void)
+    {
+        return std::chrono::duration_cast<_duration_type>(Clock_Calibration<_clock_type>::get().get_resolution());
+    }
+
+
+    template <class Rep, class Period, class Finish_Flag, std::size_t Reservoir_Size>
+    typename Timer<Rep, Period, Finish_Flag, Reservoir_Size>::_representation_type
+    Timer<Rep, Period, Finish_Flag, Reservoir_Size>::to_representation(typename _clock_type::duration measured) const
+    {
+        // Compensate in clock ticks, before any rounding to a coarser period
+        if (this->compensate_)
+        {
+            measured = Clock_Calibration<_clock_type>::get().compensate(measured);
+        }
+        return std::chrono::duration_cast<_duration_type>(measured).count();
+    }
 }
 
 
-#endif // PENGUIN_SCOPED_TIMER_H
+#endif // PENGUIN_TIMER_H
 
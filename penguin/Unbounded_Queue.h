@@ -7,19 +7,28 @@
 
 #include "Semaphore.h"
 #include <list>
+#include <memory_resource>
 #include <optional>
 
 
 namespace Penguin
 {
-    template <typename T>
+    // Policy picks the lock guarding the list and the item count, see Lock_Policy.h. Nodes come from
+    // the allocator's memory resource, which items that take a std::pmr allocator share too.
+    template <typename T, class Policy = Default_Lock_Policy>
     class Unbounded_Queue
     {
+    public:
+        // Named as the standard expects, so the queue is itself constructed with a parent's allocator
+        using allocator_type = std::pmr::polymorphic_allocator<T>;
+
     public:
         Unbounded_Queue(void);
+        explicit Unbounded_Queue(const allocator_type& allocator);
         virtual ~Unbounded_Queue(void);
 
     public:
+        allocator_type get_allocator(void) const;
         size_t size(void) const;
 
         void push(const T& value);
@@ -41,90 +50,126 @@ namespace Penguin
         Unbounded_Queue& operator = (Unbounded_Queue&& other) = delete;
 
     private:
-        Penguin::Semaphore  itemCount_;
-        std::list<T>        queue_;
+        T pop_front(void);
+
+    private:
+        using _monitor_type = Penguin::Basic_Monitor<Policy>;
+
+    private:
+        Penguin::Basic_Semaphore<Policy>    itemCount_;
+        _monitor_type                       queue_monitor_;
+        std::pmr::list<T>                   queue_;
     };
 
 
-    template <typename T>
-    Unbounded_Queue<T>::Unbounded_Queue(void)
+    template <typename T, class Policy>
+    Unbounded_Queue<T, Policy>::Unbounded_Queue(void)
+        : itemCount_(0)
+    {
+    }
+
+
+    template <typename T, class Policy>
+    Unbounded_Queue<T, Policy>::Unbounded_Queue(const allocator_type& allocator)
         : itemCount_(0)
+        , queue_(allocator)
+    {
+    }
+
+
+    template <typename T, class Policy>
+    Unbounded_Queue<T, Policy>::~Unbounded_Queue(void)
     {
     }
 
 
-    template <typename T>
-    Unbounded_Queue<T>::~Unbounded_Queue(void)
+    template <typename T, class Policy>
+    typename Unbounded_Queue<T, Policy>::allocator_type
+    Unbounded_Queue<T, Policy>::get_allocator(void) const
     {
+        return this->queue_.get_allocator();
     }
 
 
-    template <typename T>
+    template <typename T, class Policy>
     size_t
-    Unbounded_Queue<T>::size(void) const
+    Unbounded_Queue<T, Policy>::size(void) const
     {
-        assert(itemCount_.permits() == queue_.size());
-        return itemCount_.permits();
+        typename _monitor_type::_guard_type queue_guard(this->queue_monitor_);
+        return this->queue_.size();
     }
 
 
-    template <typename T>
+    template <typename T, class Policy>
     void
-    Unbounded_Queue<T>::push(const T& value)
+    Unbounded_Queue<T, Policy>::push(const T& value)
     {
-        this->queue_.push_back(value);
+        {
+            typename _monitor_type::_guard_type queue_guard(this->queue_monitor_);
+            this->queue_.push_back(value);
+        }
         this->itemCount_.release();
     }
 
 
-    template <typename T>
+    template <typename T, class Policy>
     void
-    Unbounded_Queue<T>::push(T&& value)
+    Unbounded_Queue<T, Policy>::push(T&& value)
     {
-        this->queue_.push_back(value);
+        {
+            typename _monitor_type::_guard_type queue_guard(this->queue_monitor_);
+            this->queue_.push_back(std::move(value));
+        }
         this->itemCount_.release();
     }
 
 
-    template <typename T>
+    template <typename T, class Policy>
     T
-    Unbounded_Queue<T>::pop(void)
+    Unbounded_Queue<T, Policy>::pop(void)
     {
         this->itemCount_.acquire();
-        T value = this->queue_.front();
-        this->queue_.pop_front();
-        return value;
+        return this->pop_front();
     }
 
 
-    template <typename T>
+    template <typename T, class Policy>
     template <class Rep, class Period>
     std::optional<T>
-    Unbounded_Queue<T>::try_pop_for(const std::chrono::duration<Rep, Period>& rel_time)
+    Unbounded_Queue<T, Policy>::try_pop_for(const std::chrono::duration<Rep, Period>& rel_time)
     {
         if (std::cv_status::no_timeout == this->itemCount_.try_acquire_for(rel_time))
         {
-            T value = this->queue_.front();
-            this->queue_.pop_front();
-            return value;
+            return this->pop_front();
         }
         return std::nullopt;
     }
 
 
-    template <typename T>
+    template <typename T, class Policy>
     template <class Clock, class Duration>
     std::optional<T>
-    Unbounded_Queue<T>::try_pop_until(const std::chrono::time_point<Clock, Duration>& timeout_time)
+    Unbounded_Queue<T, Policy>::try_pop_until(const std::chrono::time_point<Clock, Duration>& timeout_time)
     {
         if (std::cv_status::no_timeout == this->itemCount_.try_acquire_until(timeout_time))
         {
-            T value = this->queue_.front();
-            this->queue_.pop_front();
-            return value;
+            return this->pop_front();
         }
         return std::nullopt;
     }
+
+
+    template <typename T, class Policy>
+    T
+    Unbounded_Queue<T, Policy>::pop_front(void)
+    {
+        // The caller holds a permit, so there is an item for it even if other consumers race
+        typename _monitor_type::_guard_type queue_guard(this->queue_monitor_);
+        assert(this->queue_.empty() == false);
+        T value = std::move(this->queue_.front());
+        this->queue_.pop_front();
+        return value;
+    }
 }
 
 
@@ -0,0 +1,122 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Adaptive_Mutex.h>
+#include <penguin/Monitor.h>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_try_lock(void)
+    {
+        Penguin::Adaptive_Mutex lock;
+
+        int result = 0;
+        result |= (lock.try_lock() == false);
+        result |= (lock.try_lock() == true);
+        lock.unlock();
+        result |= (lock.try_lock() == false);
+        lock.unlock();
+
+        print_test_result(result, "test_try_lock()");
+        return result;
+    }
+
+
+    int test_mutual_exclusion(void)
+    {
+        // Unsynchronised increments lose updates unless the lock really excludes
+        Penguin::Adaptive_Mutex lock;
+        const int threads = 4;
+        const int increments = 100000;
+        long counter = 0;
+        std::vector<std::future<void>> workers;
+        for (int i = 0; i < threads; ++i)
+        {
+            workers.push_back(std::async(std::launch::async, [&] {
+                for (int j = 0; j < increments; ++j)
+                {
+                    std::lock_guard<Penguin::Adaptive_Mutex> guard(lock);
+                    ++counter;
+                }
+            }));
+        }
+        for (std::future<void>& worker : workers)
+        {
+            worker.get();
+        }
+
+        int result = 0;
+        result |= (counter != static_cast<long>(threads) * increments);
+
+        print_test_result(result, "test_mutual_exclusion()");
+        return result;
+    }
+
+
+    int test_parked_waiter(void)
+    {
+        // Holding the lock well past any spin budget forces the waiter to park and be woken
+        Penguin::Adaptive_Mutex lock;
+        lock.lock();
+        std::future<int> waiter = std::async(std::launch::async, [&lock] {
+            std::lock_guard<Penguin::Adaptive_Mutex> guard(lock);
+            return 0;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        int result = 0;
+        result |= (waiter.wait_for(std::chrono::milliseconds(0)) != std::future_status::timeout);
+        lock.unlock();
+        result |= (waiter.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+
+        print_test_result(result, "test_parked_waiter()");
+        return result;
+    }
+
+
+    int test_monitor_policy(void)
+    {
+        Penguin::Basic_Monitor<Penguin::Adaptive_Mutex_Policy> monitor;
+        bool ready = false;
+        std::future<bool> waiter = std::async(std::launch::async, [&] {
+            Penguin::Basic_Monitor<Penguin::Adaptive_Mutex_Policy>::_guard_type guard(monitor);
+            return monitor.wait_for(guard, std::chrono::seconds(5), [&ready] {return ready; });
+        });
+        {
+            Penguin::Basic_Monitor<Penguin::Adaptive_Mutex_Policy>::_guard_type guard(monitor);
+            ready = true;
+            monitor.notify_one();
+        }
+
+        int result = 0;
+        result |= (waiter.get() == false);
+
+        print_test_result(result, "test_monitor_policy()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Adaptive_Mutex" << std::endl;
+    int result = 0;
+    result |= test_try_lock();
+    result |= test_mutual_exclusion();
+    result |= test_parked_waiter();
+    result |= test_monitor_policy();
+
+    return result;
+}
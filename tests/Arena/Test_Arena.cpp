@@ -0,0 +1,202 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Arena.h>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    // Counts what the arena takes from and gives back to the heap
+    class Counting_Resource : public std::pmr::memory_resource
+    {
+    public:
+        std::size_t allocations = 0;
+        std::size_t outstanding = 0;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            ++this->allocations;
+            ++this->outstanding;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override
+        {
+            --this->outstanding;
+            std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return (this == &other);
+        }
+    };
+
+
+    bool is_aligned(void* pointer, std::size_t alignment)
+    {
+        return (reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0);
+    }
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_bump_allocation(void)
+    {
+        Counting_Resource upstream;
+        Penguin::Arena arena(1024, &upstream);
+
+        int result = 0;
+        result |= (upstream.allocations != 0);
+        char* first = static_cast<char*>(arena.allocate(10, 1));
+        char* second = static_cast<char*>(arena.allocate(8, 8));
+        void* empty = arena.allocate(0, 1);
+        result |= (second <= first || second - first > 16);
+        result |= !is_aligned(second, 8);
+        result |= (empty == nullptr || empty == second);
+        result |= (upstream.allocations != 1);
+        result |= (arena.get_block_count() != 1);
+
+        // Deallocating is a no-op, the space is not reused
+        arena.deallocate(second, 8, 8);
+        result |= (arena.allocate(8, 8) == second);
+
+        print_test_result(result, "test_bump_allocation()");
+        return result;
+    }
+
+
+    int test_alignment(void)
+    {
+        Penguin::Arena arena(256);
+        int result = 0;
+        for (std::size_t alignment : {1, 2, 4, 8, 16, 64, 4096})
+        {
+            static_cast<void>(arena.allocate(1, 1));
+            result |= !is_aligned(arena.allocate(24, alignment), alignment);
+        }
+
+        print_test_result(result, "test_alignment()");
+        return result;
+    }
+
+
+    int test_growth(void)
+    {
+        Counting_Resource upstream;
+        Penguin::Arena arena(256, &upstream);
+        for (int i = 0; i < 100; ++i)
+        {
+            static_cast<void>(arena.allocate(64, 8));
+        }
+
+        int result = 0;
+        // Blocks double, so a few cover the lot
+        result |= (arena.get_block_count() > 7);
+        result |= (arena.get_allocated_bytes() != 100 * 64);
+        result |= (arena.get_capacity() < arena.get_allocated_bytes());
+
+        // Larger than any block so far, it gets one to itself
+        result |= (arena.allocate(1 << 20, 16) == nullptr);
+        result |= (upstream.allocations != arena.get_block_count());
+
+        // Too large to ever fit, rather than wrapping around into the current block
+        std::size_t capacity = arena.get_capacity();
+        try
+        {
+            static_cast<void>(arena.allocate(std::numeric_limits<std::size_t>::max() - 8, 8));
+            result |= 1;
+        }
+        catch (const std::bad_alloc&)
+        {
+        }
+        result |= (arena.get_capacity() != capacity);
+
+        print_test_result(result, "test_growth()");
+        return result;
+    }
+
+
+    int test_reset_keeps_largest_block(void)
+    {
+        Counting_Resource upstream;
+        Penguin::Arena arena(256, &upstream);
+        auto request = [&arena] {
+            for (int i = 0; i < 50; ++i)
+            {
+                static_cast<void>(arena.allocate(48, 16));
+            }
+        };
+
+        int result = 0;
+        request();
+        std::size_t first_request_blocks = upstream.allocations;
+        arena.reset();
+        result |= (upstream.outstanding != 1);
+        result |= (arena.get_allocated_bytes() != 0);
+
+        // The kept block is the largest yet and twice the size of any before, so the next request
+        // needs at most one more block
+        request();
+        arena.reset();
+        request();
+        arena.reset();
+        result |= (upstream.allocations > first_request_blocks + 1);
+
+        arena.release();
+        result |= (upstream.outstanding != 0);
+        result |= (arena.get_capacity() != 0);
+
+        print_test_result(result, "test_reset_keeps_largest_block()");
+        return result;
+    }
+
+
+    int test_pmr_containers(void)
+    {
+        Counting_Resource upstream;
+        int result = 0;
+        {
+            Penguin::Arena arena(4096, &upstream);
+            std::pmr::vector<std::pmr::string> strings(&arena);
+            for (int i = 0; i < 100; ++i)
+            {
+                strings.emplace_back("a string too long for the small string buffer");
+            }
+            result |= (strings.get_allocator().resource() != &arena);
+            result |= (strings.back().get_allocator().resource() != &arena);
+            result |= (arena.is_equal(arena) == false);
+            result |= (arena.is_equal(upstream));
+        }
+        result |= (upstream.outstanding != 0);
+
+        print_test_result(result, "test_pmr_containers()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Arena" << std::endl;
+    int result = 0;
+    result |= test_bump_allocation();
+    result |= test_alignment();
+    result |= test_growth();
+    result |= test_reset_keeps_largest_block();
+    result |= test_pmr_containers();
+
+    return result;
+}
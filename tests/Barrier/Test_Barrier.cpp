@@ -0,0 +1,120 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Barrier.h>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_phases(void)
+    {
+        // Each phase every thread checks that all threads finished the previous phase
+        const int threads = 8;
+        const int phases = 500;
+        std::atomic<int> completions(0);
+        std::vector<std::atomic<int>> progress(threads);
+        Penguin::Barrier barrier(threads, [&completions] { completions.fetch_add(1); });
+
+        std::vector<std::future<int>> workers;
+        for (int i = 0; i < threads; ++i)
+        {
+            workers.push_back(std::async(std::launch::async, [&, i] {
+                int failures = 0;
+                for (int phase = 0; phase < phases; ++phase)
+                {
+                    progress[i].store(phase + 1);
+                    barrier.arrive_and_wait();
+                    for (int other = 0; other < threads; ++other)
+                    {
+                        failures += (progress[other].load() < phase + 1);
+                    }
+                    failures += (completions.load() < phase + 1);
+                }
+                return failures;
+            }));
+        }
+
+        int result = 0;
+        for (std::future<int>& worker : workers)
+        {
+            result |= (worker.wait_for(std::chrono::seconds(30)) != std::future_status::ready);
+            result |= (worker.get() != 0);
+        }
+        result |= (completions.load() != phases);
+
+        print_test_result(result, "test_phases()");
+        return result;
+    }
+
+
+    int test_arrive_and_drop(void)
+    {
+        // One thread leaves after the first phase, the rest carry on without it
+        Penguin::Barrier barrier(3);
+        std::future<void> leaver = std::async(std::launch::async, [&barrier] {
+            barrier.arrive_and_wait();
+            barrier.arrive_and_drop();
+        });
+        std::future<void> stayer = std::async(std::launch::async, [&barrier] {
+            for (int phase = 0; phase < 10; ++phase)
+            {
+                barrier.arrive_and_wait();
+            }
+        });
+        for (int phase = 0; phase < 10; ++phase)
+        {
+            barrier.arrive_and_wait();
+        }
+
+        int result = 0;
+        result |= (leaver.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+        result |= (stayer.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+
+        print_test_result(result, "test_arrive_and_drop()");
+        return result;
+    }
+
+
+    int test_split_arrive_and_wait(void)
+    {
+        Penguin::Barrier barrier(2);
+        std::atomic<bool> done(false);
+        Penguin::Barrier::_phase_type phase = barrier.arrive();
+        std::future<void> other = std::async(std::launch::async, [&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            done.store(true);
+            barrier.arrive_and_wait();
+        });
+        barrier.wait(phase);
+
+        int result = 0;
+        result |= (done.load() == false);
+        other.get();
+
+        print_test_result(result, "test_split_arrive_and_wait()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Barrier" << std::endl;
+    int result = 0;
+    result |= test_phases();
+    result |= test_arrive_and_drop();
+    result |= test_split_arrive_and_wait();
+
+    return result;
+}
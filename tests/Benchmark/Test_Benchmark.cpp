@@ -0,0 +1,158 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Benchmark.h>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    Penguin::Benchmark::Options quick_options(void)
+    {
+        Penguin::Benchmark::Options options;
+        options.warm_up_time = std::chrono::milliseconds(5);
+        options.sample_time = std::chrono::milliseconds(2);
+        options.samples = 5;
+        return options;
+    }
+
+
+    int test_calibration(void)
+    {
+        Penguin::Benchmark benchmark("Test_Benchmark", quick_options());
+        benchmark.run("sleep 100us", [](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+        benchmark.run("empty loop", [](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(i);
+            }
+        });
+        benchmark.print(std::cout);
+
+        int result = 0;
+        const auto& results = benchmark.get_results();
+        result |= (results.size() != 2);
+        if (results.size() == 2)
+        {
+            // Slow bodies need few iterations per sample, fast ones many
+            result |= (results[0].iterations >= results[1].iterations);
+            result |= (results[0].samples != 5);
+            result |= (results[0].median_ns < 100000.0);
+            result |= (results[0].min_ns > results[0].median_ns || results[0].median_ns > results[0].max_ns);
+        }
+
+        print_test_result(result, "test_calibration()");
+        return result;
+    }
+
+
+    class Counting_Fixture : public Penguin::Benchmark::Fixture
+    {
+    public:
+        void set_up(std::size_t threads) override
+        {
+            this->set_up_threads = threads;
+            this->counter.store(0);
+        }
+
+        void run(std::size_t, std::size_t iterations) override
+        {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                this->counter.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void tear_down(void) override
+        {
+            this->counted = this->counter.load();
+        }
+
+        std::size_t                 set_up_threads = 0;
+        std::atomic<std::size_t>    counter{0};
+        std::size_t                 counted = 0;
+    };
+
+
+    int test_threaded_fixture(void)
+    {
+        Penguin::Benchmark benchmark("Test_Benchmark", quick_options());
+        Counting_Fixture fixture;
+        benchmark.run_threaded("shared counter", 4, fixture);
+
+        int result = 0;
+        const auto& results = benchmark.get_results();
+        result |= (results.size() != 1);
+        if (results.size() == 1)
+        {
+            result |= (results[0].threads != 4);
+            result |= (fixture.set_up_threads != 4);
+            result |= (fixture.counted != 4 * results[0].iterations);
+        }
+
+        print_test_result(result, "test_threaded_fixture()");
+        return result;
+    }
+
+
+    int test_json_baseline(void)
+    {
+        Penguin::Benchmark benchmark("Test_Benchmark", quick_options());
+        benchmark.run("empty loop", [](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                Penguin::do_not_optimize(i);
+            }
+        });
+
+        std::filesystem::path json_path = std::filesystem::temp_directory_path() / "Test_Benchmark.json";
+        int result = 0;
+        result |= (benchmark.write_json(json_path) == false);
+
+        std::vector<Penguin::Benchmark::Result> baseline = Penguin::Benchmark::read_json(json_path);
+        std::filesystem::remove(json_path);
+        result |= (baseline.size() != 1);
+        if (baseline.size() == 1)
+        {
+            result |= (baseline[0].name != "empty loop");
+            result |= (baseline[0].iterations != benchmark.get_results()[0].iterations);
+
+            // Against itself nothing regresses, against a much faster baseline everything does
+            auto comparisons = benchmark.compare(baseline, 0.1);
+            result |= (comparisons.size() != 1 || comparisons[0].regressed);
+            baseline[0].median_ns /= 10.0;
+            comparisons = benchmark.compare(baseline, 0.1);
+            result |= (comparisons.size() != 1 || !comparisons[0].regressed);
+        }
+
+        print_test_result(result, "test_json_baseline()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Benchmark" << std::endl;
+    int result = 0;
+    result |= test_calibration();
+    result |= test_threaded_fixture();
+    result |= test_json_baseline();
+
+    return result;
+}
@@ -0,0 +1,147 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Call_Tree.h>
+#include <penguin/Scoped_Timer.h>
+#include <future>
+#include <iostream>
+#include <thread>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    const Penguin::Call_Tree::Node* find_child(const Penguin::Call_Tree::Node& node, const std::string& name)
+    {
+        for (const auto& child : node.children)
+        {
+            if (child.name == name)
+            {
+                return &child;
+            }
+        }
+        return nullptr;
+    }
+
+
+    int handle_request(void)
+    {
+        Penguin::Scoped_Timer<double, std::micro> request_timer("request");
+        {
+            Penguin::Scoped_Timer<double, std::micro> parse_timer("parse");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            Penguin::Scoped_Timer<double, std::micro> query_timer("query");
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return 0;
+    }
+
+
+    int test_nested_scopes(void)
+    {
+        Penguin::Call_Tree::reset();
+
+        std::future<int> first = std::async(std::launch::async, handle_request);
+        std::future<int> second = std::async(std::launch::async, handle_request);
+        int result = first.get() | second.get();
+
+        Penguin::Call_Tree::Node root = Penguin::Call_Tree::merge();
+        const Penguin::Call_Tree::Node* request = find_child(root, "request");
+        result |= (request == nullptr);
+        if (request != nullptr)
+        {
+            const Penguin::Call_Tree::Node* parse = find_child(*request, "parse");
+            const Penguin::Call_Tree::Node* query = find_child(*request, "query");
+            result |= (parse == nullptr || query == nullptr);
+            if (parse != nullptr && query != nullptr)
+            {
+                result |= (request->calls != 2);
+                result |= (parse->calls != 2);
+                result |= (query->calls != 6);
+
+                // Siblings are sorted by inclusive time, and the parent includes its children
+                result |= (request->children.front().name != "query");
+                result |= (request->inclusive_time < parse->inclusive_time + query->inclusive_time);
+                result |= (request->exclusive_time != request->inclusive_time - parse->inclusive_time - query->inclusive_time);
+                result |= (query->min_time < std::chrono::milliseconds(5));
+                result |= (query->max_time < query->min_time);
+            }
+        }
+
+        std::cout << Penguin::Call_Tree::report_text(root);
+        print_test_result(result, "test_nested_scopes()");
+        return result;
+    }
+
+
+    int test_json_report(void)
+    {
+        Penguin::Call_Tree::reset();
+        handle_request();
+
+        std::string json = Penguin::Call_Tree::report_json();
+        int result = 0;
+        result |= (json.find("\"name\":\"request\"") == std::string::npos);
+        result |= (json.find("\"name\":\"parse\"") == std::string::npos);
+        result |= (json.find("\"calls\":3") == std::string::npos);
+
+        std::cout << json << '\n';
+        print_test_result(result, "test_json_report()");
+        return result;
+    }
+
+
+    int test_finished_threads(void)
+    {
+        Penguin::Call_Tree::reset();
+        for (int i = 0; i < 100; ++i)
+        {
+            std::thread([] { Penguin::Scoped_Timer<double, std::micro> timer("short_lived"); }).join();
+        }
+
+        // Every thread has exited, so their trees are folded together but still counted
+        Penguin::Call_Tree::Node root = Penguin::Call_Tree::merge();
+        const Penguin::Call_Tree::Node* short_lived = find_child(root, "short_lived");
+        int result = (short_lived == nullptr || short_lived->calls != 100);
+
+        Penguin::Call_Tree::reset();
+        result |= (find_child(Penguin::Call_Tree::merge(), "short_lived") != nullptr);
+
+        print_test_result(result, "test_finished_threads()");
+        return result;
+    }
+
+
+    int test_reset(void)
+    {
+        handle_request();
+        Penguin::Call_Tree::reset();
+
+        Penguin::Call_Tree::Node root = Penguin::Call_Tree::merge();
+        int result = (root.inclusive_time != Penguin::Call_Tree::_duration_type::zero());
+
+        print_test_result(result, "test_reset()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Call_Tree" << std::endl;
+    int result = 0;
+    result |= test_nested_scopes();
+    result |= test_json_report();
+    result |= test_finished_threads();
+    result |= test_reset();
+
+    return result;
+}
@@ -0,0 +1,148 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Clock_Calibration.h>
+#include <penguin/Scoped_Timer.h>
+#include <penguin/Timer.h>
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    using Calibration = Penguin::Clock_Calibration<std::chrono::high_resolution_clock>;
+    using Nanosecond_Timer = Penguin::Scoped_Timer<long long, std::nano>;
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    long long median(std::vector<long long> values)
+    {
+        std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+        return values[values.size() / 2];
+    }
+
+
+    // An empty scope may still read a tick or two, or a little jitter, but nothing like a full clock read
+    long long empty_scope_limit(void)
+    {
+        const Calibration& calibration = Calibration::get();
+        long long resolution = std::chrono::duration_cast<std::chrono::nanoseconds>(calibration.get_resolution()).count();
+        long long jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(calibration.get_jitter()).count();
+        long long limit = std::max({ 2 * resolution, 3 * jitter, 20LL });
+#if defined(NDEBUG)
+        return limit;
+#else
+        // Unoptimised builds also time the timer's own calls, which are not inlined
+        return 2 * limit;
+#endif
+    }
+
+
+    int test_calibration(void)
+    {
+        const Calibration& calibration = Calibration::get();
+        std::cout << "Clock overhead = " << std::chrono::duration_cast<std::chrono::nanoseconds>(calibration.get_overhead()).count()
+            << "ns, jitter = " << std::chrono::duration_cast<std::chrono::nanoseconds>(calibration.get_jitter()).count()
+            << "ns, resolution = " << std::chrono::duration_cast<std::chrono::nanoseconds>(calibration.get_resolution()).count() << "ns\n";
+
+        int result = 0;
+        result |= (&calibration != &Calibration::get());
+        result |= (calibration.get_resolution() <= Calibration::_duration_type::zero());
+        result |= (calibration.get_overhead() < Calibration::_duration_type::zero());
+        result |= (calibration.compensate(Calibration::_duration_type::zero()) != Calibration::_duration_type::zero());
+        result |= (Nanosecond_Timer::get_clock_overhead() != std::chrono::duration_cast<std::chrono::nanoseconds>(calibration.get_overhead()));
+
+        print_test_result(result, "test_calibration()");
+        return result;
+    }
+
+
+    int test_empty_scoped_timer(void)
+    {
+        std::vector<long long> raw;
+        std::vector<long long> compensated;
+        raw.reserve(10000);
+        compensated.reserve(10000);
+        for (int i = 0; i < 10000; ++i)
+        {
+            Nanosecond_Timer timer([&](const Nanosecond_Timer& timer) {
+                raw.push_back(timer.get_finish_duration().value().count());
+                compensated.push_back(timer.get_compensated_finish_duration().value().count());
+            });
+        }
+        long long raw_median = median(raw);
+        long long compensated_median = median(compensated);
+        std::cout << "Empty Scoped_Timer median: raw = " << raw_median << "ns, compensated = " << compensated_median
+            << "ns, limit = " << empty_scope_limit() << "ns\n";
+
+        int result = 0;
+        result |= (compensated_median > empty_scope_limit());
+        result |= (compensated_median > raw_median);
+
+        print_test_result(result, "test_empty_scoped_timer()");
+        return result;
+    }
+
+
+    int test_empty_timer(void)
+    {
+        Penguin::Timer<long long, std::nano> timer;
+        std::vector<long long> raw(10000);
+        std::vector<long long> compensated(10000);
+        for (std::size_t i = 0; i < raw.size(); ++i)
+        {
+            timer.set_overhead_compensation(false);
+            timer.start();
+            timer.stop();
+            raw[i] = timer.get_finish_duration();
+            timer.set_overhead_compensation(true);
+            compensated[i] = timer.get_finish_duration();
+        }
+        long long raw_median = median(raw);
+        long long compensated_median = median(compensated);
+        std::cout << "Empty Timer median: raw = " << raw_median << "ns, compensated = " << compensated_median << "ns\n";
+
+        int result = 0;
+        result |= (compensated_median > empty_scope_limit());
+        result |= (compensated_median > raw_median);
+
+        print_test_result(result, "test_empty_timer()");
+        return result;
+    }
+
+
+    int test_compensation_keeps_real_work(void)
+    {
+        Penguin::Timer<long long, std::micro> timer;
+        timer.set_overhead_compensation(true);
+        timer.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        timer.stop();
+
+        int result = 0;
+        result |= (timer.get_finish_duration() < 2000);
+
+        print_test_result(result, "test_compensation_keeps_real_work()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Clock_Calibration" << std::endl;
+    int result = 0;
+    result |= test_calibration();
+    result |= test_empty_scoped_timer();
+    result |= test_empty_timer();
+    result |= test_compensation_keeps_real_work();
+
+    return result;
+}
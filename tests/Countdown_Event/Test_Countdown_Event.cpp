@@ -0,0 +1,87 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Countdown_Event.h>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_add_and_signal(void)
+    {
+        Penguin::Countdown_Event event(1);
+
+        int result = 0;
+        result |= (event.add_count(2) == false);
+        result |= (event.get_count() != 3);
+        result |= (event.signal() == true);
+        result |= (event.signal(2) == false);
+        result |= (event.is_set() == false);
+        // Once set, the work it counted is over
+        result |= (event.add_count() == true);
+        event.reset(2);
+        result |= (event.get_count() != 2);
+
+        print_test_result(result, "test_add_and_signal()");
+        return result;
+    }
+
+
+    int test_wait_for_work(void)
+    {
+        // The submitter holds the initial count until every task is added, each task signals when done
+        Penguin::Countdown_Event event(1);
+        std::vector<std::future<void>> tasks;
+        for (int i = 0; i < 8; ++i)
+        {
+            event.add_count();
+            tasks.push_back(std::async(std::launch::async, [&event] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                event.signal();
+            }));
+        }
+        event.signal();
+
+        int result = 0;
+        result |= (event.wait_for(std::chrono::seconds(5)) == false);
+        result |= (event.is_set() == false);
+
+        print_test_result(result, "test_wait_for_work()");
+        return result;
+    }
+
+
+    int test_wait_for_timeout(void)
+    {
+        Penguin::Countdown_Event event(1);
+        auto start = std::chrono::steady_clock::now();
+
+        int result = 0;
+        result |= (event.wait_for(std::chrono::milliseconds(20)) == true);
+        result |= (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(20));
+
+        print_test_result(result, "test_wait_for_timeout()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Countdown_Event" << std::endl;
+    int result = 0;
+    result |= test_add_and_signal();
+    result |= test_wait_for_work();
+    result |= test_wait_for_timeout();
+
+    return result;
+}
@@ -0,0 +1,159 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Distributed_Shared_Mutex.h>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_try_lock(void)
+    {
+        Penguin::Distributed_Shared_Mutex mutex;
+        std::cout << "Reader slots = " << mutex.slot_count() << '\n';
+
+        int result = 0;
+        // Readers share, but keep the writer out
+        result |= (mutex.try_lock_shared() == false);
+        result |= (mutex.try_lock_shared() == false);
+        result |= (mutex.try_lock() == true);
+        mutex.unlock_shared();
+        mutex.unlock_shared();
+
+        // A writer keeps everybody out
+        result |= (mutex.try_lock() == false);
+        result |= (std::async(std::launch::async, [&mutex] {return mutex.try_lock_shared(); }).get() == true);
+        mutex.unlock();
+        result |= (mutex.try_lock_shared() == false);
+        mutex.unlock_shared();
+
+        print_test_result(result, "test_try_lock()");
+        return result;
+    }
+
+
+    int test_writer_waits_for_readers(void)
+    {
+        Penguin::Distributed_Shared_Mutex mutex;
+        mutex.lock_shared();
+        std::atomic<bool> written(false);
+        std::future<void> writer = std::async(std::launch::async, [&] {
+            std::unique_lock<Penguin::Distributed_Shared_Mutex> guard(mutex);
+            written.store(true);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        int result = 0;
+        result |= written.load();
+        mutex.unlock_shared();
+        result |= (writer.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+        result |= (written.load() == false);
+
+        print_test_result(result, "test_writer_waits_for_readers()");
+        return result;
+    }
+
+
+    int test_readers_wait_for_writer(void)
+    {
+        Penguin::Distributed_Shared_Mutex mutex;
+        mutex.lock();
+        std::atomic<int> readers(0);
+        std::vector<std::future<void>> reader_results;
+        for (int i = 0; i < 4; ++i)
+        {
+            reader_results.push_back(std::async(std::launch::async, [&] {
+                std::shared_lock<Penguin::Distributed_Shared_Mutex> guard(mutex);
+                readers.fetch_add(1);
+            }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        int result = 0;
+        result |= (readers.load() != 0);
+        mutex.unlock();
+        for (std::future<void>& reader : reader_results)
+        {
+            result |= (reader.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+        }
+        result |= (readers.load() != 4);
+
+        print_test_result(result, "test_readers_wait_for_writer()");
+        return result;
+    }
+
+
+    int test_readers_see_consistent_state(void)
+    {
+        // Writers keep two counters equal, a reader that ever sees them differ overlapped a writer
+        Penguin::Distributed_Shared_Mutex mutex;
+        long first = 0;
+        long second = 0;
+        std::atomic<bool> stop(false);
+        std::vector<std::future<long>> readers;
+        for (int i = 0; i < 4; ++i)
+        {
+            readers.push_back(std::async(std::launch::async, [&] {
+                long torn = 0;
+                while (!stop.load())
+                {
+                    std::shared_lock<Penguin::Distributed_Shared_Mutex> guard(mutex);
+                    torn += (first != second);
+                }
+                return torn;
+            }));
+        }
+        std::vector<std::future<void>> writers;
+        for (int i = 0; i < 2; ++i)
+        {
+            writers.push_back(std::async(std::launch::async, [&] {
+                for (int j = 0; j < 20000; ++j)
+                {
+                    std::unique_lock<Penguin::Distributed_Shared_Mutex> guard(mutex);
+                    ++first;
+                    ++second;
+                }
+            }));
+        }
+        for (std::future<void>& writer : writers)
+        {
+            writer.get();
+        }
+        stop.store(true);
+
+        int result = 0;
+        for (std::future<long>& reader : readers)
+        {
+            result |= (reader.get() != 0);
+        }
+        result |= (first != 40000 || second != 40000);
+
+        print_test_result(result, "test_readers_see_consistent_state()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Distributed_Shared_Mutex" << std::endl;
+    int result = 0;
+    result |= test_try_lock();
+    result |= test_writer_waits_for_readers();
+    result |= test_readers_wait_for_writer();
+    result |= test_readers_see_consistent_state();
+
+    return result;
+}
@@ -2,8 +2,12 @@
 * Copyright (c) 2018 Michael Mathers
 */
 #include <penguin/Dynamic_Library.h>
+#include <algorithm>
+#include <fstream>
+#include <future>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 
 namespace
@@ -40,6 +44,368 @@ namespace
         print_test_result(result, "test_find_function()");
         return result;
     }
+
+
+    bool is_plugin_open(void)
+    {
+#if defined(__GNUG__)
+        // RTLD_NOLOAD only finds a library that is already open, and takes a reference we hand back
+        void* handle = dlopen(PENGUIN_TEST_PLUGIN_PATH, RTLD_NOW | RTLD_NOLOAD);
+        if (handle != nullptr)
+        {
+            dlclose(handle);
+        }
+        return (handle != nullptr);
+#else
+        return (GetModuleHandle(PENGUIN_TEST_PLUGIN_PATH) != NULL);
+#endif
+    }
+
+
+    int test_library_get(void)
+    {
+        int result = 0;
+
+        Penguin::Library library("Penguin");
+        result |= (library.is_loaded() == false);
+        result |= (library.get_error().empty() == false);
+
+        int (*function)(void) = library.get<int(void)>("test_library_function");
+        result |= (function == nullptr);
+        result |= (function != nullptr && function() != 1);
+        // Served from the cache the second time, and must agree with the loader
+        result |= (library.get<int(void)>("test_library_function") != function);
+        result |= (library.find("test_library_function") != Penguin::get_library_function(library.get_handle(), "test_library_function"));
+
+        print_test_result(result, "test_library_get()");
+        return result;
+    }
+
+
+    int test_library_errors(void)
+    {
+        int result = 0;
+
+        Penguin::Library missing_library("Penguin_Does_Not_Exist");
+        result |= missing_library.is_loaded();
+        result |= missing_library.get_error().empty();
+        result |= (missing_library.find("test_library_function") != nullptr);
+
+        Penguin::Library library("Penguin");
+        result |= (library.find("no_such_function") != nullptr);
+        result |= (library.find("no_such_function") != nullptr);
+
+        print_test_result(result, "test_library_errors()");
+        return result;
+    }
+
+
+    int test_library_cache_growth(void)
+    {
+        int result = 0;
+
+        // The cached misses outgrow the initial table several times, with a real symbol among them, and
+        // the misses past the cap still come back empty on every lookup
+        Penguin::Library library("Penguin");
+        Penguin::Function_Address address = library.find("test_library_function");
+        for (int i = 0; i < 1000; ++i)
+        {
+            result |= (library.find("missing_function_" + std::to_string(i)) != nullptr);
+        }
+        result |= (library.find("test_library_function") != address);
+        for (int i = 0; i < 1000; ++i)
+        {
+            result |= (library.find("missing_function_" + std::to_string(i)) != nullptr);
+        }
+
+        print_test_result(result, "test_library_cache_growth()");
+        return result;
+    }
+
+
+    int test_library_concurrent_lookups(void)
+    {
+        Penguin::Library library("Penguin");
+        Penguin::Function_Address expected = Penguin::get_library_function(library.get_handle(), "test_library_function");
+
+        // Lookups race with resolves that grow the table underneath them
+        std::vector<std::future<int>> threads;
+        for (int thread = 0; thread < 4; ++thread)
+        {
+            threads.push_back(std::async(std::launch::async, [&library, expected, thread] {
+                int thread_result = 0;
+                for (int i = 0; i < 500; ++i)
+                {
+                    thread_result |= (library.find("test_library_function") != expected);
+                    thread_result |= (library.find("missing_" + std::to_string(thread) + "_" + std::to_string(i)) != nullptr);
+                }
+                return thread_result;
+            }));
+        }
+
+        int result = 0;
+        for (std::future<int>& thread : threads)
+        {
+            result |= thread.get();
+        }
+
+        print_test_result(result, "test_library_concurrent_lookups()");
+        return result;
+    }
+
+
+    int test_registry_shares_libraries(void)
+    {
+        int result = 0;
+
+        Penguin::Library_Registry registry;
+        Penguin::Library_Registry::Reference plugin = registry.load(PENGUIN_TEST_PLUGIN_PATH);
+        result |= (!plugin || plugin->is_loaded() == false);
+
+        // The same file spelled without the prefix and extension, and through a redundant directory
+        std::filesystem::path plugin_path(PENGUIN_TEST_PLUGIN_PATH);
+        Penguin::Library_Registry::Reference unfixed = registry.load(plugin_path.parent_path() / "Penguin_Test_Plugin");
+        Penguin::Library_Registry::Reference redundant = registry.load(plugin_path.parent_path() / "." / plugin_path.filename());
+        result |= (unfixed.get() != plugin.get());
+        result |= (redundant.get() != plugin.get());
+
+        int (*function)(void) = plugin->get<int(void)>("test_plugin_function");
+        result |= (function == nullptr || function() != 42);
+        result |= (&Penguin::Library_Registry::get() != &Penguin::Library_Registry::get());
+
+        print_test_result(result, "test_registry_shares_libraries()");
+        return result;
+    }
+
+
+    int test_registry_unloads(void)
+    {
+        int result = 0;
+
+        Penguin::Library_Registry registry;
+        result |= is_plugin_open();
+        {
+            Penguin::Library_Registry::Reference plugin = registry.load(PENGUIN_TEST_PLUGIN_PATH);
+            Penguin::Library_Registry::Reference copy(plugin);
+            Penguin::Library_Registry::Reference moved(std::move(plugin));
+            result |= (is_plugin_open() == false);
+            result |= static_cast<bool>(plugin);
+            copy = Penguin::Library_Registry::Reference();
+            result |= (is_plugin_open() == false);
+        }
+        // The last reference has gone
+        result |= is_plugin_open();
+
+        Penguin::Library_Registry::Reference reopened = registry.load(PENGUIN_TEST_PLUGIN_PATH);
+        result |= (is_plugin_open() == false);
+        result |= (reopened->get<int(void)>("test_plugin_function") == nullptr);
+
+        print_test_result(result, "test_registry_unloads()");
+        return result;
+    }
+
+
+    int test_registry_failures(void)
+    {
+        int result = 0;
+
+        Penguin::Library_Registry registry;
+        Penguin::Library_Registry::Reference missing = registry.load("Penguin_Does_Not_Exist");
+        result |= (!missing);
+        result |= missing->is_loaded();
+        result |= missing->get_error().empty();
+        result |= (missing->find("test_plugin_function") != nullptr);
+
+        print_test_result(result, "test_registry_failures()");
+        return result;
+    }
+
+
+    int test_registry_relative_paths(void)
+    {
+        int result = 0;
+
+        // A relative path through a directory names another file once the working directory changes
+        std::filesystem::path plugin_path(PENGUIN_TEST_PLUGIN_PATH);
+        std::filesystem::path plugin_directory(std::filesystem::absolute(plugin_path).parent_path());
+        std::filesystem::path relative_path(plugin_directory.filename() / plugin_path.filename());
+        std::filesystem::path working_directory(std::filesystem::current_path());
+
+        Penguin::Library_Registry registry;
+        std::filesystem::current_path(plugin_directory.parent_path());
+        Penguin::Library_Registry::Reference found = registry.load(relative_path);
+        std::filesystem::current_path(plugin_directory);
+        Penguin::Library_Registry::Reference moved = registry.load(relative_path);
+        std::filesystem::current_path(working_directory);
+
+        result |= (found->is_loaded() == false);
+        result |= moved->is_loaded();
+        result |= (moved.get() == found.get());
+
+        print_test_result(result, "test_registry_relative_paths()");
+        return result;
+    }
+
+
+    int test_registry_concurrent_loads(void)
+    {
+        Penguin::Library_Registry registry;
+        Penguin::Library_Registry::Reference held = registry.load(PENGUIN_TEST_PLUGIN_PATH);
+
+        // Some threads share the held library, some open and close the plugin through a registry where
+        // nothing holds it, and some retry a load that always fails
+        Penguin::Library_Registry churn_registry;
+        std::vector<std::future<int>> threads;
+        for (int thread = 0; thread < 9; ++thread)
+        {
+            threads.push_back(std::async(std::launch::async, [&registry, &churn_registry, &held, thread] {
+                int thread_result = 0;
+                for (int i = 0; i < 500; ++i)
+                {
+                    if (thread % 3 == 0)
+                    {
+                        Penguin::Library_Registry::Reference plugin = registry.load(PENGUIN_TEST_PLUGIN_PATH);
+                        thread_result |= (plugin.get() != held.get());
+                    }
+                    else if (thread % 3 == 1)
+                    {
+                        Penguin::Library_Registry::Reference plugin = churn_registry.load(PENGUIN_TEST_PLUGIN_PATH);
+                        int (*function)(void) = plugin->get<int(void)>("test_plugin_function");
+                        thread_result |= (function == nullptr || function() != 42);
+                    }
+                    else
+                    {
+                        Penguin::Library_Registry::Reference plugin = registry.load("Penguin_Does_Not_Exist");
+                        thread_result |= plugin->is_loaded();
+                    }
+                }
+                return thread_result;
+            }));
+        }
+
+        int result = 0;
+        for (std::future<int>& thread : threads)
+        {
+            result |= thread.get();
+        }
+
+        print_test_result(result, "test_registry_concurrent_loads()");
+        return result;
+    }
+
+
+    int test_preload_libraries(void)
+    {
+        int result = 0;
+
+        // Copies of the plugin under distinct names, so each one is really loaded, plus files to skip
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "Penguin_Test_Preload";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        std::filesystem::path plugin_path(PENGUIN_TEST_PLUGIN_PATH);
+        std::string extension(plugin_path.extension().string());
+        std::string prefix(plugin_path.filename().string().substr(0, plugin_path.filename().string().find("Penguin")));
+        for (int i = 0; i < 8; ++i)
+        {
+            std::filesystem::copy_file(plugin_path, directory / (prefix + "Preload_Plugin_" + std::to_string(i) + extension));
+        }
+        std::ofstream(directory / (prefix + "Preload_Plugin_Broken" + extension)) << "not a library";
+        std::ofstream(directory / "Preload_Plugin_Notes.txt") << "not a library either";
+
+        {
+            std::vector<Penguin::Preloaded_Library> libraries = Penguin::preload_libraries(directory, "Preload_Plugin_*", 4).get();
+            result |= (libraries.size() != 9);
+            int loaded = 0;
+            for (const Penguin::Preloaded_Library& library : libraries)
+            {
+                std::cout << library.path.filename().string() << " took " << library.load_time.count() << "ns"
+                    << (library.library->is_loaded() ? "" : ", failed: " + library.library->get_error()) << '\n';
+                result |= (library.load_time <= std::chrono::nanoseconds::zero());
+                if (library.library->is_loaded())
+                {
+                    int (*function)(void) = library.library->get<int(void)>("test_plugin_function");
+                    result |= (function == nullptr || function() != 42);
+                    ++loaded;
+                }
+            }
+            result |= (loaded != 8);
+            result |= (libraries.empty() || libraries.back().library->is_loaded());
+            result |= (std::is_sorted(libraries.begin(), libraries.end(), [](const Penguin::Preloaded_Library& left, const Penguin::Preloaded_Library& right) {
+                return left.path < right.path;
+            }) == false);
+
+            // Preloaded libraries are shared with later loads
+            Penguin::Library_Registry::Reference again = Penguin::Library_Registry::get().load(libraries.front().path);
+            result |= (again.get() != libraries.front().library.get());
+
+            result |= (Penguin::preload_libraries(directory, "Preload_Plugin_?").get().size() != 8);
+            result |= (Penguin::preload_libraries(directory, "Nothing_*").get().empty() == false);
+            result |= (Penguin::preload_libraries(directory / "missing").get().empty() == false);
+        }
+        std::filesystem::remove_all(directory);
+
+        print_test_result(result, "test_preload_libraries()");
+        return result;
+    }
+
+
+    int test_load_options(void)
+    {
+        int result = 0;
+
+        {
+            Penguin::Load_Options options;
+            options.prewarm_symbols = { "test_plugin_function", "no_such_function" };
+            options.prefetch_pages = true;
+            Penguin::Library library(PENGUIN_TEST_PLUGIN_PATH, options);
+            result |= (library.is_loaded() == false);
+            int (*function)(void) = library.get<int(void)>("test_plugin_function");
+            result |= (function == nullptr || function() != 42);
+            result |= (library.find("no_such_function") != nullptr);
+        }
+
+#if defined(__GNUG__)
+        {
+            // Lazy binding loads despite the undefined import, binding now refuses to
+            Penguin::Library lazy(PENGUIN_TEST_PLUGIN_PATH);
+            result |= (lazy.is_loaded() == false);
+        }
+        {
+            Penguin::Load_Options options;
+            options.binding = Penguin::Load_Options::Binding::NOW;
+            Penguin::Library now(PENGUIN_TEST_PLUGIN_PATH, options);
+            result |= now.is_loaded();
+            result |= (now.get_error().find("test_plugin_undefined_import") == std::string::npos);
+        }
+
+        {
+            Penguin::Library local(PENGUIN_TEST_PLUGIN_PATH);
+            result |= (dlsym(RTLD_DEFAULT, "test_plugin_function") != nullptr);
+        }
+#endif
+
+        // The rest leave the plugin loaded for the remainder of the process
+        result |= is_plugin_open();
+        {
+            Penguin::Load_Options options;
+            options.no_delete = true;
+            Penguin::Library library(PENGUIN_TEST_PLUGIN_PATH, options);
+        }
+        result |= (is_plugin_open() == false);
+
+#if defined(__GNUG__)
+        {
+            // glibc also pins a library that a global lookup finds a symbol in
+            Penguin::Load_Options options;
+            options.visibility = Penguin::Load_Options::Visibility::GLOBAL;
+            Penguin::Library global(PENGUIN_TEST_PLUGIN_PATH, options);
+            result |= (dlsym(RTLD_DEFAULT, "test_plugin_function") == nullptr);
+        }
+#endif
+
+        print_test_result(result, "test_load_options()");
+        return result;
+    }
 }
 
 
@@ -49,6 +415,17 @@ int main(int argc, char *argv[])
     int result = 0;
     result |= test_load_library();
     result |= test_find_function();
+    result |= test_library_get();
+    result |= test_library_errors();
+    result |= test_library_cache_growth();
+    result |= test_library_concurrent_lookups();
+    result |= test_registry_shares_libraries();
+    result |= test_registry_unloads();
+    result |= test_registry_failures();
+    result |= test_registry_relative_paths();
+    result |= test_registry_concurrent_loads();
+    result |= test_preload_libraries();
+    result |= test_load_options();
 
     return result;
 }
@@ -0,0 +1,26 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+
+
+// Loaded only through Penguin's loaders, so the tests can watch it being opened and closed
+extern "C"
+#if defined(_MSC_VER)
+__declspec(dllexport)
+#endif
+int test_plugin_function(void)
+{
+    return 42;
+}
+
+
+#if !defined(_MSC_VER)
+// Never defined anywhere, so the plugin only loads with lazy binding
+extern "C" int test_plugin_undefined_import(void);
+
+
+extern "C" int test_plugin_unresolved_function(void)
+{
+    return test_plugin_undefined_import();
+}
+#endif
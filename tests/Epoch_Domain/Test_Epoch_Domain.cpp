@@ -0,0 +1,288 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Epoch_Domain.h>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    constexpr std::uint64_t ALIVE = 0x600D600D600D600Dull;
+    constexpr std::uint64_t DEAD = 0xDEADDEADDEADDEADull;
+
+
+    // Retired nodes are poisoned and parked rather than deleted, so a reader that reaches one too
+    // early sees the poison instead of freed memory
+    struct Node
+    {
+        std::atomic<std::uint64_t>  canary{ALIVE};
+        std::uint64_t               value = 0;
+    };
+
+
+    std::mutex          graveyard_mutex;
+    std::vector<Node*>  graveyard;
+
+
+    void bury(void* object)
+    {
+        Node* node = static_cast<Node*>(object);
+        node->canary.store(DEAD, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(graveyard_mutex);
+        graveyard.push_back(node);
+    }
+
+
+    std::size_t empty_graveyard(void)
+    {
+        std::lock_guard<std::mutex> lock(graveyard_mutex);
+        std::size_t buried = graveyard.size();
+        for (Node* node : graveyard)
+        {
+            delete node;
+        }
+        graveyard.clear();
+        return buried;
+    }
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_retire_and_reclaim(void)
+    {
+        Penguin::Epoch_Domain domain(4, 1024);
+        int result = 0;
+        {
+            Penguin::Epoch_Domain::Participant participant(domain);
+            for (int i = 0; i < 10; ++i)
+            {
+                participant.retire(new Node(), &bury);
+            }
+            result |= (domain.get_garbage_count() != participant.get_garbage_count());
+
+            // With nobody reading, each reclaim advances the epoch, and two advances free everything
+            participant.reclaim();
+            participant.reclaim();
+            result |= (participant.get_garbage_count() != 0);
+            result |= (domain.get_garbage_count() != 0);
+            result |= (domain.get_participant_count() != 1);
+        }
+        result |= (empty_graveyard() != 10);
+        result |= (domain.get_participant_count() != 0);
+
+        print_test_result(result, "test_retire_and_reclaim()");
+        return result;
+    }
+
+
+    int test_nesting(void)
+    {
+        Penguin::Epoch_Domain domain;
+        Penguin::Epoch_Domain::Participant participant(domain);
+
+        int result = 0;
+        participant.enter();
+        {
+            Penguin::Epoch_Domain::Guard guard(participant);
+        }
+        result |= (participant.is_active() == false);
+        participant.leave();
+        result |= participant.is_active();
+
+        print_test_result(result, "test_nesting()");
+        return result;
+    }
+
+
+    int test_reader_holds_back_reclamation(void)
+    {
+        Penguin::Epoch_Domain domain;
+        Penguin::Epoch_Domain::Participant reader(domain);
+        Penguin::Epoch_Domain::Participant writer(domain);
+
+        int result = 0;
+        reader.enter();
+        writer.retire(new Node(), &bury);
+        for (int i = 0; i < 10; ++i)
+        {
+            writer.reclaim();
+        }
+        result |= (writer.get_garbage_count() != 1);
+        result |= (empty_graveyard() != 0);
+
+        reader.leave();
+        writer.reclaim();
+        writer.reclaim();
+        result |= (writer.get_garbage_count() != 0);
+        result |= (empty_graveyard() != 1);
+
+        print_test_result(result, "test_reader_holds_back_reclamation()");
+        return result;
+    }
+
+
+    int test_orphans(void)
+    {
+        Penguin::Epoch_Domain domain;
+        Penguin::Epoch_Domain::Participant reader(domain);
+
+        int result = 0;
+        reader.enter();
+        {
+            Penguin::Epoch_Domain::Participant writer(domain);
+            writer.retire(new Node(), &bury);
+        }
+        // The writer has gone, its node waits on the domain for the reader
+        result |= (domain.get_garbage_count() != 1);
+        result |= (domain.reclaim() != 0);
+
+        reader.leave();
+        domain.reclaim();
+        domain.reclaim();
+        result |= (domain.get_garbage_count() != 0);
+        result |= (empty_graveyard() != 1);
+
+        print_test_result(result, "test_orphans()");
+        return result;
+    }
+
+
+    int test_bounded_garbage(void)
+    {
+        constexpr std::size_t max_garbage = 64;
+        Penguin::Epoch_Domain domain(8, max_garbage);
+        std::promise<void> entered;
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+
+        // A reader that stalls inside its critical section
+        std::future<void> reader = std::async(std::launch::async, [&domain, &entered, released] {
+            Penguin::Epoch_Domain::Participant participant(domain);
+            Penguin::Epoch_Domain::Guard guard(participant);
+            entered.set_value();
+            released.wait();
+        });
+        entered.get_future().wait();
+
+        std::future<void> writer = std::async(std::launch::async, [&domain, max_garbage] {
+            Penguin::Epoch_Domain::Participant participant(domain);
+            for (std::size_t i = 0; i < max_garbage * 2; ++i)
+            {
+                participant.retire(new Node(), &bury);
+            }
+        });
+
+        int result = 0;
+        // The writer stops one past the bound until the reader moves on
+        result |= (writer.wait_for(std::chrono::milliseconds(100)) != std::future_status::timeout);
+        result |= (domain.get_garbage_count() != max_garbage + 1);
+
+        release.set_value();
+        reader.get();
+        result |= (writer.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+        result |= (domain.get_garbage_count() > max_garbage);
+
+        domain.reclaim();
+        domain.reclaim();
+        result |= (domain.get_garbage_count() != 0);
+        result |= (empty_graveyard() != max_garbage * 2);
+
+        print_test_result(result, "test_bounded_garbage()");
+        return result;
+    }
+
+
+    int test_stress(void)
+    {
+        // Writers keep swapping the shared node and retiring the old one while readers check that
+        // whatever they reach is still alive
+        Penguin::Epoch_Domain domain(16, 256);
+        std::atomic<Node*> shared(new Node());
+        std::atomic<bool> done(false);
+        std::atomic<std::uint64_t> dead_reads(0);
+        std::atomic<std::uint64_t> reads(0);
+
+        std::vector<std::future<void>> readers;
+        for (int i = 0; i < 3; ++i)
+        {
+            readers.push_back(std::async(std::launch::async, [&] {
+                Penguin::Epoch_Domain::Participant participant(domain);
+                while (!done.load(std::memory_order_relaxed))
+                {
+                    Penguin::Epoch_Domain::Guard guard(participant);
+                    Node* node = shared.load(std::memory_order_acquire);
+                    for (int j = 0; j < 8; ++j)
+                    {
+                        if (node->canary.load(std::memory_order_relaxed) != ALIVE)
+                        {
+                            dead_reads.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        std::this_thread::yield();
+                    }
+                    reads.fetch_add(1, std::memory_order_relaxed);
+                }
+            }));
+        }
+
+        std::vector<std::future<void>> writers;
+        for (int i = 0; i < 2; ++i)
+        {
+            writers.push_back(std::async(std::launch::async, [&] {
+                Penguin::Epoch_Domain::Participant participant(domain);
+                for (std::uint64_t j = 0; j < 20000; ++j)
+                {
+                    Node* node = new Node();
+                    node->value = j;
+                    participant.retire(shared.exchange(node, std::memory_order_acq_rel), &bury);
+                }
+            }));
+        }
+        for (std::future<void>& writer : writers)
+        {
+            writer.get();
+        }
+        done.store(true);
+        for (std::future<void>& reader : readers)
+        {
+            reader.get();
+        }
+
+        domain.reclaim();
+        domain.reclaim();
+        delete shared.load();
+
+        int result = 0;
+        result |= (dead_reads.load() != 0);
+        result |= (reads.load() == 0);
+        result |= (domain.get_garbage_count() != 0);
+        result |= (empty_graveyard() != 40000);
+
+        print_test_result(result, "test_stress()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Epoch_Domain" << std::endl;
+    int result = 0;
+    result |= test_retire_and_reclaim();
+    result |= test_nesting();
+    result |= test_reader_holds_back_reclamation();
+    result |= test_orphans();
+    result |= test_bounded_garbage();
+    result |= test_stress();
+
+    return result;
+}
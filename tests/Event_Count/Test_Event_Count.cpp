@@ -0,0 +1,184 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Event_Count.h>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_cancel_wait(void)
+    {
+        Penguin::Event_Count event_count;
+        Penguin::Event_Count::_key_type key = event_count.prepare_wait();
+        event_count.cancel_wait();
+        // Nobody waits, so the key must not move
+        event_count.notify();
+
+        int result = 0;
+        result |= (event_count.prepare_wait() != key);
+        event_count.cancel_wait();
+
+        print_test_result(result, "test_cancel_wait()");
+        return result;
+    }
+
+
+    int test_notify_before_wait(void)
+    {
+        Penguin::Event_Count event_count;
+        Penguin::Event_Count::_key_type key = event_count.prepare_wait();
+
+        // Notified between prepare_wait() and wait(), the wait must return at once
+        std::thread([&event_count] { event_count.notify(); }).join();
+        std::future<void> waiter = std::async(std::launch::async, [&event_count, key] { event_count.wait(key); });
+
+        int result = 0;
+        result |= (waiter.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+
+        print_test_result(result, "test_notify_before_wait()");
+        return result;
+    }
+
+
+    int test_wait_until(void)
+    {
+        Penguin::Event_Count event_count;
+        Penguin::Event_Count::_key_type key = event_count.prepare_wait();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool notified = event_count.wait_until(key, start + std::chrono::milliseconds(20));
+        std::chrono::steady_clock::duration waited = std::chrono::steady_clock::now() - start;
+
+        int result = 0;
+        result |= notified;
+        result |= (waited < std::chrono::milliseconds(20));
+
+        print_test_result(result, "test_wait_until()");
+        return result;
+    }
+
+
+    int test_notify_all(void)
+    {
+        Penguin::Event_Count event_count;
+        std::atomic<bool> ready(false);
+        std::vector<std::future<void>> waiters;
+        for (int i = 0; i < 4; ++i)
+        {
+            waiters.push_back(std::async(std::launch::async, [&event_count, &ready] {
+                while (!ready.load())
+                {
+                    Penguin::Event_Count::_key_type key = event_count.prepare_wait();
+                    if (ready.load())
+                    {
+                        event_count.cancel_wait();
+                        break;
+                    }
+                    event_count.wait(key);
+                }
+            }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ready.store(true);
+        event_count.notify_all();
+
+        int result = 0;
+        for (std::future<void>& waiter : waiters)
+        {
+            result |= (waiter.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+        }
+
+        print_test_result(result, "test_notify_all()");
+        return result;
+    }
+
+
+    int test_no_lost_wakeups(void)
+    {
+        // Producers publish items with a plain increment, consumers claim them without a lock and
+        // sleep on the event count when there are none. A lost wakeup leaves a consumer stuck.
+        constexpr int producers = 2;
+        constexpr int consumers = 2;
+        constexpr int items_per_producer = 50000;
+        Penguin::Event_Count event_count;
+        std::atomic<int> available(0);
+        std::atomic<int> consumed(0);
+
+        auto try_claim = [&available] {
+            int items = available.load();
+            while (items > 0)
+            {
+                if (available.compare_exchange_weak(items, items - 1))
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        std::vector<std::future<void>> threads;
+        for (int i = 0; i < consumers; ++i)
+        {
+            threads.push_back(std::async(std::launch::async, [&] {
+                for (int claimed = 0; claimed < producers * items_per_producer / consumers; ++claimed)
+                {
+                    while (!try_claim())
+                    {
+                        Penguin::Event_Count::_key_type key = event_count.prepare_wait();
+                        if (try_claim())
+                        {
+                            event_count.cancel_wait();
+                            break;
+                        }
+                        event_count.wait(key);
+                    }
+                    consumed.fetch_add(1);
+                }
+            }));
+        }
+        for (int i = 0; i < producers; ++i)
+        {
+            threads.push_back(std::async(std::launch::async, [&] {
+                for (int item = 0; item < items_per_producer; ++item)
+                {
+                    available.fetch_add(1);
+                    event_count.notify();
+                }
+            }));
+        }
+
+        int result = 0;
+        for (std::future<void>& thread : threads)
+        {
+            result |= (thread.wait_for(std::chrono::seconds(30)) != std::future_status::ready);
+        }
+        result |= (consumed.load() != producers * items_per_producer);
+
+        print_test_result(result, "test_no_lost_wakeups()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Event_Count" << std::endl;
+    int result = 0;
+    result |= test_cancel_wait();
+    result |= test_notify_before_wait();
+    result |= test_wait_until();
+    result |= test_notify_all();
+    result |= test_no_lost_wakeups();
+
+    return result;
+}
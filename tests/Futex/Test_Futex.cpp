@@ -0,0 +1,96 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Futex.h>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_wait_returns_on_changed_word(void)
+    {
+        // The word no longer holds the expected value, so the wait must not block
+        Penguin::Futex::_word_type word(1);
+        Penguin::Futex::wait(word, 0);
+
+        int result = 0;
+        result |= (Penguin::Futex::wait_for(word, 0, std::chrono::seconds(5)) == false);
+
+        print_test_result(result, "test_wait_returns_on_changed_word()");
+        return result;
+    }
+
+
+    int test_wait_for_timeout(void)
+    {
+        Penguin::Futex::_word_type word(0);
+        auto start = std::chrono::steady_clock::now();
+        bool woken = true;
+        // Spurious wakes are allowed, keep waiting until the futex reports the timeout
+        while (woken && std::chrono::steady_clock::now() - start < std::chrono::seconds(1))
+        {
+            woken = Penguin::Futex::wait_for(word, 0, std::chrono::milliseconds(20));
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        int result = 0;
+#if defined(__linux__)
+        result |= woken;
+        result |= (elapsed < std::chrono::milliseconds(20));
+#endif
+        result |= (Penguin::Futex::wait_for(word, 0, std::chrono::nanoseconds::zero()) != false);
+
+        print_test_result(result, "test_wait_for_timeout()");
+        return result;
+    }
+
+
+    int test_wake_all(void)
+    {
+        Penguin::Futex::_word_type word(0);
+        std::vector<std::future<int>> waiters;
+        for (int i = 0; i < 4; ++i)
+        {
+            waiters.push_back(std::async(std::launch::async, [&word] {
+                while (word.load() == 0)
+                {
+                    Penguin::Futex::wait(word, 0);
+                }
+                return 0;
+            }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        word.store(1);
+        Penguin::Futex::wake_all(word);
+
+        int result = 0;
+        for (std::future<int>& waiter : waiters)
+        {
+            result |= (waiter.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+        }
+
+        print_test_result(result, "test_wake_all()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Futex" << std::endl;
+    int result = 0;
+    result |= test_wait_returns_on_changed_word();
+    result |= test_wait_for_timeout();
+    result |= test_wake_all();
+
+    return result;
+}
@@ -0,0 +1,147 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Futex_Condition_Variable.h>
+#include <penguin/Monitor.h>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    using Guard = Penguin::Futex_Condition_Variable::_guard_type;
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_notify_one(void)
+    {
+        Penguin::Adaptive_Mutex mutex;
+        Penguin::Futex_Condition_Variable condition;
+        bool ready = false;
+        std::future<bool> waiter = std::async(std::launch::async, [&] {
+            Guard guard(mutex);
+            condition.wait(guard, [&ready] {return ready; });
+            return guard.owns_lock();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        {
+            Guard guard(mutex);
+            ready = true;
+        }
+        condition.notify_one();
+
+        int result = 0;
+        result |= (waiter.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+        result |= (waiter.get() == false);
+
+        print_test_result(result, "test_notify_one()");
+        return result;
+    }
+
+
+    int test_notify_all(void)
+    {
+        // Requeued waiters are woken one by one as each releases the mutex, all of them must get there
+        Penguin::Adaptive_Mutex mutex;
+        Penguin::Futex_Condition_Variable condition;
+        bool ready = false;
+        int woken = 0;
+        std::vector<std::future<void>> waiters;
+        for (int i = 0; i < 16; ++i)
+        {
+            waiters.push_back(std::async(std::launch::async, [&] {
+                Guard guard(mutex);
+                condition.wait(guard, [&ready] {return ready; });
+                ++woken;
+            }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        {
+            Guard guard(mutex);
+            ready = true;
+            condition.notify_all();
+        }
+
+        int result = 0;
+        for (std::future<void>& waiter : waiters)
+        {
+            result |= (waiter.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+        }
+        result |= (woken != 16);
+
+        print_test_result(result, "test_notify_all()");
+        return result;
+    }
+
+
+    int test_wait_for_timeout(void)
+    {
+        Penguin::Adaptive_Mutex mutex;
+        Penguin::Futex_Condition_Variable condition;
+        Guard guard(mutex);
+        auto start = std::chrono::steady_clock::now();
+        bool satisfied = condition.wait_for(guard, std::chrono::milliseconds(20), [] {return false; });
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        int result = 0;
+        result |= satisfied;
+        result |= (elapsed < std::chrono::milliseconds(20));
+        result |= (guard.owns_lock() == false);
+        result |= (condition.wait_until(guard, std::chrono::system_clock::now() - std::chrono::seconds(1)) != std::cv_status::timeout);
+
+        print_test_result(result, "test_wait_for_timeout()");
+        return result;
+    }
+
+
+    int test_monitor_hand_off(void)
+    {
+        // Alternate turns between two threads through one monitor, with broadcasts every time
+        Penguin::Basic_Monitor<Penguin::Futex_Policy> monitor;
+        const int rounds = 2000;
+        int turn = 0;
+        std::future<void> other = std::async(std::launch::async, [&] {
+            for (int i = 0; i < rounds; ++i)
+            {
+                Penguin::Basic_Monitor<Penguin::Futex_Policy>::_guard_type guard(monitor);
+                monitor.wait(guard, [&turn] {return turn % 2 == 1; });
+                ++turn;
+                monitor.notify_all();
+            }
+        });
+        for (int i = 0; i < rounds; ++i)
+        {
+            Penguin::Basic_Monitor<Penguin::Futex_Policy>::_guard_type guard(monitor);
+            monitor.wait(guard, [&turn] {return turn % 2 == 0; });
+            ++turn;
+            monitor.notify_all();
+        }
+
+        int result = 0;
+        result |= (other.wait_for(std::chrono::seconds(10)) != std::future_status::ready);
+        result |= (turn != 2 * rounds);
+
+        print_test_result(result, "test_monitor_hand_off()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Futex_Condition_Variable" << std::endl;
+    int result = 0;
+    result |= test_notify_one();
+    result |= test_notify_all();
+    result |= test_wait_for_timeout();
+    result |= test_monitor_hand_off();
+
+    return result;
+}
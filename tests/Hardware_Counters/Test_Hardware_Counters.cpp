@@ -0,0 +1,96 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Hardware_Counters.h>
+#include <penguin/Scoped_Timer.h>
+#include <iostream>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    long busy_work(void)
+    {
+        std::vector<long> values(1 << 16);
+        long sum = 0;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            values[i] = static_cast<long>(i * 7919 % 104729);
+            sum += values[i] & 1 ? values[i] : -values[i];
+        }
+        return sum;
+    }
+
+
+    int test_disabled_by_default(void)
+    {
+        int result = 0;
+        result |= Penguin::Hardware_Counters::is_enabled();
+        result |= Penguin::Hardware_Counters::sample().has_value();
+
+        std::optional<Penguin::Hardware_Counter_Values> counters;
+        {
+            Penguin::Scoped_Timer<double, std::micro> timer([&counters](const Penguin::Scoped_Timer<double, std::micro>& finished) {
+                counters = finished.get_finish_counters();
+            });
+            busy_work();
+        }
+        result |= counters.has_value();
+
+        print_test_result(result, "test_disabled_by_default()");
+        return result;
+    }
+
+
+    int test_scoped_counters(void)
+    {
+        Penguin::Hardware_Counters::enable();
+        bool available = Penguin::Hardware_Counters::is_available();
+        std::cout << "Hardware counters are " << (available ? "available" : "unavailable, timing only") << '\n';
+
+        int result = 0;
+        bool finished = false;
+        std::optional<Penguin::Hardware_Counter_Values> counters;
+        {
+            Penguin::Scoped_Timer<double, std::micro> timer([&](const Penguin::Scoped_Timer<double, std::micro>& timer) {
+                finished = timer.get_finish_duration().has_value();
+                counters = timer.get_finish_counters();
+            });
+            std::cout << "Busy work result = " << busy_work() << '\n';
+        }
+        Penguin::Hardware_Counters::disable();
+
+        // Without counters the timer falls back to reporting just the duration
+        result |= (finished == false);
+        result |= (counters.has_value() != available);
+        if (counters)
+        {
+            std::cout << "cycles = " << counters->cycles << ", instructions = " << counters->instructions
+                << ", cache misses = " << counters->cache_misses << ", branch misses = " << counters->branch_misses << '\n';
+            if (counters->has(Penguin::Hardware_Counter_Values::INSTRUCTIONS))
+            {
+                result |= (counters->instructions < (1 << 16));
+            }
+        }
+
+        print_test_result(result, "test_scoped_counters()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Hardware_Counters" << std::endl;
+    int result = 0;
+    result |= test_disabled_by_default();
+    result |= test_scoped_counters();
+
+    return result;
+}
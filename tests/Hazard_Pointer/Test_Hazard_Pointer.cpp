@@ -0,0 +1,222 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Hazard_Pointer.h>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    using Fence = Penguin::Hazard_Pointer_Domain::Fence;
+
+
+    constexpr std::uint64_t ALIVE = 0x600D600D600D600Dull;
+    constexpr std::uint64_t DEAD = 0xDEADDEADDEADDEADull;
+
+
+    // Retired nodes are poisoned and parked rather than deleted, so a reader that reaches one too
+    // early sees the poison instead of freed memory
+    struct Node
+    {
+        std::atomic<std::uint64_t>  canary{ALIVE};
+        std::uint64_t               value = 0;
+    };
+
+
+    std::mutex          graveyard_mutex;
+    std::vector<Node*>  graveyard;
+
+
+    void bury(void* object)
+    {
+        Node* node = static_cast<Node*>(object);
+        node->canary.store(DEAD, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(graveyard_mutex);
+        graveyard.push_back(node);
+    }
+
+
+    std::size_t empty_graveyard(void)
+    {
+        std::lock_guard<std::mutex> lock(graveyard_mutex);
+        std::size_t buried = graveyard.size();
+        for (Node* node : graveyard)
+        {
+            delete node;
+        }
+        graveyard.clear();
+        return buried;
+    }
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_protect_holds_back_one_node(void)
+    {
+        Penguin::Hazard_Pointer_Domain domain;
+        Penguin::Hazard_Pointer_Domain::Participant reader(domain);
+        Penguin::Hazard_Pointer_Domain::Participant writer(domain);
+        Node* first = new Node();
+        std::atomic<Node*> shared(first);
+
+        int result = 0;
+        result |= (reader.protect(0, shared) != first);
+        writer.retire(shared.exchange(new Node()), &bury);
+        writer.retire(shared.exchange(nullptr), &bury);
+
+        // Unlike an epoch, the reader only holds back the node it published
+        result |= (writer.reclaim() != 1);
+        result |= (writer.get_garbage_count() != 1);
+        result |= (first->canary.load() != ALIVE);
+
+        reader.clear(0);
+        result |= (writer.reclaim() != 1);
+        result |= (domain.get_garbage_count() != 0);
+        result |= (empty_graveyard() != 2);
+
+        print_test_result(result, "test_protect_holds_back_one_node()");
+        return result;
+    }
+
+
+    int test_scan_threshold(void)
+    {
+        Penguin::Hazard_Pointer_Domain domain(Fence::SYMMETRIC, 16);
+        Penguin::Hazard_Pointer_Domain::Participant participant(domain);
+
+        int result = 0;
+        for (int i = 0; i < 15; ++i)
+        {
+            participant.retire(new Node(), &bury);
+        }
+        result |= (participant.get_garbage_count() != 15);
+
+        // The sixteenth reaches the threshold and the scan frees the lot
+        participant.retire(new Node(), &bury);
+        result |= (participant.get_garbage_count() != 0);
+        result |= (empty_graveyard() != 16);
+
+        print_test_result(result, "test_scan_threshold()");
+        return result;
+    }
+
+
+    int test_orphans(void)
+    {
+        Penguin::Hazard_Pointer_Domain domain;
+        Penguin::Hazard_Pointer_Domain::Participant reader(domain);
+        std::atomic<Node*> shared(new Node());
+
+        int result = 0;
+        reader.protect(1, shared);
+        {
+            Penguin::Hazard_Pointer_Domain::Participant writer(domain);
+            writer.retire(shared.exchange(nullptr), &bury);
+        }
+        // The writer has gone, its node waits on the domain for the reader
+        result |= (domain.get_participant_count() != 1);
+        result |= (domain.get_garbage_count() != 1);
+        result |= (domain.reclaim() != 0);
+
+        reader.clear();
+        result |= (domain.reclaim() != 1);
+        result |= (domain.get_garbage_count() != 0);
+        result |= (empty_graveyard() != 1);
+
+        print_test_result(result, "test_orphans()");
+        return result;
+    }
+
+
+    int test_stress(Fence fence)
+    {
+        // Writers keep swapping the shared node and retiring the old one while readers check that
+        // whatever they protect is still alive
+        Penguin::Hazard_Pointer_Domain domain(fence, 16);
+        std::atomic<Node*> shared(new Node());
+        std::atomic<bool> done(false);
+        std::atomic<std::uint64_t> dead_reads(0);
+        std::atomic<std::uint64_t> reads(0);
+
+        std::vector<std::future<void>> readers;
+        for (int i = 0; i < 3; ++i)
+        {
+            readers.push_back(std::async(std::launch::async, [&] {
+                Penguin::Hazard_Pointer_Domain::Participant participant(domain);
+                while (!done.load(std::memory_order_relaxed))
+                {
+                    Node* node = participant.protect(0, shared);
+                    for (int j = 0; j < 8; ++j)
+                    {
+                        if (node->canary.load(std::memory_order_relaxed) != ALIVE)
+                        {
+                            dead_reads.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        std::this_thread::yield();
+                    }
+                    participant.clear(0);
+                    reads.fetch_add(1, std::memory_order_relaxed);
+                }
+            }));
+        }
+
+        std::vector<std::future<void>> writers;
+        for (int i = 0; i < 2; ++i)
+        {
+            writers.push_back(std::async(std::launch::async, [&] {
+                Penguin::Hazard_Pointer_Domain::Participant participant(domain);
+                for (std::uint64_t j = 0; j < 20000; ++j)
+                {
+                    Node* node = new Node();
+                    node->value = j;
+                    participant.retire(shared.exchange(node, std::memory_order_acq_rel), &bury);
+                }
+            }));
+        }
+        for (std::future<void>& writer : writers)
+        {
+            writer.get();
+        }
+        done.store(true);
+        for (std::future<void>& reader : readers)
+        {
+            reader.get();
+        }
+
+        domain.reclaim();
+        delete shared.load();
+
+        int result = 0;
+        result |= (dead_reads.load() != 0);
+        result |= (reads.load() == 0);
+        result |= (domain.get_garbage_count() != 0);
+        result |= (empty_graveyard() != 40000);
+
+        print_test_result(result, fence == Fence::ASYMMETRIC && domain.is_asymmetric() ? "test_stress(ASYMMETRIC)" : "test_stress(SYMMETRIC)");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Hazard_Pointer" << std::endl;
+    int result = 0;
+    result |= test_protect_holds_back_one_node();
+    result |= test_scan_threshold();
+    result |= test_orphans();
+    result |= test_stress(Fence::SYMMETRIC);
+    result |= test_stress(Fence::ASYMMETRIC);
+
+    return result;
+}
@@ -0,0 +1,14 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+
+
+// Built twice with a different HOT_PLUGIN_VERSION, to stand in for an old and a new release
+extern "C"
+#if defined(_MSC_VER)
+__declspec(dllexport)
+#endif
+int hot_plugin_version(void)
+{
+    return HOT_PLUGIN_VERSION;
+}
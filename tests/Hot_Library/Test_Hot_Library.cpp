@@ -0,0 +1,270 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Hot_Library.h>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+#if defined(__linux__)
+# include <link.h>
+# include <pthread.h>
+# include <signal.h>
+# include <unistd.h>
+#endif
+
+
+namespace
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "Penguin_Test_Hot_Library";
+    const std::filesystem::path plugin_path = directory / std::filesystem::path(PENGUIN_HOT_PLUGIN_1_PATH).filename();
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    // Renames the release into place, as a deployment would
+    void deploy(const std::filesystem::path& release_path)
+    {
+        std::filesystem::path staging_path(plugin_path.string() + ".staging");
+        std::filesystem::copy_file(release_path, staging_path, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::rename(staging_path, plugin_path);
+    }
+
+
+    int call_version(const Penguin::Hot_Library& hot_library)
+    {
+        Penguin::Hot_Library::Reader reader(hot_library);
+        return (reader ? reader->get<int(void)>(0)() : 0);
+    }
+
+
+    // Versions of the plugin mapped into the process from copies beside it, -1 where that cannot be counted
+    int count_loaded_versions(void)
+    {
+#if defined(__linux__)
+        int versions = 0;
+        dl_iterate_phdr([](struct dl_phdr_info* info, std::size_t, void* data) {
+            std::string name(info->dlpi_name);
+            *static_cast<int*>(data) += (name.find((directory / plugin_path.stem()).string() + ".hot-") == 0 ? 1 : 0);
+            return 0;
+        }, &versions);
+        return versions;
+#else
+        return -1;
+#endif
+    }
+
+
+#if defined(__linux__)
+    // Sends a signal that the watcher thread, the only one not blocking it, has to take. The handler is
+    // installed without SA_RESTART, so the watcher's poll() fails with EINTR.
+    void interrupt_other_threads(void)
+    {
+        struct sigaction action = {};
+        action.sa_handler = [](int) {};
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGUSR1, &action, nullptr);
+
+        sigset_t blocked;
+        sigemptyset(&blocked);
+        sigaddset(&blocked, SIGUSR1);
+        pthread_sigmask(SIG_BLOCK, &blocked, nullptr);
+
+        // Long enough for the watcher to be waiting in poll(), a signal taken before then is missed
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        kill(getpid(), SIGUSR1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        pthread_sigmask(SIG_UNBLOCK, &blocked, nullptr);
+    }
+#endif
+
+
+    bool wait_for_generation(const Penguin::Hot_Library& hot_library, std::uint64_t generation)
+    {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (hot_library.get_generation() < generation && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return (hot_library.get_generation() >= generation);
+    }
+
+
+    int test_load(void)
+    {
+        deploy(PENGUIN_HOT_PLUGIN_1_PATH);
+        Penguin::Hot_Library hot_library(plugin_path, { "hot_plugin_version" });
+
+        int result = 0;
+        result |= (hot_library.get_generation() != 1);
+        result |= (hot_library.get_error().empty() == false);
+        result |= (call_version(hot_library) != 1);
+        {
+            Penguin::Hot_Library::Reader reader(hot_library);
+            result |= (reader->get_generation() != 1);
+            result |= (reader->get_library().find("hot_plugin_version") != reader->get_function(0));
+        }
+        result |= (count_loaded_versions() != 1 && count_loaded_versions() != -1);
+
+        print_test_result(result, "test_load()");
+        return result;
+    }
+
+
+    int test_missing_function(void)
+    {
+        deploy(PENGUIN_HOT_PLUGIN_1_PATH);
+        Penguin::Hot_Library hot_library(plugin_path, { "hot_plugin_version", "no_such_function" });
+
+        int result = 0;
+        result |= (hot_library.get_generation() != 0);
+        result |= (hot_library.get_error().find("no_such_function") == std::string::npos);
+        result |= static_cast<bool>(Penguin::Hot_Library::Reader(hot_library));
+        result |= (count_loaded_versions() != 0 && count_loaded_versions() != -1);
+
+        print_test_result(result, "test_missing_function()");
+        return result;
+    }
+
+
+    int test_readers_keep_old_version(void)
+    {
+        deploy(PENGUIN_HOT_PLUGIN_1_PATH);
+        Penguin::Hot_Library hot_library(plugin_path, { "hot_plugin_version" });
+
+        int result = 0;
+        std::future<bool> reloaded;
+        {
+            Penguin::Hot_Library::Reader old_reader(hot_library);
+            deploy(PENGUIN_HOT_PLUGIN_2_PATH);
+            reloaded = std::async(std::launch::async, [&hot_library] { return hot_library.reload(); });
+
+            // New readers get the new version at once, the reload then waits on the old reader
+            result |= (wait_for_generation(hot_library, 2) == false);
+            result |= (call_version(hot_library) != 2);
+            result |= (old_reader->get<int(void)>(0)() != 1);
+            result |= (reloaded.wait_for(std::chrono::milliseconds(50)) != std::future_status::timeout);
+            result |= (count_loaded_versions() != 2 && count_loaded_versions() != -1);
+        }
+        result |= (reloaded.get() == false);
+        result |= (count_loaded_versions() != 1 && count_loaded_versions() != -1);
+
+        print_test_result(result, "test_readers_keep_old_version()");
+        return result;
+    }
+
+
+    int test_failed_reload(void)
+    {
+        deploy(PENGUIN_HOT_PLUGIN_1_PATH);
+        Penguin::Hot_Library hot_library(plugin_path, { "hot_plugin_version" });
+        std::ofstream(plugin_path, std::ios::trunc) << "not a library";
+
+        int result = 0;
+        result |= hot_library.reload();
+        result |= hot_library.get_error().empty();
+        result |= (hot_library.get_generation() != 1);
+        result |= (call_version(hot_library) != 1);
+
+        print_test_result(result, "test_failed_reload()");
+        return result;
+    }
+
+
+    int test_watch(void)
+    {
+        deploy(PENGUIN_HOT_PLUGIN_1_PATH);
+        Penguin::Hot_Library hot_library(plugin_path, { "hot_plugin_version" });
+
+        int result = 0;
+#if defined(__linux__)
+        result |= (hot_library.watch() == false);
+
+        // The watcher carries on after a signal interrupts it
+        interrupt_other_threads();
+
+        // Renamed into place
+        deploy(PENGUIN_HOT_PLUGIN_2_PATH);
+        result |= (wait_for_generation(hot_library, 2) == false);
+        result |= (call_version(hot_library) != 2);
+
+        // Rewritten in place
+        std::filesystem::copy_file(PENGUIN_HOT_PLUGIN_1_PATH, plugin_path, std::filesystem::copy_options::overwrite_existing);
+        result |= (wait_for_generation(hot_library, 3) == false);
+        result |= (call_version(hot_library) != 1);
+#else
+        result |= hot_library.watch();
+#endif
+
+        print_test_result(result, "test_watch()");
+        return result;
+    }
+
+
+    int test_concurrent_readers(void)
+    {
+        deploy(PENGUIN_HOT_PLUGIN_1_PATH);
+        Penguin::Hot_Library hot_library(plugin_path, { "hot_plugin_version" });
+
+        std::atomic<bool> stop(false);
+        std::vector<std::future<int>> readers;
+        for (int i = 0; i < 4; ++i)
+        {
+            readers.push_back(std::async(std::launch::async, [&hot_library, &stop] {
+                int reader_result = 0;
+                while (stop.load() == false)
+                {
+                    int version = call_version(hot_library);
+                    reader_result |= (version != 1 && version != 2);
+                }
+                return reader_result;
+            }));
+        }
+
+        int result = 0;
+        for (int i = 0; i < 20; ++i)
+        {
+            deploy(i % 2 == 0 ? PENGUIN_HOT_PLUGIN_2_PATH : PENGUIN_HOT_PLUGIN_1_PATH);
+            result |= (hot_library.reload() == false);
+        }
+        stop.store(true);
+        for (std::future<int>& reader : readers)
+        {
+            result |= reader.get();
+        }
+        result |= (hot_library.get_generation() != 21);
+        result |= (call_version(hot_library) != 1);
+        result |= (count_loaded_versions() != 1 && count_loaded_versions() != -1);
+
+        print_test_result(result, "test_concurrent_readers()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Hot_Library" << std::endl;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    int result = 0;
+    result |= test_load();
+    result |= test_missing_function();
+    result |= test_readers_keep_old_version();
+    result |= test_failed_reload();
+    result |= test_watch();
+    result |= test_concurrent_readers();
+
+    std::filesystem::remove_all(directory);
+    return result;
+}
@@ -0,0 +1,102 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Latch.h>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_count_down(void)
+    {
+        Penguin::Latch latch(3);
+
+        int result = 0;
+        result |= latch.try_wait();
+        latch.count_down();
+        latch.count_down(2);
+        result |= (latch.try_wait() == false);
+        // Already open, must not block
+        latch.wait();
+
+        print_test_result(result, "test_count_down()");
+        return result;
+    }
+
+
+    int test_waiters_released(void)
+    {
+        Penguin::Latch latch(1);
+        std::atomic<int> released(0);
+        std::vector<std::future<void>> waiters;
+        for (int i = 0; i < 8; ++i)
+        {
+            waiters.push_back(std::async(std::launch::async, [&] {
+                latch.wait();
+                released.fetch_add(1);
+            }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        int result = 0;
+        result |= (released.load() != 0);
+        latch.count_down();
+        for (std::future<void>& waiter : waiters)
+        {
+            result |= (waiter.wait_for(std::chrono::seconds(5)) != std::future_status::ready);
+        }
+        result |= (released.load() != 8);
+
+        print_test_result(result, "test_waiters_released()");
+        return result;
+    }
+
+
+    int test_arrive_and_wait(void)
+    {
+        // Nobody gets past the latch before everybody has reached it
+        const int threads = 8;
+        Penguin::Latch latch(threads);
+        std::atomic<int> arrived(0);
+        std::vector<std::future<int>> workers;
+        for (int i = 0; i < threads; ++i)
+        {
+            workers.push_back(std::async(std::launch::async, [&] {
+                arrived.fetch_add(1);
+                latch.arrive_and_wait();
+                return arrived.load();
+            }));
+        }
+
+        int result = 0;
+        for (std::future<int>& worker : workers)
+        {
+            result |= (worker.get() != threads);
+        }
+
+        print_test_result(result, "test_arrive_and_wait()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Latch" << std::endl;
+    int result = 0;
+    result |= test_count_down();
+    result |= test_waiters_released();
+    result |= test_arrive_and_wait();
+
+    return result;
+}
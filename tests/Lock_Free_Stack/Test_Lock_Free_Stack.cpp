@@ -0,0 +1,181 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Arena.h>
+#include <penguin/Lock_Free_Stack.h>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+
+namespace
+{
+    // Throws from its constructor when asked to, to check a failed push leaves the stack usable
+    struct Fragile
+    {
+        explicit Fragile(bool fail)
+        {
+            if (fail)
+            {
+                throw std::runtime_error("Fragile");
+            }
+        }
+    };
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_last_in_first_out(void)
+    {
+        Penguin::Lock_Free_Stack<int> stack;
+
+        int result = 0;
+        result |= (stack.empty() == false);
+        result |= stack.pop().has_value();
+        for (int i = 0; i < 3; ++i)
+        {
+            stack.push(i);
+        }
+        result |= stack.empty();
+        result |= (stack.pop() != 2);
+        result |= (stack.pop() != 1);
+        stack.push(3);
+        result |= (stack.pop() != 3);
+        result |= (stack.pop() != 0);
+        result |= (stack.empty() == false);
+
+        print_test_result(result, "test_last_in_first_out()");
+        return result;
+    }
+
+
+    int test_move_only(void)
+    {
+        Penguin::Lock_Free_Stack<std::unique_ptr<int>> stack;
+        stack.push(std::make_unique<int>(7));
+        stack.emplace(new int(8));
+
+        int result = 0;
+        std::optional<std::unique_ptr<int>> top = stack.pop();
+        result |= (!top || **top != 8);
+        top = stack.pop();
+        result |= (!top || **top != 7);
+
+        // Values left behind are destroyed with the stack
+        stack.push(std::make_unique<int>(9));
+
+        print_test_result(result, "test_move_only()");
+        return result;
+    }
+
+
+    int test_throwing_constructor(void)
+    {
+        Penguin::Lock_Free_Stack<Fragile> stack;
+        int result = 0;
+        try
+        {
+            stack.emplace(true);
+            result |= 1;
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+        result |= (stack.empty() == false);
+        stack.emplace(false);
+        result |= (stack.pop().has_value() == false);
+
+        print_test_result(result, "test_throwing_constructor()");
+        return result;
+    }
+
+
+    int test_allocator(void)
+    {
+        Penguin::Arena arena;
+        Penguin::Lock_Free_Stack<int> stack(&arena);
+
+        int result = 0;
+        result |= (stack.get_allocator().resource() != &arena);
+        stack.push(1);
+        std::size_t allocated = arena.get_allocated_bytes();
+        result |= (allocated == 0);
+
+        // Popped nodes are reused before anything more is allocated
+        stack.pop();
+        stack.push(2);
+        result |= (arena.get_allocated_bytes() != allocated);
+
+        print_test_result(result, "test_allocator()");
+        return result;
+    }
+
+
+    int test_concurrent(void)
+    {
+        // Every thread pushes its own values and pops as many, whatever it pops is tallied, so a lost or
+        // duplicated value shows up in the totals
+        constexpr std::uint64_t values_per_thread = 50000;
+        Penguin::Lock_Free_Stack<std::uint64_t> stack;
+        std::vector<std::future<std::uint64_t>> threads;
+        for (std::uint64_t t = 0; t < 4; ++t)
+        {
+            threads.push_back(std::async(std::launch::async, [&stack, t] {
+                std::uint64_t popped_sum = 0;
+                for (std::uint64_t i = 0; i < values_per_thread; ++i)
+                {
+                    stack.push(t * values_per_thread + i);
+                    if (i % 2 == 1)
+                    {
+                        for (int j = 0; j < 2; ++j)
+                        {
+                            std::optional<std::uint64_t> value = stack.pop();
+                            while (!value)
+                            {
+                                value = stack.pop();
+                            }
+                            popped_sum += *value + 1;
+                        }
+                    }
+                }
+                return popped_sum;
+            }));
+        }
+
+        std::uint64_t popped_sum = 0;
+        for (std::future<std::uint64_t>& thread : threads)
+        {
+            popped_sum += thread.get();
+        }
+        std::uint64_t count = 4 * values_per_thread;
+
+        int result = 0;
+        result |= (popped_sum != count * (count - 1) / 2 + count);
+        result |= (stack.empty() == false);
+
+        print_test_result(result, "test_concurrent()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Lock_Free_Stack" << std::endl;
+    int result = 0;
+    result |= test_last_in_first_out();
+    result |= test_move_only();
+    result |= test_throwing_constructor();
+    result |= test_allocator();
+    result |= test_concurrent();
+
+    return result;
+}
@@ -0,0 +1,176 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Lock_Profiler.h>
+#include <penguin/Monitor.h>
+#include <penguin/Semaphore.h>
+#include <future>
+#include <iostream>
+#include <thread>
+
+
+namespace
+{
+    using Profiled_Monitor = Penguin::Basic_Monitor<Penguin::Profiled_Policy<Penguin::Std_Mutex_Policy>>;
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    Penguin::Lock_Profiler::Entry find_entry(const std::string& name)
+    {
+        for (const Penguin::Lock_Profiler::Entry& entry : Penguin::Lock_Profiler::snapshot())
+        {
+            if (entry.name == name)
+            {
+                return entry;
+            }
+        }
+        return Penguin::Lock_Profiler::Entry();
+    }
+
+
+    int test_uncontended(void)
+    {
+        Penguin::Lock_Profiler::reset();
+        Profiled_Monitor monitor("uncontended");
+        for (int i = 0; i < 100; ++i)
+        {
+            Profiled_Monitor::_guard_type guard(monitor);
+        }
+        Penguin::Lock_Profiler::Entry entry = find_entry("uncontended");
+
+        int result = 0;
+        result |= (entry.acquisitions != 100);
+        result |= (entry.contended_acquisitions != 0);
+        result |= (entry.total_wait != std::chrono::nanoseconds::zero());
+        result |= (entry.max_hold > entry.total_hold);
+
+        print_test_result(result, "test_uncontended()");
+        return result;
+    }
+
+
+    int test_contended(void)
+    {
+        Penguin::Lock_Profiler::reset();
+        Profiled_Monitor monitor("contended");
+        std::future<void> waiter;
+        {
+            Profiled_Monitor::_guard_type guard(monitor);
+            waiter = std::async(std::launch::async, [&monitor] {
+                Profiled_Monitor::_guard_type guard(monitor);
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        waiter.get();
+        Penguin::Lock_Profiler::Entry entry = find_entry("contended");
+        std::cout << Penguin::Lock_Profiler::report_text();
+
+        int result = 0;
+        result |= (entry.acquisitions != 2);
+        result |= (entry.contended_acquisitions != 1);
+        result |= (entry.max_wait < std::chrono::milliseconds(10));
+        result |= (entry.max_hold < std::chrono::milliseconds(20));
+
+        print_test_result(result, "test_contended()");
+        return result;
+    }
+
+
+    int test_shared_names_and_ranking(void)
+    {
+        // Instances sharing a name aggregate, and the busiest name comes first
+        Penguin::Lock_Profiler::reset();
+        Profiled_Monitor first("shared name");
+        Profiled_Monitor second("shared name");
+        Penguin::Basic_Semaphore<Penguin::Profiled_Policy<Penguin::Std_Mutex_Policy>> semaphore(0, "semaphore");
+        {
+            Profiled_Monitor::_guard_type first_guard(first);
+            Profiled_Monitor::_guard_type second_guard(second);
+        }
+        {
+            Profiled_Monitor::_guard_type guard(first);
+            std::future<void> waiter = std::async(std::launch::async, [&first] {
+                Profiled_Monitor::_guard_type guard(first);
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            guard.unlock();
+            waiter.get();
+        }
+        semaphore.release();
+        semaphore.acquire();
+
+        std::vector<Penguin::Lock_Profiler::Entry> top = Penguin::Lock_Profiler::top_contended(2);
+
+        int result = 0;
+        result |= (find_entry("shared name").acquisitions != 4);
+        // Uncontended permits are taken and returned without locking the semaphore's monitor
+        result |= (find_entry("semaphore").acquisitions != 0);
+        result |= (top.size() != 2);
+        result |= (top.empty() || top[0].name != "shared name");
+
+        print_test_result(result, "test_shared_names_and_ranking()");
+        return result;
+    }
+
+
+    int test_unnamed_not_recorded(void)
+    {
+        // Unnamed locks, such as those inside other primitives, are not profiled at all
+        Penguin::Lock_Profiler::reset();
+        std::size_t records = Penguin::Lock_Profiler::snapshot().size();
+        Profiled_Monitor monitor;
+        {
+            Profiled_Monitor::_guard_type guard(monitor);
+        }
+
+        int result = 0;
+        result |= (Penguin::Lock_Profiler::snapshot().size() != records);
+        for (const Penguin::Lock_Profiler::Entry& entry : Penguin::Lock_Profiler::snapshot())
+        {
+            result |= (entry.acquisitions != 0);
+        }
+
+        print_test_result(result, "test_unnamed_not_recorded()");
+        return result;
+    }
+
+
+    int test_default_monitor(void)
+    {
+        // Penguin::Monitor is only profiled when the library is built with PENGUIN_MONITOR_PROFILING
+        Penguin::Lock_Profiler::reset();
+        Penguin::Monitor monitor("default monitor");
+        {
+            Penguin::Monitor::_guard_type guard(monitor);
+        }
+
+        int result = 0;
+#if defined(PENGUIN_MONITOR_PROFILING)
+        result |= (find_entry("default monitor").acquisitions != 1);
+#else
+        result |= (find_entry("default monitor").name.empty() == false);
+#endif
+
+        print_test_result(result, "test_default_monitor()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Lock_Profiler" << std::endl;
+    int result = 0;
+    result |= test_uncontended();
+    result |= test_contended();
+    result |= test_shared_names_and_ranking();
+    result |= test_unnamed_not_recorded();
+    result |= test_default_monitor();
+
+    return result;
+}
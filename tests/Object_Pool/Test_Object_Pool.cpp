@@ -0,0 +1,136 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Object_Pool.h>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <vector>
+
+
+namespace
+{
+    struct Buffer
+    {
+        // Claimed by whichever thread holds the buffer, so two holders at once show up
+        std::atomic<std::uint64_t>  owner{0};
+        char                        bytes[4096];
+    };
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_reuse(void)
+    {
+        Penguin::Object_Pool<Buffer> pool;
+        Buffer* first = pool.acquire();
+        pool.release(first);
+
+        int result = 0;
+        result |= (pool.acquire() != first);
+        result |= (pool.get_created_count() != 1);
+        pool.release(first);
+
+        print_test_result(result, "test_reuse()");
+        return result;
+    }
+
+
+    int test_depot(void)
+    {
+        // Twenty objects overflow the slot's two magazines of four, the rest wait in the depot
+        Penguin::Object_Pool<Buffer> pool(4);
+        std::vector<Buffer*> buffers;
+        for (int i = 0; i < 20; ++i)
+        {
+            buffers.push_back(pool.acquire());
+        }
+        for (Buffer* buffer : buffers)
+        {
+            pool.release(buffer);
+        }
+        buffers.clear();
+        for (int i = 0; i < 20; ++i)
+        {
+            buffers.push_back(pool.acquire());
+        }
+
+        int result = 0;
+        result |= (pool.get_created_count() != 20);
+        for (Buffer* buffer : buffers)
+        {
+            pool.release(buffer);
+        }
+
+        print_test_result(result, "test_depot()");
+        return result;
+    }
+
+
+    int test_across_threads(void)
+    {
+        // Threads hold bursts of different sizes, so full magazines pass between slots through the depot
+        Penguin::Object_Pool<Buffer> pool(8);
+        std::atomic<std::uint64_t> shared(0);
+        std::vector<std::future<void>> threads;
+        for (std::uint64_t t = 1; t <= 4; ++t)
+        {
+            threads.push_back(std::async(std::launch::async, [&pool, &shared, t] {
+                std::vector<Buffer*> held;
+                for (int i = 0; i < 20000; ++i)
+                {
+                    Buffer* buffer = pool.acquire();
+                    std::uint64_t free_owner = 0;
+                    if (!buffer->owner.compare_exchange_strong(free_owner, t))
+                    {
+                        shared.fetch_add(1);
+                    }
+                    held.push_back(buffer);
+                    if (held.size() == (t % 2 == 0 ? 16 : 3))
+                    {
+                        for (Buffer* released : held)
+                        {
+                            released->owner.store(0);
+                            pool.release(released);
+                        }
+                        held.clear();
+                    }
+                }
+                for (Buffer* released : held)
+                {
+                    released->owner.store(0);
+                    pool.release(released);
+                }
+            }));
+        }
+        for (std::future<void>& thread : threads)
+        {
+            thread.get();
+        }
+
+        int result = 0;
+        result |= (shared.load() != 0);
+        // Buffers are only made while every one is held, by a thread or in one of the four slots' magazines
+        result |= (pool.get_created_count() > 4 * 16 + 4 * 2 * 8);
+
+        print_test_result(result, "test_across_threads()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Object_Pool" << std::endl;
+    int result = 0;
+    result |= test_reuse();
+    result |= test_depot();
+    result |= test_across_threads();
+
+    return result;
+}
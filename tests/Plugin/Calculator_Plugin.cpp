@@ -0,0 +1,37 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Calculator_Table.h"
+
+
+namespace
+{
+    int add(int left, int right)
+    {
+        return left + right;
+    }
+
+
+    int multiply(int left, int right)
+    {
+        return left * right;
+    }
+
+
+    const char* get_name(void)
+    {
+        return "calculator";
+    }
+}
+
+
+extern "C" PENGUIN_PLUGIN_EXPORT const Penguin::Plugin_Header* penguin_plugin_entry_point(void)
+{
+    static const Calculator_Table table = {
+        Penguin::make_plugin_header<Calculator_Table>(calculator_table_name, calculator_table_version),
+        &add,
+        &multiply,
+        &get_name
+    };
+    return &table.header;
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2019 Michael Mathers
+ */
+#ifndef PENGUIN_TEST_CALCULATOR_TABLE_H
+#define PENGUIN_TEST_CALCULATOR_TABLE_H
+
+
+#include <penguin/Plugin.h>
+
+
+// The interface shared by the test host and its plugin
+struct Calculator_Table
+{
+    Penguin::Plugin_Header  header;
+    int                     (*add)(int left, int right);
+    int                     (*multiply)(int left, int right);
+    const char*             (*get_name)(void);
+};
+
+
+constexpr char          calculator_table_name[] = "calculator";
+constexpr std::uint32_t calculator_table_version = 1;
+
+
+#endif // PENGUIN_TEST_CALCULATOR_TABLE_H
@@ -0,0 +1,121 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include "Calculator_Table.h"
+#include <iostream>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_get_plugin_table(void)
+    {
+        Penguin::Library library(PENGUIN_CALCULATOR_PLUGIN_PATH);
+        Penguin::Plugin_Table<Calculator_Table> calculator = Penguin::get_plugin_table<Calculator_Table>(library, calculator_table_name, calculator_table_version);
+
+        int result = 0;
+        result |= (calculator.status != Penguin::Plugin_Status::OK);
+        result |= (!calculator);
+        if (calculator)
+        {
+            result |= (calculator->add(2, 3) != 5);
+            result |= (calculator->multiply(4, 5) != 20);
+            result |= (std::string(calculator->get_name()) != "calculator");
+            result |= (std::string(calculator->header.table_name) != calculator_table_name);
+        }
+
+        // Shared libraries work the same way
+        Penguin::Library_Registry::Reference shared = Penguin::Library_Registry::get().load(PENGUIN_CALCULATOR_PLUGIN_PATH);
+        result |= (Penguin::get_plugin_table<Calculator_Table>(*shared, calculator_table_name, calculator_table_version).table != calculator.table);
+
+        print_test_result(result, "test_get_plugin_table()");
+        return result;
+    }
+
+
+    int test_not_a_plugin(void)
+    {
+        Penguin::Library penguin("Penguin");
+        Penguin::Library missing("Penguin_Does_Not_Exist");
+        Penguin::Library calculator(PENGUIN_CALCULATOR_PLUGIN_PATH);
+
+        int result = 0;
+        result |= (Penguin::get_plugin_table<Calculator_Table>(penguin, calculator_table_name, calculator_table_version).status != Penguin::Plugin_Status::NO_ENTRY_POINT);
+        result |= (Penguin::get_plugin_table<Calculator_Table>(missing, calculator_table_name, calculator_table_version).status != Penguin::Plugin_Status::NOT_LOADED);
+
+        Penguin::Plugin_Table<Calculator_Table> newer = Penguin::get_plugin_table<Calculator_Table>(calculator, calculator_table_name, calculator_table_version + 1);
+        result |= (newer.status != Penguin::Plugin_Status::TABLE_VERSION_MISMATCH);
+        result |= static_cast<bool>(newer);
+        result |= (Penguin::get_plugin_table<Calculator_Table>(calculator, "codec", calculator_table_version).status != Penguin::Plugin_Status::WRONG_TABLE);
+
+        print_test_result(result, "test_not_a_plugin()");
+        return result;
+    }
+
+
+    int test_check_plugin_header(void)
+    {
+        const Penguin::Plugin_Header valid = Penguin::make_plugin_header<Calculator_Table>(calculator_table_name, calculator_table_version);
+        auto check = [](const Penguin::Plugin_Header& header) {
+            return Penguin::check_plugin_header(&header, calculator_table_name, calculator_table_version, sizeof(Calculator_Table));
+        };
+
+        int result = 0;
+        result |= (check(valid) != Penguin::Plugin_Status::OK);
+        result |= (Penguin::check_plugin_header(nullptr, calculator_table_name, calculator_table_version, sizeof(Calculator_Table)) != Penguin::Plugin_Status::BAD_HEADER);
+
+        Penguin::Plugin_Header header = valid;
+        header.magic = 0;
+        result |= (check(header) != Penguin::Plugin_Status::BAD_HEADER);
+
+        header = valid;
+        header.header_size += 4;
+        result |= (check(header) != Penguin::Plugin_Status::BAD_HEADER);
+
+        header = valid;
+        header.table_name = nullptr;
+        result |= (check(header) != Penguin::Plugin_Status::WRONG_TABLE);
+
+        header = valid;
+        header.table_size -= sizeof(void*);
+        result |= (check(header) != Penguin::Plugin_Status::TABLE_TOO_SMALL);
+
+        // A plugin built against a later revision of the interface may carry extra functions
+        header = valid;
+        header.table_size += sizeof(void*);
+        result |= (check(header) != Penguin::Plugin_Status::OK);
+
+        header = valid;
+        header.penguin_major_version += 1;
+        result |= (check(header) != Penguin::Plugin_Status::PENGUIN_VERSION_MISMATCH);
+
+        // Only the patch version may differ while Penguin is below 1.0
+        header = valid;
+        header.penguin_minor_version += 1;
+        result |= (check(header) != (Penguin::PENGUIN_MAJOR_VERSION == 0 ? Penguin::Plugin_Status::PENGUIN_VERSION_MISMATCH : Penguin::Plugin_Status::OK));
+
+        header = valid;
+        header.penguin_patch_version += 1;
+        result |= (check(header) != Penguin::Plugin_Status::OK);
+
+        print_test_result(result, "test_check_plugin_header()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Plugin" << std::endl;
+    int result = 0;
+    result |= test_get_plugin_table();
+    result |= test_not_a_plugin();
+    result |= test_check_plugin_header();
+
+    return result;
+}
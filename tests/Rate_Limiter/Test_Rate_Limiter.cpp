@@ -0,0 +1,169 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Rate_Limiter.h>
+#include <future>
+#include <iostream>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    // Within 5% of the schedule. The test runs serially so other tests do not starve the takers, and
+    // its clock starts before the limiter is constructed, so it never reads ahead of the limiter's.
+    bool is_outside_schedule(double elapsed, double expected)
+    {
+        return (elapsed < expected * 0.95 || elapsed > expected * 1.05);
+    }
+
+
+    int test_burst(void)
+    {
+        Penguin::Rate_Limiter limiter(1000.0, 10);
+
+        int result = 0;
+        result |= (limiter.get_available() != 10);
+        // More than the burst can never be taken without waiting
+        result |= limiter.try_acquire(11);
+        for (int i = 0; i < 10; ++i)
+        {
+            result |= (limiter.try_acquire() == false);
+        }
+        result |= limiter.try_acquire();
+        result |= (limiter.get_available() != 0);
+
+        print_test_result(result, "test_burst()");
+        return result;
+    }
+
+
+    int test_timed_acquire(void)
+    {
+        Penguin::Rate_Limiter limiter(10.0, 1);
+        limiter.acquire();
+
+        // The next permit is 100ms away, so a 10ms timeout fails without waiting for it
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int result = 0;
+        result |= (limiter.try_acquire_for(std::chrono::milliseconds(10)) != std::cv_status::timeout);
+        result |= (seconds_since(start) > 0.01);
+
+        result |= (limiter.try_acquire_until(std::chrono::steady_clock::now() + std::chrono::milliseconds(500)) != std::cv_status::no_timeout);
+        double waited = seconds_since(start);
+        result |= (waited < 0.09 || waited > 0.2);
+
+        print_test_result(result, "test_timed_acquire()");
+        return result;
+    }
+
+
+    int test_blocking_accuracy(void)
+    {
+        // Two threads take a million single permits at a million per second
+        constexpr double rate = 1000000.0;
+        constexpr std::uint64_t burst = 1000;
+        constexpr int threads = 2;
+        constexpr int permits_per_thread = 500000;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Penguin::Rate_Limiter limiter(rate, burst);
+
+        std::vector<std::future<void>> workers;
+        for (int i = 0; i < threads; ++i)
+        {
+            workers.push_back(std::async(std::launch::async, [&limiter] {
+                for (int permit = 0; permit < permits_per_thread; ++permit)
+                {
+                    limiter.acquire();
+                }
+            }));
+        }
+        for (std::future<void>& worker : workers)
+        {
+            worker.get();
+        }
+        double elapsed = seconds_since(start);
+        double expected = (threads * permits_per_thread - burst) / rate;
+        std::cout << "Took " << elapsed << "s for " << threads * permits_per_thread << " permits, expected " << expected << "s\n";
+
+        int result = 0;
+        result |= is_outside_schedule(elapsed, expected);
+
+        print_test_result(result, "test_blocking_accuracy()");
+        return result;
+    }
+
+
+    int test_batch_accuracy(void)
+    {
+        constexpr double rate = 1000000.0;
+        constexpr std::uint64_t burst = 1000;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Penguin::Rate_Limiter limiter(rate, burst);
+
+        for (int batch = 0; batch < 10000; ++batch)
+        {
+            limiter.acquire(100);
+        }
+        double elapsed = seconds_since(start);
+        double expected = (1000000 - burst) / rate;
+        std::cout << "Took " << elapsed << "s for 1000000 permits in batches of 100, expected " << expected << "s\n";
+
+        int result = 0;
+        result |= is_outside_schedule(elapsed, expected);
+
+        print_test_result(result, "test_batch_accuracy()");
+        return result;
+    }
+
+
+    int test_try_acquire_accuracy(void)
+    {
+        // Polling for a second grants the burst plus one permit per microsecond, never more, and no
+        // fewer than 95% of that unless the poller is descheduled long enough for the bucket to fill
+        constexpr double rate = 1000000.0;
+        constexpr std::uint64_t burst = 1000;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Penguin::Rate_Limiter limiter(rate, burst);
+
+        std::uint64_t granted = 0;
+        while (seconds_since(start) < 1.0)
+        {
+            granted += (limiter.try_acquire() ? 1 : 0);
+        }
+        double expected = burst + rate * seconds_since(start);
+        std::cout << "Granted " << granted << " permits polling for a second, expected " << expected << "\n";
+
+        int result = 0;
+        result |= (granted > expected);
+        result |= (granted < expected * 0.95);
+
+        print_test_result(result, "test_try_acquire_accuracy()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Rate_Limiter" << std::endl;
+    int result = 0;
+    result |= test_burst();
+    result |= test_timed_acquire();
+    result |= test_blocking_accuracy();
+    result |= test_batch_accuracy();
+    result |= test_try_acquire_accuracy();
+
+    return result;
+}
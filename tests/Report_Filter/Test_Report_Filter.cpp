@@ -0,0 +1,118 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Report_Filter.h>
+#include <penguin/Scoped_Timer.h>
+#include <future>
+#include <iostream>
+#include <thread>
+
+
+namespace
+{
+    using Nanosecond_Timer = Penguin::Scoped_Timer<long long, std::nano>;
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_every(void)
+    {
+        Penguin::Report_Filter::reset_suppressed_count();
+        int reports = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            Nanosecond_Timer timer([&reports](const Nanosecond_Timer&) { ++reports; }, Penguin::Report_Filter::every());
+        }
+
+        int result = 0;
+        result |= (reports != 1000);
+        result |= (Penguin::Report_Filter::get_suppressed_count() != 0);
+
+        print_test_result(result, "test_every()");
+        return result;
+    }
+
+
+    int test_sampled(void)
+    {
+        Penguin::Report_Filter::reset_suppressed_count();
+        const int scopes = 200000;
+        int reports = 0;
+        for (int i = 0; i < scopes; ++i)
+        {
+            Nanosecond_Timer timer([&reports](const Nanosecond_Timer&) { ++reports; }, Penguin::Report_Filter::sampled(100));
+        }
+        std::cout << "Reported " << reports << " of " << scopes << " scopes sampled 1 in 100\n";
+
+        // Expect about 2000 reports, allow for a generous statistical spread
+        int result = 0;
+        result |= (reports < 1500 || reports > 2500);
+        result |= (Penguin::Report_Filter::get_suppressed_count() != static_cast<std::uint64_t>(scopes - reports));
+
+        print_test_result(result, "test_sampled()");
+        return result;
+    }
+
+
+    int test_over_budget(void)
+    {
+        Penguin::Report_Filter::reset_suppressed_count();
+        Penguin::Report_Filter filter = Penguin::Report_Filter::over_budget(std::chrono::milliseconds(1));
+        int reports = 0;
+        for (int i = 0; i < 10; ++i)
+        {
+            Nanosecond_Timer timer([&reports](const Nanosecond_Timer& timer) {
+                ++reports;
+                std::cout << "Slow scope took " << timer.get_finish_duration().value().count() << "ns\n";
+            }, filter);
+            if (i % 5 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+
+        int result = 0;
+        result |= (reports != 2);
+        result |= (Penguin::Report_Filter::get_suppressed_count() != 8);
+
+        print_test_result(result, "test_over_budget()");
+        return result;
+    }
+
+
+    int test_per_thread_suppression(void)
+    {
+        Penguin::Report_Filter::reset_suppressed_count();
+        std::future<std::uint64_t> other_thread = std::async(std::launch::async, [] {
+            for (int i = 0; i < 100; ++i)
+            {
+                Nanosecond_Timer timer([](const Nanosecond_Timer&) {}, Penguin::Report_Filter::over_budget(std::chrono::hours(1)));
+            }
+            return Penguin::Report_Filter::get_suppressed_count();
+        });
+
+        int result = 0;
+        result |= (other_thread.get() != 100);
+        result |= (Penguin::Report_Filter::get_suppressed_count() != 0);
+
+        print_test_result(result, "test_per_thread_suppression()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Report_Filter" << std::endl;
+    int result = 0;
+    result |= test_every();
+    result |= test_sampled();
+    result |= test_over_budget();
+    result |= test_per_thread_suppression();
+
+    return result;
+}
@@ -0,0 +1,115 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Running_Statistics.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    bool close_to(double actual, double expected)
+    {
+        return std::fabs(actual - expected) <= 1e-9 * std::max(1.0, std::fabs(expected));
+    }
+
+
+    int test_running_statistics(void)
+    {
+        Penguin::Running_Statistics statistics;
+        int result = 0;
+
+        result |= (statistics.count() != 0);
+        result |= !close_to(statistics.variance(), 0.0);
+
+        for (double sample : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0})
+        {
+            statistics.add(sample);
+        }
+
+        result |= (statistics.count() != 8);
+        result |= !close_to(statistics.mean(), 5.0);
+        result |= !close_to(statistics.variance(), 32.0 / 7.0);
+        result |= !close_to(statistics.min(), 2.0);
+        result |= !close_to(statistics.max(), 9.0);
+
+        print_test_result(result, "test_running_statistics()");
+        return result;
+    }
+
+
+    int test_merge(void)
+    {
+        Penguin::Running_Statistics all;
+        Penguin::Running_Statistics first;
+        Penguin::Running_Statistics second;
+        int result = 0;
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            double sample = std::sin(i) * 100.0 + i;
+            all.add(sample);
+            (i < 300 ? first : second).add(sample);
+        }
+        first.merge(second);
+
+        result |= (first.count() != all.count());
+        result |= !close_to(first.mean(), all.mean());
+        result |= (std::fabs(first.variance() - all.variance()) > 1e-6 * all.variance());
+        result |= !close_to(first.min(), all.min());
+        result |= !close_to(first.max(), all.max());
+
+        print_test_result(result, "test_merge()");
+        return result;
+    }
+
+
+    int test_reservoir_percentiles(void)
+    {
+        Penguin::Reservoir_Sample<double, 1024> reservoir;
+        int result = 0;
+
+        // Fits in the reservoir, so percentiles are exact
+        for (int i = 1; i <= 101; ++i)
+        {
+            reservoir.add(i);
+        }
+        result |= (reservoir.size() != 101);
+        result |= !close_to(reservoir.percentile(0.0), 1.0);
+        result |= !close_to(reservoir.percentile(50.0), 51.0);
+        result |= !close_to(reservoir.percentile(100.0), 101.0);
+
+        // A uniform stream much larger than the reservoir keeps a representative sample
+        reservoir.reset();
+        for (int i = 0; i < 1000000; ++i)
+        {
+            reservoir.add(i % 1000);
+        }
+        result |= (reservoir.size() != 1024);
+        result |= (std::fabs(reservoir.percentile(50.0) - 500.0) > 50.0);
+        result |= (std::fabs(reservoir.percentile(90.0) - 900.0) > 50.0);
+
+        print_test_result(result, "test_reservoir_percentiles()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Running_Statistics" << std::endl;
+    int result = 0;
+    result |= test_running_statistics();
+    result |= test_merge();
+    result |= test_reservoir_percentiles();
+
+    return result;
+}
@@ -5,6 +5,7 @@
 #include <future>
 #include <iostream>
 #include <numeric>
+#include <thread>
 #include <vector>
 
 
@@ -186,6 +187,36 @@ namespace
         print_test_result(result, "test_try_acquire_until()");
         return result;
     }
+
+
+    template <class Policy>
+    int test_policy(std::string policy_name)
+    {
+        // Two threads hand a token back and forth, every hand-off must wake the other side
+        Penguin::Basic_Semaphore<Policy> ping(0);
+        Penguin::Basic_Semaphore<Policy> pong(0);
+        const int rounds = 10000;
+        std::future<void> other_side = std::async(std::launch::async, [&] {
+            for (int i = 0; i < rounds; ++i)
+            {
+                ping.acquire();
+                pong.release();
+            }
+        });
+        for (int i = 0; i < rounds; ++i)
+        {
+            ping.release();
+            pong.acquire();
+        }
+        other_side.get();
+
+        int result = 0;
+        result |= (ping.permits() != 0 || pong.permits() != 0);
+        result |= (pong.try_acquire_for(std::chrono::milliseconds(10)) != std::cv_status::timeout);
+
+        print_test_result(result, "test_policy<" + policy_name + ">()");
+        return result;
+    }
 }
 
 
@@ -198,6 +229,10 @@ int main(int argc, char *argv[])
     result |= test_permits();
     result |= test_try_acquire_for();
     result |= test_try_acquire_until();
+    result |= test_policy<Penguin::Std_Mutex_Policy>("Std_Mutex_Policy");
+    result |= test_policy<Penguin::Adaptive_Mutex_Policy>("Adaptive_Mutex_Policy");
+    result |= test_policy<Penguin::Futex_Policy>("Futex_Policy");
+    result |= test_policy<Penguin::Ticket_Lock_Policy>("Ticket_Lock_Policy");
 
     return result;
 }
@@ -0,0 +1,148 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Seqlock.h>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    // Every field holds the same value, so a torn read shows up as fields that disagree
+    struct Snapshot
+    {
+        std::uint64_t   fields[12];
+        std::uint32_t   tail;
+    };
+
+
+    Snapshot make_snapshot(std::uint64_t value)
+    {
+        Snapshot snapshot;
+        for (std::uint64_t& field : snapshot.fields)
+        {
+            field = value;
+        }
+        snapshot.tail = static_cast<std::uint32_t>(value);
+        return snapshot;
+    }
+
+
+    bool is_consistent(const Snapshot& snapshot)
+    {
+        for (std::uint64_t field : snapshot.fields)
+        {
+            if (field != snapshot.fields[0])
+            {
+                return false;
+            }
+        }
+        return snapshot.tail == static_cast<std::uint32_t>(snapshot.fields[0]);
+    }
+
+
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_load_store(void)
+    {
+        Penguin::Seqlock<Snapshot> seqlock(make_snapshot(7));
+
+        int result = 0;
+        result |= (seqlock.load().fields[5] != 7);
+        result |= (seqlock.get_version() != 0);
+
+        seqlock.store(make_snapshot(8));
+        result |= (is_consistent(seqlock.load()) == false);
+        result |= (seqlock.load().fields[11] != 8);
+        result |= (seqlock.get_version() != 2);
+
+        seqlock.update([](Snapshot& snapshot) { snapshot = make_snapshot(snapshot.fields[0] * 2); });
+        result |= (seqlock.try_load().value().tail != 16);
+        result |= (seqlock.get_version() != 4);
+
+        print_test_result(result, "test_load_store()");
+        return result;
+    }
+
+
+    int test_torture(void)
+    {
+        // One writer rewrites the snapshot as fast as it can while readers check every copy is whole
+        // and that the values they see never go backwards
+        Penguin::Seqlock<Snapshot> seqlock(make_snapshot(0));
+        const std::uint64_t writes = 200000;
+        std::atomic<bool> stop(false);
+
+        std::vector<std::future<int>> readers;
+        for (int i = 0; i < 3; ++i)
+        {
+            readers.push_back(std::async(std::launch::async, [&] {
+                int failures = 0;
+                std::uint64_t last = 0;
+                long reads = 0;
+                while (!stop.load(std::memory_order_relaxed) || reads == 0)
+                {
+                    Snapshot snapshot = seqlock.load();
+                    failures += (is_consistent(snapshot) == false);
+                    failures += (snapshot.fields[0] < last);
+                    last = snapshot.fields[0];
+                    ++reads;
+                }
+                return failures;
+            }));
+        }
+
+        for (std::uint64_t i = 1; i <= writes; ++i)
+        {
+            seqlock.store(make_snapshot(i));
+            if (i % 1000 == 0)
+            {
+                // Give the readers time slices on machines with few processors
+                std::this_thread::yield();
+            }
+        }
+        stop.store(true);
+
+        int result = 0;
+        for (std::future<int>& reader : readers)
+        {
+            result |= (reader.get() != 0);
+        }
+        result |= (seqlock.load().fields[0] != writes);
+        result |= (seqlock.get_version() != writes * 2);
+
+        print_test_result(result, "test_torture()");
+        return result;
+    }
+
+
+    int test_layout(void)
+    {
+        // The sequence and the payload must not share a cache line
+        int result = 0;
+        result |= (alignof(Penguin::Seqlock<std::uint64_t>) < 64);
+        result |= (sizeof(Penguin::Seqlock<std::uint64_t>) < 128);
+
+        print_test_result(result, "test_layout()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Seqlock" << std::endl;
+    int result = 0;
+    result |= test_load_store();
+    result |= test_torture();
+    result |= test_layout();
+
+    return result;
+}
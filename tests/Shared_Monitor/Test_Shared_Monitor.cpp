@@ -0,0 +1,111 @@
+/*
+* Copyright (c) 2019 Michael Mathers
+*/
+#include <penguin/Shared_Monitor.h>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    void print_test_result(int result, std::string test_text)
+    {
+        std::cout << "[" << (result ? "FAIL" : " OK ") << "] " << test_text.c_str() << std::endl;
+    }
+
+
+    int test_shared_wait(void)
+    {
+        // Several readers wait under shared guards at once, a writer wakes them all
+        Penguin::Shared_Monitor monitor;
+        int generation = 0;
+        std::vector<std::future<bool>> readers;
+        for (int i = 0; i < 3; ++i)
+        {
+            readers.push_back(std::async(std::launch::async, [&] {
+                Penguin::Shared_Monitor::_shared_guard_type guard(monitor);
+                return monitor.wait_for(guard, std::chrono::seconds(5), [&generation] {return generation > 0; });
+            }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        {
+            Penguin::Shared_Monitor::_guard_type guard(monitor);
+            generation = 1;
+            monitor.notify_all();
+        }
+
+        int result = 0;
+        for (std::future<bool>& reader : readers)
+        {
+            result |= (reader.get() == false);
+        }
+
+        print_test_result(result, "test_shared_wait()");
+        return result;
+    }
+
+
+    int test_exclusive_wait(void)
+    {
+        Penguin::Shared_Monitor monitor;
+        bool ready = false;
+        std::future<bool> writer = std::async(std::launch::async, [&] {
+            Penguin::Shared_Monitor::_guard_type guard(monitor);
+            return monitor.wait_for(guard, std::chrono::seconds(5), [&ready] {return ready; });
+        });
+        {
+            Penguin::Shared_Monitor::_guard_type guard(monitor);
+            ready = true;
+            monitor.notify_one();
+        }
+
+        int result = 0;
+        result |= (writer.get() == false);
+
+        print_test_result(result, "test_exclusive_wait()");
+        return result;
+    }
+
+
+    int test_shared_wait_timeout(void)
+    {
+        Penguin::Shared_Monitor monitor;
+        Penguin::Shared_Monitor::_shared_guard_type guard(monitor);
+        std::cv_status status = monitor.wait_for(guard, std::chrono::milliseconds(20));
+
+        int result = 0;
+        result |= (status != std::cv_status::timeout);
+        // The wait re-acquired the shared lock, so other readers still get in and writers do not
+        result |= (std::async(std::launch::async, [&monitor] {
+            Penguin::Shared_Monitor::_mutex_type& mutex = monitor;
+            bool reader = mutex.try_lock_shared();
+            if (reader)
+            {
+                mutex.unlock_shared();
+            }
+            bool writer = mutex.try_lock();
+            if (writer)
+            {
+                mutex.unlock();
+            }
+            return reader && !writer;
+        }).get() == false);
+
+        print_test_result(result, "test_shared_wait_timeout()");
+        return result;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::cout << "Test_Shared_Monitor" << std::endl;
+    int result = 0;
+    result |= test_shared_wait();
+    result |= test_exclusive_wait();
+    result |= test_shared_wait_timeout();
+
+    return result;
+}
@@ -48,6 +48,35 @@ namespace
         return true;
     }
 
+
+    bool test_lap_statistics(void)
+    {
+        Penguin::Timer<unsigned long long, std::micro, Penguin::Plain_Finish_Flag, 64> timer;
+
+        timer.start();
+        for (int i = 0; i < 20; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            timer.lap();
+        }
+        timer.stop();
+
+        const Penguin::Running_Statistics& laps = timer.get_lap_statistics();
+        std::cout << "Laps = " << laps.count() << ", mean = " << laps.mean() << "us, stddev = " << laps.standard_deviation()
+            << "us, min = " << laps.min() << "us, p50 = " << timer.get_lap_percentile(50.0) << "us, max = " << laps.max() << "us\n";
+
+        bool passed = true;
+        passed &= (laps.count() == 20);
+        passed &= (laps.min() >= 1000.0);
+        passed &= (laps.min() <= laps.mean() && laps.mean() <= laps.max());
+        passed &= (timer.get_lap_percentile(0.0) == laps.min());
+        passed &= (timer.get_lap_percentile(100.0) == laps.max());
+        passed &= (timer.get_finish_duration() >= static_cast<unsigned long long>(20 * laps.min()));
+
+        timer.reset();
+        passed &= (timer.get_lap_statistics().count() == 0);
+        return passed;
+    }
 }
 
 
@@ -57,6 +86,7 @@ int main(int argc, char *argv[])
     bool tests_passed = true;
     tests_passed &= test_basic_timer_ms();
     tests_passed &= test_basic_timer_us();
+    tests_passed &= test_lap_statistics();
 
     return (tests_passed ? 0 : -1);
 }
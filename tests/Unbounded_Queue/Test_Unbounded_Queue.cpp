@@ -1,11 +1,15 @@
 /*
 * Copyright (c) 2017 Michael Mathers
 */
+#include <penguin/Arena.h>
 #include <penguin/Unbounded_Queue.h>
 #include <algorithm>
 #include <future>
 #include <iostream>
+#include <memory_resource>
 #include <numeric>
+#include <string>
+#include <thread>
 #include <vector>
 
 
@@ -171,6 +175,27 @@ namespace
         print_test_result(successful_result, "test_try_pop_until()");
         return successful_result;
     }
+
+
+    bool test_allocator(void)
+    {
+        bool successful_result = true;
+        Penguin::Arena arena;
+        Penguin::Unbounded_Queue<std::pmr::string> queue(&arena);
+
+        // Nodes, and the strings in them, come from the arena
+        queue.push(std::pmr::string("a string too long for the small string buffer", &arena));
+        std::size_t allocated = arena.get_allocated_bytes();
+        successful_result &= (allocated > 0);
+        successful_result &= (queue.get_allocator().resource() == &arena);
+
+        queue.push("another string too long for the small string buffer");
+        successful_result &= (arena.get_allocated_bytes() > allocated);
+        successful_result &= (queue.pop().get_allocator().resource() == &arena);
+
+        print_test_result(successful_result, "test_allocator()");
+        return successful_result;
+    }
 }
 
 
@@ -182,6 +207,7 @@ int main(int argc, char *argv[])
     pass &= test_pop();
     pass &= test_try_pop_for();
     pass &= test_try_pop_until();
+    pass &= test_allocator();
 
     return (pass ? 0 : -1);
 }